@@ -0,0 +1,144 @@
+/** @file
+ *  Benchmarks of reading the game data: parsing, lookup and loading of arc files, and texture decoding.
+ *
+ *  These need the game data in @c data/ and are skipped without it, except for decoding a texture made up in memory.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "harness.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SH3/arc/mft.hpp"
+#include "SH3/arc/vfile.hpp"
+#include "SH3/graphics/texture.hpp"
+
+using namespace sh3::bench;
+
+namespace {
+    constexpr const char *mftPath = "data/arc.arc";                      /**< Where @ref sh3::arc::mft looks for the index. */
+    constexpr const char *textureFile = "data/pic/sy/sys_warning.tex";   /**< A file that is in every release. */
+    const char *const missingData = "data/arc.arc not found";
+
+    /**
+     *  Check whether the game data is there; @ref sh3::arc::mft dies without it.
+     */
+    bool HaveGameData()
+    {
+        return static_cast<bool>(std::ifstream(mftPath));
+    }
+
+    /**
+     *  Make up a 256x256 texture file with 32 bits per pixel.
+     *
+     *  Paletted textures would be the more interesting decode, but decoding them also writes the result to disk.
+     */
+    std::vector<std::uint8_t> MakeTexture()
+    {
+        constexpr std::uint16_t size = 256;
+        sh3_graphics::sh3_texture_header header;
+        std::memset(&header, 0, sizeof(header));
+        header.batchHeaderMarker = 0xFFFFFFFF;
+        header.batchHeaderSize = sizeof(header);
+        header.numBatchedTextures = 1;
+        header.texHeaderSegMarker = 0xFFFFFFFF;
+        header.texWidth = size;
+        header.texHeight = size;
+        header.bpp = sh3_graphics::sh3_texture::RGBA;
+        header.texSize = size * size * 4u;
+        header.texFileSize = header.texSize + sizeof(header);
+        header.batchSize = header.texFileSize;
+
+        std::vector<std::uint8_t> contents(header.texFileSize);
+        std::memcpy(contents.data(), &header, sizeof(header));
+        for(std::size_t i = sizeof(header); i < contents.size(); ++i)
+        {
+            contents[i] = static_cast<std::uint8_t>(i * 7u);
+        }
+        return contents;
+    }
+
+    /**
+     *  Get the index, shared by the benchmarks.
+     */
+    sh3::arc::mft& GetMft()
+    {
+        static std::unique_ptr<sh3::arc::mft> index(new sh3::arc::mft);
+        return *index;
+    }
+
+    benchmark parse("arc parse", [](runner &run)
+    {
+        if(!HaveGameData())
+        {
+            return run.Skip(missingData);
+        }
+        run.Measure([]
+        {
+            sh3::arc::mft index;
+            DoNotOptimize(index);
+        });
+    });
+
+    benchmark lookup("arc lookup (missing file)", [](runner &run)
+    {
+        if(!HaveGameData())
+        {
+            return run.Skip(missingData);
+        }
+        sh3::arc::mft &index = GetMft();
+        std::vector<std::uint8_t> buffer;
+        const std::string name = "data/no/such/file.bin";
+        // searches every subarc without reading anything
+        run.Measure([&]
+        {
+            DoNotOptimize(index.LoadFile(name, buffer));
+        });
+    });
+
+    benchmark load("arc load", [](runner &run)
+    {
+        if(!HaveGameData())
+        {
+            return run.Skip(missingData);
+        }
+        sh3::arc::mft &index = GetMft();
+        std::vector<std::uint8_t> buffer;
+        run.Measure([&]
+        {
+            buffer.clear();
+            DoNotOptimize(index.LoadFile(textureFile, buffer));
+        });
+    });
+
+    benchmark decode("texture decode", [](runner &run)
+    {
+        if(!HaveGameData())
+        {
+            return run.Skip(missingData);
+        }
+        sh3::arc::vfile file(GetMft(), textureFile);
+        run.Measure([&]
+        {
+            sh3_graphics::texture_image image;
+            file.Rewind();
+            DoNotOptimize(sh3_graphics::sh3_texture::Decode(file, image));
+        });
+    });
+
+    benchmark decodeSynthetic("texture decode (in memory)", [](runner &run)
+    {
+        sh3::arc::vfile file("synthetic.tex", MakeTexture());
+        run.Measure([&]
+        {
+            sh3_graphics::texture_image image;
+            file.Rewind();
+            DoNotOptimize(sh3_graphics::sh3_texture::Decode(file, image));
+        });
+    });
+}
@@ -0,0 +1,87 @@
+/** @file
+ *  Benchmarks of the camera and angle math.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "harness.hpp"
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SH3/angle.hpp"
+#include "SH3/camera/camera.hpp"
+#include "SH3/camera/frustum.hpp"
+
+using namespace sh3::bench;
+
+namespace {
+    constexpr std::size_t angleCount = 1024;
+
+    /**
+     *  Random angles of a few turns either way.
+     */
+    std::vector<float_angle> RandomAngles()
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> radians(-20.0f, 20.0f);
+        std::vector<float_angle> angles;
+        angles.reserve(angleCount);
+        for(std::size_t i = 0; i < angleCount; ++i)
+        {
+            angles.push_back(float_angle::FromRadians(radians(rng)));
+        }
+        return angles;
+    }
+
+    benchmark normalize("angle normalize x1024", [](runner &run)
+    {
+        const std::vector<float_angle> angles = RandomAngles();
+        run.Measure([&]
+        {
+            for(const float_angle &a : angles)
+            {
+                DoNotOptimize(a.Normalized());
+            }
+        });
+    });
+
+    benchmark sinCos("angle SinCos x1024", [](runner &run)
+    {
+        const std::vector<float_angle> angles = RandomAngles();
+        run.Measure([&]
+        {
+            for(const float_angle &a : angles)
+            {
+                DoNotOptimize(a.SinCos());
+            }
+        });
+    });
+
+    benchmark cameraUpdate("camera turn and matrices", [](runner &run)
+    {
+        sh3::camera::Camera camera(glm::vec3(0.0f, 1.5f, 0.0f), float_angle::FromDegrees(60.0f), 4.0f / 3.0f, 0.1f, 1000.0f);
+        const float_angle step = float_angle::FromDegrees(0.5f);
+        float x = 0.0f;
+        // what a frame of mouse look does
+        run.Measure([&]
+        {
+            camera.AddYaw(step);
+            camera.AddPitch(step * 0.1f);
+            camera.SetPosition(glm::vec3(x += 0.01f, 1.5f, 0.0f));
+            DoNotOptimize(camera.GetViewProjectionMatrix());
+        });
+    });
+
+    benchmark frustumExtract("frustum from matrix", [](runner &run)
+    {
+        sh3::camera::Camera camera(glm::vec3(0.0f, 1.5f, 0.0f), float_angle::FromDegrees(60.0f), 4.0f / 3.0f, 0.1f, 1000.0f);
+        const glm::mat4 viewProjection = camera.GetViewProjectionMatrix();
+        run.Measure([&]
+        {
+            DoNotOptimize(sh3::camera::frustum::FromMatrix(viewProjection));
+        });
+    });
+}
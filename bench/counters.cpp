@@ -0,0 +1,169 @@
+/** @file
+ *  Implementation of counters.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "counters.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace sh3::bench;
+
+namespace {
+#ifdef __linux__
+    /**
+     *  The hardware event of each @ref counter.
+     */
+    constexpr std::array<std::uint64_t, counterCount> events = {{
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    }};
+
+    /**
+     *  Open a counter of the calling thread, disabled.
+     *
+     *  @param event The hardware event.
+     *  @param group The group leader, or -1 to open a new group.
+     *
+     *  @returns The file descriptor, or -1 with @c errno set.
+     */
+    int Open(const std::uint64_t event, const int group)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = event;
+        attributes.disabled = group < 0;
+        // user space only, so a perf_event_paranoid of 2 (the usual default) still allows it
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, group, 0));
+    }
+#endif
+}
+
+const char* sh3::bench::GetCounterName(const counter which)
+{
+    switch(which)
+    {
+    case counter::CYCLES:           return "cycles";
+    case counter::INSTRUCTIONS:     return "instructions";
+    case counter::CACHE_MISSES:     return "cache_misses";
+    case counter::BRANCH_MISSES:    return "branch_misses";
+    case counter::MAX:              break;
+    }
+    return "invalid";
+}
+
+double counter_values::GetIpc() const
+{
+    if(!Has(counter::CYCLES) || !Has(counter::INSTRUCTIONS) || Get(counter::CYCLES) <= 0.0)
+    {
+        return 0.0;
+    }
+    return Get(counter::INSTRUCTIONS) / Get(counter::CYCLES);
+}
+
+double counter_values::GetPerKiloInstruction(const counter which) const
+{
+    if(!Has(which) || !Has(counter::INSTRUCTIONS) || Get(counter::INSTRUCTIONS) <= 0.0)
+    {
+        return 0.0;
+    }
+    return Get(which) * 1000.0 / Get(counter::INSTRUCTIONS);
+}
+
+perf_counters::perf_counters()
+{
+    descriptors.fill(-1);
+#ifdef __linux__
+    for(std::size_t i = 0; i < counterCount; ++i)
+    {
+        // counters the CPU lacks (common in virtual machines) are left out of the group instead of failing it
+        descriptors[i] = Open(events[i], leader);
+        if(leader < 0)
+        {
+            leader = descriptors[i];
+            if(leader < 0 && error.empty())
+            {
+                error = std::string("perf_event_open: ") + std::strerror(errno);
+            }
+        }
+    }
+#else
+    error = "not supported on this platform";
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+#ifdef __linux__
+    for(const int descriptor : descriptors)
+    {
+        if(descriptor >= 0)
+        {
+            close(descriptor);
+        }
+    }
+#endif
+}
+
+void perf_counters::Start()
+{
+#ifdef __linux__
+    if(leader >= 0)
+    {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+counter_values perf_counters::Stop(const double divisor)
+{
+    counter_values values;
+#ifdef __linux__
+    if(leader < 0)
+    {
+        return values;
+    }
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // { nr, time_enabled, time_running, value[nr] }, the values in the order the counters were opened
+    std::vector<std::uint64_t> data(3 + counterCount);
+    const ssize_t size = read(leader, data.data(), data.size() * sizeof(std::uint64_t));
+    const std::uint64_t enabled = data[1], running = data[2];
+    if(size < static_cast<ssize_t>(3 * sizeof(std::uint64_t)) || running == 0)
+    {
+        // opened, but the kernel never scheduled them
+        return values;
+    }
+
+    const double scale = static_cast<double>(enabled) / static_cast<double>(running) / divisor;
+    std::size_t value = 3;
+    for(std::size_t i = 0; i < counterCount && value < 3 + data[0]; ++i)
+    {
+        if(descriptors[i] >= 0)
+        {
+            values.counts[i] = static_cast<double>(data[value++]) * scale;
+            values.available[i] = true;
+        }
+    }
+#else
+    static_cast<void>(divisor);
+#endif
+    return values;
+}
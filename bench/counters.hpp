@@ -0,0 +1,122 @@
+/** @file
+ *  Hardware performance counters, to tell whether a change affected the memory behaviour or the branches of a
+ *  benchmark rather than just its time.
+ *
+ *  Read with @c perf_event_open on Linux. Elsewhere, or where the kernel doesn't allow it (e.g. containers or
+ *  virtual machines without a virtual PMU), the counters are simply unavailable.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_BENCH_COUNTERS_HPP_INCLUDED
+#define SH3_BENCH_COUNTERS_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sh3 { namespace bench {
+    /**
+     *  The counters read.
+     */
+    enum class counter
+    {
+        CYCLES,         /**< CPU cycles. */
+        INSTRUCTIONS,   /**< Instructions retired. */
+        CACHE_MISSES,   /**< Last level cache misses. */
+        BRANCH_MISSES,  /**< Mispredicted branches. */
+        MAX,
+    };
+
+    constexpr std::size_t counterCount = static_cast<std::size_t>(counter::MAX); /**< Number of @ref counter%s. */
+
+    /**
+     *  Get the name of a counter, as used in the JSON output.
+     */
+    const char* GetCounterName(counter which);
+
+    /**
+     *  Counts of some code.
+     */
+    struct counter_values final
+    {
+        std::array<double, counterCount> counts = {{}};     /**< The count of each @ref counter. */
+        std::array<bool, counterCount> available = {{}};    /**< Whether each @ref counter was counted. */
+
+        /**
+         *  Check whether a counter was counted.
+         */
+        bool Has(counter which) const { return available[static_cast<std::size_t>(which)]; }
+
+        /**
+         *  Get the count of a counter. Only valid if @ref Has.
+         */
+        double Get(counter which) const { return counts[static_cast<std::size_t>(which)]; }
+
+        /**
+         *  Get the instructions per cycle.
+         *
+         *  @returns The ratio, or 0 if either counter is unavailable.
+         */
+        double GetIpc() const;
+
+        /**
+         *  Get how often a counter fired per thousand instructions.
+         *
+         *  @returns The rate, or 0 if either counter is unavailable.
+         */
+        double GetPerKiloInstruction(counter which) const;
+    };
+
+    /**
+     *  Counts the @ref counter%s of the calling thread between @ref Start and @ref Stop.
+     */
+    class perf_counters final
+    {
+    public:
+        /**
+         *  Constructor. Opens the counters; those the system doesn't allow stay unavailable.
+         */
+        perf_counters();
+
+        /**
+         *  Destructor. Closes the counters.
+         */
+        ~perf_counters();
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        /**
+         *  Check whether any counter is available.
+         */
+        bool IsAvailable() const { return leader >= 0; }
+
+        /**
+         *  Get why no counter is available.
+         */
+        const std::string& GetError() const { return error; }
+
+        /**
+         *  Reset the counters and start counting.
+         */
+        void Start();
+
+        /**
+         *  Stop counting.
+         *
+         *  @param divisor Divide the counts by this, e.g. the number of iterations.
+         *
+         *  @returns The counts since @ref Start. Counts the kernel only sampled for part of the time (because other
+         *           programs used the counters too) are extrapolated.
+         */
+        counter_values Stop(double divisor = 1.0);
+
+    private:
+        int leader = -1;                                    /**< File descriptor of the group leader; -1 if none opened. */
+        std::array<int, counterCount> descriptors = {{}};   /**< File descriptor of each @ref counter; -1 if unavailable. */
+        std::string error{};                                /**< Why no counter is available. */
+    };
+} }
+
+#endif //SH3_BENCH_COUNTERS_HPP_INCLUDED
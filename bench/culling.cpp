@@ -0,0 +1,84 @@
+/** @file
+ *  Benchmarks of visibility and collision queries.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "harness.hpp"
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SH3/angle.hpp"
+#include "SH3/camera/camera.hpp"
+#include "SH3/camera/frustum.hpp"
+#include "SH3/collision/bvh.hpp"
+#include "SH3/types/aabb.hpp"
+
+using namespace sh3::bench;
+
+namespace {
+    constexpr std::size_t boxCount = 4096;
+    constexpr std::size_t triangleCount = 16384;
+    constexpr std::size_t rayCount = 256;
+
+    benchmark frustumCull("frustum cull 4096 boxes", [](runner &run)
+    {
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<float> position(-200.0f, 200.0f), size(0.5f, 5.0f);
+        std::vector<aabb> boxes;
+        boxes.reserve(boxCount);
+        for(std::size_t i = 0; i < boxCount; ++i)
+        {
+            const glm::vec3 min(position(rng), position(rng) * 0.1f, position(rng));
+            boxes.emplace_back(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+        }
+
+        sh3::camera::Camera camera(glm::vec3(0.0f, 1.5f, 0.0f), float_angle::FromDegrees(60.0f), 4.0f / 3.0f, 0.1f, 150.0f);
+        const sh3::camera::frustum volume = sh3::camera::frustum::FromMatrix(camera.GetViewProjectionMatrix());
+        run.Measure([&]
+        {
+            std::size_t visible = 0;
+            for(const aabb &box : boxes)
+            {
+                visible += volume.Intersects(box);
+            }
+            DoNotOptimize(visible);
+        });
+    });
+
+    benchmark raycast("bvh raycast x256", [](runner &run)
+    {
+        // a bumpy floor, roughly like the collision mesh of an outdoor area
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> height(-0.5f, 0.5f);
+        std::vector<sh3::collision::triangle> triangles;
+        const std::size_t side = 90; // 2 * 90^2 ~ triangleCount
+        triangles.reserve(triangleCount);
+        for(std::size_t z = 0; z < side; ++z)
+        {
+            for(std::size_t x = 0; x < side; ++x)
+            {
+                const glm::vec3 a(x, height(rng), z), b(x + 1, height(rng), z), c(x, height(rng), z + 1), d(x + 1, height(rng), z + 1);
+                triangles.push_back(sh3::collision::triangle{a, b, c});
+                triangles.push_back(sh3::collision::triangle{b, d, c});
+            }
+        }
+        const sh3::collision::bvh tree(triangles);
+
+        std::uniform_real_distribution<float> position(0.0f, static_cast<float>(side));
+        std::vector<sh3::collision::ray> rays;
+        for(std::size_t i = 0; i < rayCount; ++i)
+        {
+            rays.push_back(sh3::collision::ray{glm::vec3(position(rng), 10.0f, position(rng)), glm::vec3(0.1f, -1.0f, 0.05f), 20.0f});
+        }
+        std::vector<sh3::collision::hit> hits(rayCount);
+        run.Measure([&]
+        {
+            tree.Raycast(rays.data(), hits.data(), rayCount);
+            DoNotOptimize(hits);
+        });
+    });
+}
@@ -0,0 +1,106 @@
+/** @file
+ *  Implementation of harness.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sh3::bench;
+
+namespace {
+    std::vector<const benchmark*>& Registry()
+    {
+        static std::vector<const benchmark*> benchmarks;
+        return benchmarks;
+    }
+
+    /**
+     *  Get the median of some values, reordering them.
+     */
+    double Median(std::vector<double> &values)
+    {
+        const std::size_t middle = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle), values.end());
+        const double upper = values[middle];
+        if(values.size() % 2 != 0)
+        {
+            return upper;
+        }
+        const double lower = *std::max_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle));
+        return (lower + upper) / 2.0;
+    }
+}
+
+runner::runner(const settings &runSettings, const std::string &name):
+    config(runSettings), counters(), outcome()
+{
+    outcome.name = name;
+}
+
+double runner::Sample(const batch &iterations, const std::uint64_t count) const
+{
+    using clock = std::chrono::steady_clock;
+
+    const clock::time_point start = clock::now();
+    iterations(count);
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+}
+
+void runner::MeasureBatches(const batch &iterations)
+{
+    // batch iterations until a sample is long enough for the clock to be precise
+    const double minTime = static_cast<double>(config.minSampleTime.count());
+    std::uint64_t count = 1;
+    for(double time = Sample(iterations, count); time < minTime && count < (std::uint64_t(1) << 40); time = Sample(iterations, count))
+    {
+        const double scale = time > 0.0 ? std::min(minTime * 1.2 / time, 10.0) : 10.0;
+        count = std::max(count + 1, static_cast<std::uint64_t>(static_cast<double>(count) * scale));
+    }
+
+    for(std::size_t i = 0; i < config.warmupSamples; ++i)
+    {
+        Sample(iterations, count);
+    }
+
+    std::vector<double> times(config.samples);
+    counters.Start();
+    for(double &time : times)
+    {
+        time = Sample(iterations, count) / static_cast<double>(count);
+    }
+    outcome.counters = counters.Stop(static_cast<double>(count) * static_cast<double>(times.size()));
+
+    outcome.samples = times.size();
+    outcome.iterations = count;
+    outcome.median = Median(times);
+    for(double &time : times)
+    {
+        time = std::fabs(time - outcome.median);
+    }
+    outcome.mad = Median(times);
+}
+
+benchmark::benchmark(const char *benchmarkName, body benchmarkBody):
+    name(benchmarkName), code(std::move(benchmarkBody))
+{
+    Registry().push_back(this);
+}
+
+result benchmark::Run(const settings &runSettings) const
+{
+    runner run(runSettings, name);
+    code(run);
+    if(run.GetResult().skipped.empty() && run.GetResult().samples == 0)
+    {
+        run.Skip("nothing measured");
+    }
+    return run.GetResult();
+}
+
+const std::vector<const benchmark*>& benchmark::GetAll()
+{
+    return Registry();
+}
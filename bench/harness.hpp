@@ -0,0 +1,175 @@
+/** @file
+ *  A minimal benchmark harness.
+ *
+ *  Benchmarks register themselves by defining a @ref sh3::bench::benchmark at namespace scope. The body sets up
+ *  whatever it needs and hands the code to time to @ref sh3::bench::runner::Measure, which warms up, repeats
+ *  it and keeps the median and the median absolute deviation (MAD) of the samples, along with the hardware counters
+ *  over all samples where available.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_BENCH_HARNESS_HPP_INCLUDED
+#define SH3_BENCH_HARNESS_HPP_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "counters.hpp"
+
+namespace sh3 { namespace bench {
+    /**
+     *  Settings of a run.
+     */
+    struct settings final
+    {
+        std::size_t warmupSamples = 3;                                  /**< Samples to take and throw away first. */
+        std::size_t samples = 15;                                       /**< Samples to take. */
+        std::chrono::nanoseconds minSampleTime = std::chrono::milliseconds(5); /**< Iterations are batched until a sample takes at least this long. */
+    };
+
+    /**
+     *  The outcome of a benchmark.
+     */
+    struct result final
+    {
+        std::string name{};             /**< Name of the benchmark. */
+        std::string skipped{};          /**< Why the benchmark didn't run; empty if it did. */
+        double median = 0.0;            /**< Median time per iteration in nanoseconds. */
+        double mad = 0.0;               /**< Median absolute deviation of the time per iteration in nanoseconds. */
+        std::size_t samples = 0;        /**< Number of samples. */
+        std::uint64_t iterations = 0;   /**< Iterations per sample. */
+        counter_values counters{};      /**< Hardware counters per iteration. */
+    };
+
+    /**
+     *  Runs the code of a benchmark.
+     */
+    class runner final
+    {
+    public:
+        /**
+         *  Constructor.
+         *
+         *  @param runSettings How to measure.
+         *  @param name        The name of the benchmark.
+         */
+        runner(const settings &runSettings, const std::string &name);
+
+        runner(const runner&) = delete;
+        runner& operator=(const runner&) = delete;
+
+        using batch = std::function<void(std::uint64_t)>; /**< Runs a number of iterations. */
+
+        /**
+         *  Time a piece of code. Call once per benchmark.
+         *
+         *  @param iteration The code; called many times.
+         */
+        template<typename function>
+        void Measure(function &&iteration)
+        {
+            MeasureBatches([&iteration](const std::uint64_t count)
+            {
+                for(std::uint64_t i = 0; i < count; ++i)
+                {
+                    iteration();
+                }
+            });
+        }
+
+        /**
+         *  Time a piece of code that runs a given number of iterations itself.
+         *
+         *  @param iterations The code.
+         */
+        void MeasureBatches(const batch &iterations);
+
+        /**
+         *  Don't run the benchmark, e.g. because the game data is missing.
+         *
+         *  @param reason Why.
+         */
+        void Skip(const std::string &reason) { outcome.skipped = reason; }
+
+        /**
+         *  Get the outcome.
+         */
+        const result& GetResult() const { return outcome; }
+
+    private:
+        /**
+         *  Time a batch of iterations.
+         *
+         *  @returns The time in nanoseconds.
+         */
+        double Sample(const batch &iterations, std::uint64_t count) const;
+
+    private:
+        const settings &config;     /**< How to measure. */
+        perf_counters counters{};   /**< Hardware counters of the samples. */
+        result outcome;             /**< The outcome. */
+    };
+
+    /**
+     *  A benchmark. Define these at namespace scope to register them.
+     */
+    class benchmark final
+    {
+    public:
+        using body = std::function<void(runner&)>; /**< Sets up and calls @ref runner::Measure. */
+
+        /**
+         *  Constructor.
+         *
+         *  @param benchmarkName The name, unique among all benchmarks. Must outlive this.
+         *  @param benchmarkBody The code.
+         */
+        benchmark(const char *benchmarkName, body benchmarkBody);
+
+        benchmark(const benchmark&) = delete;
+        benchmark& operator=(const benchmark&) = delete;
+
+        /**
+         *  Get the name.
+         */
+        const char* GetName() const { return name; }
+
+        /**
+         *  Run the benchmark.
+         *
+         *  @param runSettings How to measure.
+         */
+        result Run(const settings &runSettings) const;
+
+        /**
+         *  Get all registered benchmarks, in the order they were registered.
+         */
+        static const std::vector<const benchmark*>& GetAll();
+
+    private:
+        const char *name;   /**< The name. */
+        body code;          /**< The code. */
+    };
+
+    /**
+     *  Keep the compiler from optimizing away the computation of a value.
+     *
+     *  @param value The value.
+     */
+    template<typename T>
+    inline void DoNotOptimize(const T &value)
+    {
+#if defined(__GNUC__)
+        __asm__ volatile("" : : "g"(&value) : "memory");
+#else
+        static const void * volatile sink;
+        sink = &value;
+#endif
+    }
+} }
+
+#endif //SH3_BENCH_HARNESS_HPP_INCLUDED
@@ -0,0 +1,66 @@
+/** @file
+ *  Benchmarks of the input dispatch.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "harness.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include <SDL_events.h>
+
+#include "SH3/system/input.hpp"
+#include "SH3/system/input_bindings.hpp"
+#include "SH3/system/perf_clock.hpp"
+
+using namespace sh3::bench;
+using sh3::system::input_system;
+
+namespace {
+    benchmark dispatch("input dispatch frame", [](runner &run)
+    {
+        input_system input;
+        sh3::system::input_bindings bindings;
+
+        const std::array<const char*, 8> keys = {{"W", "A", "S", "D", "Space", "Left Shift", "E", "Q"}};
+        for(const char *key : keys)
+        {
+            bindings.Bind(std::string(key), input.Intern(std::string("Action ") + key));
+        }
+
+        // a busy frame: every bound key pressed and released, plus some unbound ones
+        std::array<SDL_Event, 2 * keys.size() + 4> events;
+        std::size_t count = 0;
+        for(const SDL_EventType type : {SDL_KEYDOWN, SDL_KEYUP})
+        {
+            for(const char *key : keys)
+            {
+                SDL_Event &event = events[count++];
+                event = SDL_Event();
+                event.type = type;
+                event.key.keysym.scancode = SDL_GetScancodeFromName(key);
+            }
+        }
+        for(const SDL_Scancode unbound : {SDL_SCANCODE_F1, SDL_SCANCODE_F2, SDL_SCANCODE_F3, SDL_SCANCODE_F4})
+        {
+            SDL_Event &event = events[count++];
+            event = SDL_Event();
+            event.type = SDL_KEYDOWN;
+            event.key.keysym.scancode = unbound;
+        }
+
+        const input_system::timestamp stamp = sh3::system::perf_clock::now();
+        run.Measure([&]
+        {
+            input.StartUpdateActions();
+            for(const SDL_Event &event : events)
+            {
+                bindings.Dispatch(event, input, stamp);
+            }
+            input.EndUpdateActions(stamp);
+            DoNotOptimize(input);
+        });
+    });
+}
@@ -0,0 +1,241 @@
+/** @file
+ *  Runs the benchmarks.
+ *
+ *  Usage: <tt>bench [--filter TEXT] [--quick] [--json FILE] [--baseline FILE] [--tolerance FRACTION]</tt>
+ *
+ *  @c --filter only runs the benchmarks with @c TEXT in their name. @c --quick takes fewer and shorter samples,
+ *  e.g. for CI machines that are noisy anyway. @c --json writes the results to @c FILE, which can serve as the
+ *  @c --baseline of later runs: a benchmark whose median is more than @c FRACTION (default 0.15) slower than in
+ *  the baseline fails the run. Baselines are only comparable on the machine they were taken on, so none is committed;
+ *  see @c BENCH_BASELINE in bench/CMakeLists.txt for how CI passes one.
+ *
+ *  Next to the times, the instructions per cycle and the cache and branch misses per thousand instructions are
+ *  printed if the hardware counters can be read (see counters.hpp).
+ *
+ *  Needs no window; benchmarks of the game data are skipped if @c data/arc.arc is not in the working directory.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "harness.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "SH3/system/exit_code.hpp"
+
+using namespace sh3::bench;
+
+namespace {
+    /**
+     *  Quote a string for JSON.
+     */
+    std::string Quote(const std::string &text)
+    {
+        std::string quoted = "\"";
+        for(const char c : text)
+        {
+            if(c == '"' || c == '\\')
+            {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     *  Write the results as JSON.
+     *
+     *  @returns @c false if the file couldn't be written.
+     */
+    bool WriteJson(const std::string &path, const std::vector<result> &results)
+    {
+        std::ofstream file(path);
+        file << "{\n\t\"benchmarks\": [";
+        const char *separator = "\n";
+        for(const result &r : results)
+        {
+            file << separator << "\t\t{\"name\": " << Quote(r.name);
+            if(!r.skipped.empty())
+            {
+                file << ", \"skipped\": " << Quote(r.skipped);
+            }
+            else
+            {
+                file << ", \"median_ns\": " << r.median << ", \"mad_ns\": " << r.mad << ", \"samples\": " << r.samples << ", \"iterations\": " << r.iterations;
+                for(const counter which : {counter::CYCLES, counter::INSTRUCTIONS, counter::CACHE_MISSES, counter::BRANCH_MISSES})
+                {
+                    if(r.counters.Has(which))
+                    {
+                        file << ", \"" << GetCounterName(which) << "\": " << r.counters.Get(which);
+                    }
+                }
+                if(r.counters.GetIpc() > 0.0)
+                {
+                    file << ", \"ipc\": " << r.counters.GetIpc();
+                }
+            }
+            file << "}";
+            separator = ",\n";
+        }
+        file << "\n\t]\n}\n";
+        return static_cast<bool>(file);
+    }
+
+    /**
+     *  Read the medians of a previous run.
+     *
+     *  @returns @c false if the file couldn't be read.
+     */
+    bool ReadBaseline(const std::string &path, std::map<std::string, double> &medians)
+    {
+        boost::property_tree::ptree tree;
+        try
+        {
+            boost::property_tree::read_json(path, tree);
+            for(const auto &entry : tree.get_child("benchmarks"))
+            {
+                const boost::optional<double> median = entry.second.get_optional<double>("median_ns");
+                if(median)
+                {
+                    medians[entry.second.get<std::string>("name")] = *median;
+                }
+            }
+        }
+        catch(const boost::property_tree::ptree_error &e)
+        {
+            std::fprintf(stderr, "Unable to read baseline %s: %s\n", path.c_str(), e.what());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     *  Print the usage and return the exit code for wrong arguments.
+     */
+    int Usage(const char *program)
+    {
+        std::fprintf(stderr, "Usage: %s [--filter TEXT] [--quick] [--json FILE] [--baseline FILE] [--tolerance FRACTION]\n", program);
+        return static_cast<int>(exit_code::DEATH);
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS, or @ref exit_code::BENCHMARK_FAILED if a benchmark regressed.
+ */
+int main(int argc, char **argv)
+{
+    settings runSettings;
+    std::string filter, jsonPath, baselinePath;
+    double tolerance = 0.15;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if(arg == "--quick")
+        {
+            runSettings.warmupSamples = 1;
+            runSettings.samples = 7;
+            runSettings.minSampleTime = std::chrono::milliseconds(1);
+        }
+        else if(arg == "--filter" && hasValue)
+        {
+            filter = argv[++i];
+        }
+        else if(arg == "--json" && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if(arg == "--baseline" && hasValue)
+        {
+            baselinePath = argv[++i];
+        }
+        else if(arg == "--tolerance" && hasValue)
+        {
+            tolerance = std::atof(argv[++i]);
+        }
+        else
+        {
+            return Usage(argv[0]);
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if(!baselinePath.empty() && !ReadBaseline(baselinePath, baseline))
+    {
+        return static_cast<int>(exit_code::DEATH);
+    }
+
+    const perf_counters probe;
+    if(!probe.IsAvailable())
+    {
+        std::printf("Hardware counters unavailable (%s), only timing.\n", probe.GetError().c_str());
+    }
+
+    std::vector<result> results;
+    bool regressed = false;
+    std::printf("%-32s %14s %12s %6s %10s %10s %10s\n", "benchmark", "median ns", "MAD ns", "IPC", "LLC/kinst", "br/kinst", "baseline");
+    for(const benchmark *bench : benchmark::GetAll())
+    {
+        if(std::strstr(bench->GetName(), filter.c_str()) == nullptr)
+        {
+            continue;
+        }
+
+        results.push_back(bench->Run(runSettings));
+        const result &r = results.back();
+        if(!r.skipped.empty())
+        {
+            std::printf("%-32s skipped: %s\n", r.name.c_str(), r.skipped.c_str());
+            continue;
+        }
+
+        std::printf("%-32s %14.2f %12.2f", r.name.c_str(), r.median, r.mad);
+        if(r.counters.GetIpc() > 0.0)
+        {
+            std::printf(" %6.2f", r.counters.GetIpc());
+        }
+        else
+        {
+            std::printf(" %6s", "-");
+        }
+        for(const counter which : {counter::CACHE_MISSES, counter::BRANCH_MISSES})
+        {
+            if(r.counters.Has(which) && r.counters.Has(counter::INSTRUCTIONS))
+            {
+                std::printf(" %10.3f", r.counters.GetPerKiloInstruction(which));
+            }
+            else
+            {
+                std::printf(" %10s", "-");
+            }
+        }
+        const auto reference = baseline.find(r.name);
+        if(reference != baseline.end() && reference->second > 0.0)
+        {
+            const double change = r.median / reference->second - 1.0;
+            const bool failed = change > tolerance;
+            regressed |= failed;
+            std::printf(" %+9.1f%%%s", change * 100.0, failed ? "  REGRESSED" : "");
+        }
+        std::printf("\n");
+    }
+
+    if(!jsonPath.empty() && !WriteJson(jsonPath, results))
+    {
+        std::fprintf(stderr, "Unable to write %s\n", jsonPath.c_str());
+        return static_cast<int>(exit_code::DEATH);
+    }
+
+    return static_cast<int>(regressed ? exit_code::BENCHMARK_FAILED : exit_code::SUCCESS);
+}
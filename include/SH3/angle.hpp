@@ -9,6 +9,8 @@
 #include <boost/math/constants/constants.hpp>
 #include <boost/operators.hpp>
 
+#include "SH3/math/trig.hpp"
+
 /**
  *  An angle.
  *  
@@ -80,7 +82,23 @@ public:
      *  
      *  @returns The normalized angle.
      */
-    constexpr angle Normalized() const { return *this - Turn() * std::ceil((radians - boost::math::constants::pi<T>()) / boost::math::constants::two_pi<T>()); }
+    constexpr angle Normalized() const { return *this - Turn() * std::ceil((radians - boost::math::constants::pi<T>()) * boost::math::constants::one_div_two_pi<T>()); }
+
+    /**
+     *  Sine and cosine of an @ref angle.
+     */
+    struct sin_cos final
+    {
+        T sin; /**< The sine. */
+        T cos; /**< The cosine. */
+    };
+
+    /**
+     *  Compute the sine and cosine at once.
+     *
+     *  @see sh3::math::SinCos for the precision.
+     */
+    sin_cos SinCos() const { sin_cos result; sh3::math::SinCos(radians, result.sin, result.cos); return result; }
 
 private:
     /**
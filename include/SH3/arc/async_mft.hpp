@@ -0,0 +1,63 @@
+/** @file
+ *  Defines @ref sh3::arc::async_mft, which opens files from @c arc.arc in the background.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_ARC_ASYNC_MFT_HPP_INCLUDED
+#define SH3_ARC_ASYNC_MFT_HPP_INCLUDED
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "SH3/arc/vfile.hpp"
+#include "SH3/system/jobs.hpp"
+#include "SH3/system/task.hpp"
+
+namespace sh3 { namespace arc {
+    struct mft;
+
+    /**
+     *  Opens @ref vfile%s on the @ref sh3::system::job_system.
+     *
+     *  @ref mft is not thread-safe, so reads are serialized; they still happen off the main thread and overlap
+     *  with whatever the other workers decode meanwhile.
+     */
+    class async_mft final
+    {
+    public:
+        using file_task = sh3::system::task<std::shared_ptr<vfile>>;
+
+        /**
+         *  Constructor.
+         *
+         *  @param mft  The Master File Table to read from. Must outlive this.
+         *  @param jobs The job system to read on. Must outlive this.
+         */
+        async_mft(mft &mft, sh3::system::job_system &jobs): files(mft), jobs(jobs), readMutex() {}
+
+        async_mft(const async_mft&) = delete;
+        async_mft& operator=(const async_mft&) = delete;
+
+        /**
+         *  Open a file in the background.
+         *
+         *  @param filename The name of the file.
+         *
+         *  @returns A task for the opened file.
+         */
+        file_task Open(const std::string &filename);
+
+        /**
+         *  Get the job system the files are read on.
+         */
+        sh3::system::job_system& GetJobs() const { return jobs; }
+
+    private:
+        mft &files;                         /**< The Master File Table. */
+        sh3::system::job_system &jobs;      /**< Where reads run. */
+        std::mutex readMutex;               /**< Serializes access to @ref files. */
+    };
+} }
+
+#endif // SH3_ARC_ASYNC_MFT_HPP_INCLUDED
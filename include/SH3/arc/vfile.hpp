@@ -14,8 +14,10 @@
 #include <cstdint>
 #include <ios>
 #include <string>
+#include <utility>
 #include <vector>
 #include "SH3/error.hpp"
+#include "SH3/system/memory_tags.hpp"
 
 namespace sh3 { namespace arc {
     struct mft;
@@ -53,6 +55,15 @@ namespace sh3 { namespace arc {
         vfile(mft& mft, const std::string& filename): fpos(0), fname(filename)
         {Open(mft, filename);}
 
+        /**
+         *  Wrap the contents of a file that is already in memory, e.g. one made up by a benchmark.
+         *
+         *  @param filename Name of the file, for messages.
+         *  @param contents The contents of the file.
+         */
+        vfile(const std::string& filename, std::vector<std::uint8_t> contents): fpos(0), fsize(contents.size()), fname(filename), open(true), buffer(std::move(contents))
+        {charge.Set(buffer.capacity());}
+
         /**
          *  Read @c len bytes of data into a destination buffer.
          *
@@ -95,6 +106,7 @@ namespace sh3 { namespace arc {
         bool        open = false; /**< Is this file handle currently open? */
 
         std::vector<std::uint8_t> buffer; /**< Buffer that @ref ReadData() reads from */
+        sh3::system::memory_charge charge{sh3::system::memory_tag::ARC}; /**< Accounts for @ref buffer */
 
         /**
          *  Open a handle to a virtual file.
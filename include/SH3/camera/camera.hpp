@@ -31,6 +31,8 @@
 #ifndef CAMERA_HPP_INCLUDED
 #define CAMERA_HPP_INCLUDED
 
+#include <cstdint>
+
 #include "glm/glm.hpp"
 #include "SH3/angle.hpp"
 
@@ -128,12 +130,41 @@ namespace sh3{namespace camera{
         void AddPitch(angle<float> pitch);
 
         /**
-         *  Calculate the projection matrix of our camera by using glm::lookat.
+         *  Get the view matrix, which transforms from world space into camera space.
+         *
+         *  @return glm::mat4 that is our view matrix. Sent to the shader as part of the MVP matrix (it is the V part).
+         */
+        const glm::mat4& GetViewMatrix() const;
+
+        /**
+         *  Get the perspective projection matrix.
          *
          *  @return glm::mat4 that is our projection matrix. Sent to the shader as part of the MVP matrix (it is the P part).
          */
         const glm::mat4& GetProjectionMatrix() const;
 
+        /**
+         *  Get the combined view and projection matrix (projection * view).
+         *
+         *  @return glm::mat4 that transforms from world space into clip space, e.g. for @ref frustum::FromMatrix.
+         */
+        const glm::mat4& GetViewProjectionMatrix() const;
+
+        /**
+         *  Get the inverse of @ref GetViewMatrix, which transforms from camera space into world space.
+         */
+        const glm::mat4& GetInverseViewMatrix() const;
+
+        /**
+         *  Get the inverse of @ref GetProjectionMatrix, which transforms from clip space into camera space.
+         */
+        const glm::mat4& GetInverseProjectionMatrix() const;
+
+        /**
+         *  Get the inverse of @ref GetViewProjectionMatrix, which transforms from clip space into world space.
+         */
+        const glm::mat4& GetInverseViewProjectionMatrix() const;
+
         #if 0
         /**
          *  Update the camera so we know where we should be each frame.
@@ -156,6 +187,16 @@ namespace sh3{namespace camera{
          */
         float GetZ() const;
 
+        /**
+         *  Get the camera position.
+         */
+        const glm::vec3& GetPosition() const;
+
+        /**
+         *  Get the direction the camera is looking in.
+         */
+        const glm::vec3& GetFront() const;
+
         /**
          *  Get the current yaw of the camera in degrees.
          *
@@ -173,9 +214,39 @@ namespace sh3{namespace camera{
     private:
 
         /**
-         *  Recalculate the perspecitve matrix from updated values;
+         *  Parts of the camera state that are out of date.
+         *
+         *  Everything is computed lazily when it is requested, so changing the camera several times
+         *  per frame only costs the (cheap) change itself.
          */
-        void RecalculatePerspective();
+        enum dirty_flag : std::uint8_t
+        {
+            DIRTY_ORIENTATION               = 1 << 0,   /**< @ref camFront, @ref camRight and @ref camUp */
+            DIRTY_VIEW                      = 1 << 1,   /**< @ref vMatrix */
+            DIRTY_PROJECTION                = 1 << 2,   /**< @ref pMatrix */
+            DIRTY_VIEW_PROJECTION           = 1 << 3,   /**< @ref vpMatrix */
+            DIRTY_INVERSE_VIEW              = 1 << 4,   /**< @ref invVMatrix */
+            DIRTY_INVERSE_PROJECTION        = 1 << 5,   /**< @ref invPMatrix */
+            DIRTY_INVERSE_VIEW_PROJECTION   = 1 << 6,   /**< @ref invVpMatrix */
+        };
+
+        static constexpr std::uint8_t DIRTY_POSITION = DIRTY_VIEW | DIRTY_VIEW_PROJECTION | DIRTY_INVERSE_VIEW | DIRTY_INVERSE_VIEW_PROJECTION; /**< Everything that depends on the position. */
+        static constexpr std::uint8_t DIRTY_ROTATION = DIRTY_ORIENTATION | DIRTY_POSITION;                                                  /**< Everything that depends on yaw and pitch. */
+        static constexpr std::uint8_t DIRTY_LENS = DIRTY_PROJECTION | DIRTY_VIEW_PROJECTION | DIRTY_INVERSE_PROJECTION | DIRTY_INVERSE_VIEW_PROJECTION; /**< Everything that depends on fov, aspect ratio or clip planes. */
+
+        /**
+         *  Check whether a part of the state is out of date, and mark it as up to date.
+         *
+         *  @param flag The @ref dirty_flag to check.
+         *
+         *  @returns @c true if the caller needs to recompute the part.
+         */
+        bool Clean(dirty_flag flag) const;
+
+        /**
+         *  Recalculate the front, right and up vectors from yaw and pitch, if they are out of date.
+         */
+        void UpdateOrientation() const;
 
     private:
         glm::vec3       camPos;             /**< Position of the physical camera in 3D space. */
@@ -183,18 +254,21 @@ namespace sh3{namespace camera{
         float           aRatio;             /**< Aspect ratio for the camera. */
         float           camNear;            /**< Near Z value for frustum culling. */
         float           camFar;             /**< Far Z value for frustim culling (the reason we have fog!!) */
-        glm::vec3       camFront;           /**< Where the camera is looking. Most likely Heather. (This is actually reversed!)*/
-        glm::vec3       camUp;              /**< Up vector of the camera (not the actual world). */
-        glm::mat4       pMatrix;            /**< Our camera's Perspective matrix. */
-        //glm::mat4       vMatrix;            /**< Our camera's View Matrix. */
-        glm::vec3       camRight;           /**< Camera's Right vector. */
+        mutable glm::vec3 camFront;         /**< Where the camera is looking. Most likely Heather. (This is actually reversed!)*/
+        mutable glm::vec3 camUp;            /**< Up vector of the camera (not the actual world). */
+        mutable glm::vec3 camRight;         /**< Camera's Right vector. */
+        mutable glm::mat4 vMatrix;          /**< Our camera's View Matrix. */
+        mutable glm::mat4 pMatrix;          /**< Our camera's Perspective matrix. */
+        mutable glm::mat4 vpMatrix;         /**< @ref pMatrix * @ref vMatrix */
+        mutable glm::mat4 invVMatrix;       /**< Inverse of @ref vMatrix. */
+        mutable glm::mat4 invPMatrix;       /**< Inverse of @ref pMatrix. */
+        mutable glm::mat4 invVpMatrix;      /**< Inverse of @ref vpMatrix. */
+        mutable std::uint8_t dirty;         /**< Which @ref dirty_flag%s are set. */
 
         angle<float>    camPitch;           /**< Camera's pitch (angle on the y-axis). */
         angle<float>    camYaw;             /**< Camera's yaw (angle on the x-axis). */
         MODE            camMode;            /**< What mode the camera is currently in. */
 
-        // bool shouldReset;       /**< Should we refresh the perspective matrix??? */
-
         /** Camera Physics Variables and methods */
 
     public:
@@ -0,0 +1,97 @@
+/** @file
+ *  Definition of @ref sh3::camera::frustum.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_CAMERA_FRUSTUM_HPP_INCLUDED
+#define SH3_CAMERA_FRUSTUM_HPP_INCLUDED
+
+#include <cstddef>
+
+#include <boost/container/small_vector.hpp>
+#include <glm/glm.hpp>
+
+#include "SH3/types/aabb.hpp"
+
+namespace sh3 { namespace camera {
+
+    /**
+     *  A convex volume bounded by planes.
+     *
+     *  Each plane is stored as @c (normal, distance) with the normal pointing into the volume,
+     *  i.e. a point @c p is on the inside of a plane if <tt>dot(normal, p) + distance >= 0</tt>.
+     *
+     *  Frustums extracted from a matrix (@ref FromMatrix) have their planes ordered like @ref plane_index.
+     *  Frustums narrowed through portals (see @ref sh3::scene::portal_graph) may have any number of planes.
+     */
+    struct frustum final
+    {
+    public:
+        /**
+         *  Plane order of a frustum created by @ref FromMatrix.
+         */
+        enum plane_index : std::size_t
+        {
+            PLANE_LEFT,
+            PLANE_RIGHT,
+            PLANE_BOTTOM,
+            PLANE_TOP,
+            PLANE_NEAR, // NEAR and FAR are macros in windef.h
+            PLANE_FAR,
+            PLANE_MAX
+        };
+
+        /** The planes; a typical (portal-narrowed) frustum has few enough to not allocate. */
+        using plane_list = boost::container::small_vector<glm::vec4, 8>;
+
+        /**
+         *  Extract the frustum from a view-projection matrix.
+         *
+         *  @param viewProjection The combined view and projection matrix.
+         *
+         *  @returns The @ref frustum with normalized planes in @ref plane_index order.
+         */
+        static frustum FromMatrix(const glm::mat4& viewProjection);
+
+        /**
+         *  Check whether a point lies inside all planes.
+         *
+         *  @param point The point to check.
+         */
+        bool Contains(const glm::vec3& point) const;
+
+        /**
+         *  Conservatively check whether a sphere intersects the volume.
+         *
+         *  @param center The center of the sphere.
+         *  @param radius The radius of the sphere.
+         *
+         *  @returns @c false only if the sphere is entirely outside of a plane.
+         */
+        bool Intersects(const glm::vec3& center, float radius) const;
+
+        /**
+         *  Conservatively check whether an @ref aabb intersects the volume.
+         *
+         *  @param box The @ref aabb to check.
+         *
+         *  @returns @c false only if the box is entirely outside of a plane.
+         */
+        bool Intersects(const aabb& box) const;
+
+        /**
+         *  Signed distance of a point to a plane.
+         *
+         *  @param plane The plane.
+         *  @param point The point.
+         *
+         *  @returns A positive value if @p point is on the inside.
+         */
+        static float Distance(const glm::vec4& plane, const glm::vec3& point) { return glm::dot(glm::vec3(plane.x, plane.y, plane.z), point) + plane.w; }
+
+        plane_list planes{}; /**< The bounding planes. */
+    };
+
+} }
+
+#endif // SH3_CAMERA_FRUSTUM_HPP_INCLUDED
@@ -0,0 +1,225 @@
+/** @file
+ *  Camera trigger volumes from the @c .cam files.
+ *
+ *  When the player walks into one of these volumes, the camera switches to the behaviour stored with it
+ *  (see @ref camera.hpp). Areas can have a lot of them, so they are kept in a spatial hash and only the
+ *  volumes near the player are tested each frame.
+ *
+ *  @note The layout of the @c .cam files is not fully understood yet. The structures below describe our current
+ *        working assumption: a short header pointing to a list of fixed-size records, each an axis-aligned volume
+ *        followed by the camera position and target to use while inside. Anything we have no use for yet is marked unknown.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_CAMERA_TRIGGER_HPP_INCLUDED
+#define SH3_CAMERA_TRIGGER_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SH3/error.hpp"
+#include "SH3/system/arena.hpp"
+#include "SH3/types/aabb.hpp"
+
+namespace sh3 { namespace arc {
+    struct mft;
+} }
+
+namespace sh3 { namespace camera {
+
+    /** @defgroup camera-headers Camera headers
+     *  @{
+     */
+
+    #pragma pack(push, 1)
+
+    /**
+     *  Header at the start of a @c .cam file.
+     */
+    struct cam_header
+    {
+        std::uint32_t triggerCount;     /**< Number of @ref cam_trigger%s in this file. */
+        std::uint32_t triggerOffset;    /**< Offset from the start of the file to the first @ref cam_trigger. */
+        std::uint32_t unknown[2];       /**< Unknown. */
+    };
+
+    /**
+     *  A camera trigger volume.
+     */
+    struct cam_trigger
+    {
+        float         min[4];       /**< Minimum corner of the volume as x, y, z and an unused w. */
+        float         max[4];       /**< Maximum corner of the volume as x, y, z and an unused w. */
+        float         position[4];  /**< Where the camera is placed while inside the volume. */
+        float         target[4];    /**< What the camera looks at while inside the volume. */
+        std::uint32_t mode;         /**< Camera behaviour (static, follow, ...). Meaning of the values unknown. */
+        std::uint32_t unknown[3];   /**< Unknown. */
+    };
+
+    #pragma pack(pop)
+
+    /** @}*/
+
+    /**
+     *  A trigger volume and the camera setup it activates.
+     */
+    struct trigger final
+    {
+        aabb bounds;            /**< The volume. */
+        glm::vec3 position;     /**< See @ref cam_trigger::position. */
+        glm::vec3 target;       /**< See @ref cam_trigger::target. */
+        std::uint32_t mode;     /**< See @ref cam_trigger::mode. */
+    };
+
+    /**
+     *  The camera triggers of an area, indexed by a spatial hash.
+     *
+     *  Space is divided into a uniform grid of cubic cells, and each trigger is stored in every cell it overlaps.
+     *  Only the occupied cells are kept (in a hash map), so the grid is unbounded.
+     *  Testing a point then only has to look at the triggers of the one cell it is in.
+     *
+     *  Triggers that would span more than @ref maxCellsPerTrigger cells are not put into the grid, but
+     *  are tested on every query instead; there should be very few of them.
+     *
+     *  The triggers and the grid live as long as the area, so they are kept in its @ref sh3::system::arena;
+     *  the map must not be used after that is reset.
+     */
+    class trigger_map final
+    {
+    public:
+        using trigger_index = std::uint32_t;                                    /**< Index into @ref GetTriggers. */
+        using trigger_list = sh3::system::arena_vector<trigger>;                /**< The triggers, in the arena. */
+
+        static constexpr float defaultCellSize = 1024.0f;       /**< Default edge length of a grid cell. */
+        static constexpr std::size_t maxCellsPerTrigger = 64;   /**< Larger triggers are tested on every query. */
+
+        enum class load_result
+        {
+            SUCCESS,
+            FILE_NOT_FOUND,
+            BAD_HEADER,
+            TRUNCATED,
+        };
+
+        struct load_error final : public error<load_result>
+        {
+        public:
+            std::string message() const;
+        };
+
+        /**
+         *  Load a @c .cam file.
+         *
+         *  @param mft      The @ref sh3::arc::mft to load the file from.
+         *  @param filename Path of the file in the arc.
+         *  @param memory   The arena of the area to keep the triggers and the grid in.
+         *  @param[out] err The @ref load_error of this operation.
+         *  @param gridCellSize Edge length of a grid cell; should be about the size of a typical trigger.
+         */
+        trigger_map(arc::mft& mft, const std::string& filename, sh3::system::arena& memory, load_error& err, float gridCellSize = defaultCellSize);
+
+        /**
+         *  Build a trigger map from triggers.
+         *
+         *  @param triggerList  The triggers; copied into @p memory.
+         *  @param memory       The arena of the area to keep the triggers and the grid in.
+         *  @param gridCellSize Edge length of a grid cell; should be about the size of a typical trigger.
+         */
+        trigger_map(const std::vector<trigger>& triggerList, sh3::system::arena& memory, float gridCellSize = defaultCellSize);
+
+        /**
+         *  Move the tracked position and report the triggers that were entered and left.
+         *
+         *  @param position     The new position of the player.
+         *  @param[out] entered Triggers the position is inside now, but was not before. Cleared first.
+         *  @param[out] exited  Triggers the position was inside before, but is not anymore. Cleared first.
+         *
+         *  @returns @c true if anything was entered or left.
+         */
+        bool Update(const glm::vec3& position, std::vector<trigger_index>& entered, std::vector<trigger_index>& exited);
+
+        /**
+         *  Forget the tracked position, so the next @ref Update reports all triggers it is in as entered.
+         */
+        void Reset() { active.clear(); }
+
+        /**
+         *  Find all triggers containing a point.
+         *
+         *  @param position The point.
+         *  @param[out] found The triggers, in ascending order. Cleared first.
+         */
+        void Query(const glm::vec3& position, std::vector<trigger_index>& found) const;
+
+        /**
+         *  Find all triggers overlapping a box.
+         *
+         *  @param box The box.
+         *  @param[out] found The triggers, in ascending order. Cleared first.
+         */
+        void Query(const aabb& box, std::vector<trigger_index>& found) const;
+
+        /**
+         *  Get the triggers the tracked position is inside of, in ascending order.
+         */
+        const std::vector<trigger_index>& GetActive() const { return active; }
+
+        /**
+         *  Get all triggers.
+         */
+        const trigger_list& GetTriggers() const { return triggers; }
+
+        /**
+         *  Get a trigger.
+         */
+        const trigger& GetTrigger(trigger_index index) const { return triggers[index]; }
+
+    private:
+        using cell_key = std::uint64_t;
+        using index_list = sh3::system::arena_vector<trigger_index>;
+        using cell_map = std::unordered_map<cell_key, index_list, std::hash<cell_key>, std::equal_to<cell_key>, sh3::system::arena_allocator<std::pair<const cell_key, index_list>>>;
+
+        /**
+         *  Get the grid coordinates of the cell containing a point.
+         */
+        glm::ivec3 CellOf(const glm::vec3& point) const;
+
+        /**
+         *  Pack grid coordinates into a key for @ref cells.
+         */
+        static cell_key KeyOf(const glm::ivec3& cell);
+
+        /**
+         *  Put all triggers into the grid.
+         */
+        void Build();
+
+        /**
+         *  Parse the file.
+         *
+         *  @param mft      The @ref sh3::arc::mft to load the file from.
+         *  @param filename Path of the file in the arc.
+         *  @param[out] err The @ref load_error of this operation.
+         *
+         *  @returns The triggers.
+         */
+        static std::vector<trigger> Load(arc::mft& mft, const std::string& filename, load_error& err);
+
+        trigger_list triggers;                                              /**< All triggers. */
+        float cellSize;                                                     /**< Edge length of a grid cell. */
+        float invCellSize;                                                  /**< 1 / @ref cellSize. */
+        cell_map cells;                                                     /**< The triggers overlapping each occupied cell, in ascending order. */
+        index_list oversized;                                               /**< Triggers too large for the grid, in ascending order. */
+        std::vector<trigger_index> active;                                  /**< Triggers containing the tracked position, in ascending order. */
+        std::vector<trigger_index> scratch;                                 /**< Reused by @ref Update to avoid allocating each frame. */
+    };
+
+} }
+
+#endif // SH3_CAMERA_TRIGGER_HPP_INCLUDED
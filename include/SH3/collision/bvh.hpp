@@ -0,0 +1,202 @@
+/** @file
+ *  Bounding volume hierarchy over collision triangles.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_COLLISION_BVH_HPP_INCLUDED
+#define SH3_COLLISION_BVH_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SH3/types/aabb.hpp"
+
+namespace sh3 { namespace collision {
+
+    /**
+     *  A collision triangle.
+     */
+    struct triangle final
+    {
+        glm::vec3 v0, v1, v2; /**< The corners. */
+    };
+
+    /**
+     *  A ray for @ref bvh::Raycast.
+     */
+    struct ray final
+    {
+        glm::vec3 origin;       /**< Start of the ray. */
+        glm::vec3 direction;    /**< Direction of the ray; does not need to be normalized. */
+        float maxDistance;      /**< Length of the ray, in multiples of @ref direction. */
+    };
+
+    /**
+     *  Result of a @ref bvh query hitting a triangle.
+     */
+    struct hit final
+    {
+        static constexpr std::uint32_t noTriangle = std::numeric_limits<std::uint32_t>::max(); /**< @ref triangle if nothing was hit. */
+
+        std::uint32_t triangle = noTriangle;    /**< Index of the hit triangle in the mesh the @ref bvh was built from. */
+        float distance = 0.0f;                  /**< Distance along the query, in multiples of the query direction. */
+        glm::vec3 point = glm::vec3();          /**< Point of contact on the triangle. */
+        glm::vec3 normal = glm::vec3();         /**< Normal of the contact, facing against the query direction. */
+
+        /** Check whether anything was hit. */
+        explicit operator bool() const { return triangle != noTriangle; }
+    };
+
+    /**
+     *  A triangle touched by a capsule in @ref bvh::OverlapCapsule.
+     */
+    struct contact final
+    {
+        std::uint32_t triangle; /**< Index of the triangle in the mesh the @ref bvh was built from. */
+        glm::vec3 point;        /**< Closest point on the triangle to the capsule axis. */
+        glm::vec3 normal;       /**< Direction to push the capsule out of the triangle. */
+        float depth;            /**< How far the capsule penetrates the triangle. */
+    };
+
+    /**
+     *  A bounding volume hierarchy built with the surface area heuristic (SAH).
+     *
+     *  The hierarchy is immutable after construction, and all queries are @c const and use no shared scratch memory,
+     *  so any number of threads may query the same @ref bvh concurrently.
+     */
+    class bvh final
+    {
+    public:
+        /**
+         *  Build the hierarchy.
+         *
+         *  @param triangles The triangles of the collision mesh. Query results refer to indices into this list.
+         */
+        explicit bvh(const std::vector<triangle>& triangles);
+
+        /**
+         *  Find the closest triangle hit by a ray.
+         *
+         *  @param query The ray.
+         *
+         *  @returns The closest @ref hit; if nothing is hit, it converts to @c false.
+         */
+        hit Raycast(const ray& query) const;
+
+        /**
+         *  Check whether a ray hits anything.
+         *
+         *  Cheaper than @ref Raycast since it stops at the first hit.
+         *
+         *  @param query The ray.
+         */
+        bool RaycastAny(const ray& query) const;
+
+        /**
+         *  Cast a number of rays.
+         *
+         *  @param queries The rays.
+         *  @param[out] hits Results, one per ray.
+         *  @param count   The number of rays.
+         */
+        void Raycast(const ray* queries, hit* hits, std::size_t count) const;
+
+        /**
+         *  Move a sphere and find the first triangle it touches.
+         *
+         *  @param from   The start position of the center.
+         *  @param to     The end position of the center.
+         *  @param radius The radius of the sphere.
+         *
+         *  @returns The first @ref hit, where @ref hit::distance is the fraction [0..1] of the way travelled
+         *           and @ref hit::point is the touched point. A sphere that starts out intersecting a triangle hits at 0.
+         */
+        hit SphereSweep(const glm::vec3& from, const glm::vec3& to, float radius) const;
+
+        /**
+         *  Move a number of spheres.
+         *
+         *  @param from   The start positions.
+         *  @param to     The end positions.
+         *  @param radius The radius of all spheres.
+         *  @param[out] hits Results, one per sphere.
+         *  @param count  The number of spheres.
+         */
+        void SphereSweep(const glm::vec3* from, const glm::vec3* to, float radius, hit* hits, std::size_t count) const;
+
+        /**
+         *  Find all triangles touching a capsule.
+         *
+         *  @param a      One end of the capsule axis.
+         *  @param b      The other end of the capsule axis.
+         *  @param radius The radius of the capsule.
+         *  @param[out] contacts The touched triangles are appended here.
+         *
+         *  @returns The number of contacts appended.
+         */
+        std::size_t OverlapCapsule(const glm::vec3& a, const glm::vec3& b, float radius, std::vector<contact>& contacts) const;
+
+        /**
+         *  Get the bounds of everything.
+         */
+        aabb GetBounds() const { return nodes.empty() ? aabb() : aabb(nodes.front().min, nodes.front().max); }
+
+        /**
+         *  Get the number of nodes in the hierarchy.
+         */
+        std::size_t GetNodeCount() const { return nodes.size(); }
+
+    private:
+        /**
+         *  A node of the hierarchy, 32 bytes.
+         *
+         *  For inner nodes, @ref first is the index of the left child, the right child follows directly after.
+         *  For leaves, @ref first is the index of the first triangle in @ref triangles.
+         */
+        struct node final
+        {
+            glm::vec3 min;          /**< Minimum corner of the bounds. */
+            std::uint32_t first;    /**< Left child or first triangle. */
+            glm::vec3 max;          /**< Maximum corner of the bounds. */
+            std::uint32_t count;    /**< Number of triangles, 0 for inner nodes. */
+        };
+
+        /** Maximum depth of the hierarchy, which bounds the traversal stack. */
+        static constexpr std::size_t maxDepth = 64;
+
+        /**
+         *  Split a node, recursively.
+         *
+         *  @param index The node to split.
+         *  @param depth The depth of the node.
+         *  @param centroids Centroids of the triangles, in the same order as @ref triangles.
+         */
+        void Subdivide(std::uint32_t index, std::size_t depth, std::vector<glm::vec3>& centroids);
+
+        /**
+         *  Compute the bounds of a node from its triangles.
+         */
+        void UpdateBounds(node& n) const;
+
+        /**
+         *  Walk the hierarchy, nearest child first.
+         *
+         *  @tparam node_test     <tt>float(const node&)</tt>, the distance at which the query enters a node, or infinity to skip it.
+         *                        Nodes are re-tested when taken off the stack, so the test may narrow down as hits are found.
+         *  @tparam triangle_test <tt>bool(std::uint32_t)</tt>, visits a triangle in @ref triangles; return @c false to stop.
+         */
+        template<typename node_test, typename triangle_test>
+        void Traverse(node_test&& enterNode, triangle_test&& visitTriangle) const;
+
+        std::vector<node> nodes;                /**< The nodes, root first. */
+        std::vector<triangle> triangles;        /**< The triangles, reordered so that each leaf has a contiguous range. */
+        std::vector<std::uint32_t> indices;     /**< Maps @ref triangles to the indices in the source mesh. */
+    };
+
+} }
+
+#endif // SH3_COLLISION_BVH_HPP_INCLUDED
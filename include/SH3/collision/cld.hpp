@@ -0,0 +1,114 @@
+/** @file
+ *  Loader for the collision data (@c .cld) files.
+ *
+ *  @note The layout of the @c .cld files is not fully understood yet. The structures below describe our current
+ *        working assumption: a short header pointing to a list of faces, each stored as four (padded) vertices,
+ *        where a triangle repeats its last vertex. Anything we have no use for yet is marked unknown.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_COLLISION_CLD_HPP_INCLUDED
+#define SH3_COLLISION_CLD_HPP_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SH3/collision/bvh.hpp"
+#include "SH3/error.hpp"
+
+namespace sh3 { namespace arc {
+    struct mft;
+} }
+
+namespace sh3 { namespace collision {
+
+    /** @defgroup collision-headers Collision headers
+     *  @{
+     */
+
+    #pragma pack(push, 1)
+
+    /**
+     *  Header at the start of a @c .cld file.
+     */
+    struct cld_header
+    {
+        std::uint32_t unknown1;     /**< Unknown, possibly a version or area identifier. */
+        std::uint32_t faceCount;    /**< Number of @ref cld_face%s in this file. */
+        std::uint32_t faceOffset;   /**< Offset from the start of the file to the first @ref cld_face. */
+        std::uint32_t unknown2[5];  /**< Unknown. */
+    };
+
+    /**
+     *  A collision face.
+     */
+    struct cld_face
+    {
+        float         vertices[4][4];   /**< Corners as x, y, z and an unused w. Triangles repeat the third corner. */
+        std::uint32_t attributes;       /**< Surface attributes (floor, wall, ...). Meaning unknown. */
+        std::uint32_t unknown[3];       /**< Unknown. */
+    };
+
+    #pragma pack(pop)
+
+    /** @}*/
+
+    /**
+     *  Collision geometry of an area.
+     */
+    struct collision_mesh final
+    {
+    public:
+        enum class load_result
+        {
+            SUCCESS,
+            FILE_NOT_FOUND,
+            BAD_HEADER,
+            TRUNCATED,
+        };
+
+        struct load_error final : public error<load_result>
+        {
+        public:
+            std::string message() const;
+        };
+
+        /**
+         *  Load a @c .cld file and build its @ref bvh.
+         *
+         *  @param mft      The @ref sh3::arc::mft to load the file from.
+         *  @param filename Path of the file in the arc.
+         *  @param[out] err The @ref load_error of this operation.
+         */
+        collision_mesh(arc::mft& mft, const std::string& filename, load_error& err);
+
+        /**
+         *  Build a collision mesh from triangles.
+         *
+         *  @param tris The triangles; all get attribute 0.
+         */
+        explicit collision_mesh(std::vector<triangle> tris);
+
+        std::vector<std::uint32_t> attributes;      /**< The @ref cld_face::attributes for each triangle. */
+        std::vector<triangle> triangles;            /**< The triangles, quads are split in two. */
+        bvh hierarchy;                              /**< Acceleration structure over @ref triangles. Query results index into @ref triangles. */
+
+    private:
+        /**
+         *  Parse the file.
+         *
+         *  Fills @ref attributes, so it must run after that has been constructed.
+         *
+         *  @param mft      The @ref sh3::arc::mft to load the file from.
+         *  @param filename Path of the file in the arc.
+         *  @param[out] err The @ref load_error of this operation.
+         *
+         *  @returns The triangles.
+         */
+        std::vector<triangle> Load(arc::mft& mft, const std::string& filename, load_error& err);
+    };
+
+} }
+
+#endif // SH3_COLLISION_CLD_HPP_INCLUDED
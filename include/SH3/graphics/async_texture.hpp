@@ -0,0 +1,45 @@
+/** @file
+ *  Loading textures in the background.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_GRAPHICS_ASYNC_TEXTURE_HPP_INCLUDED
+#define SH3_GRAPHICS_ASYNC_TEXTURE_HPP_INCLUDED
+
+#include <memory>
+#include <string>
+
+#include "SH3/arc/async_mft.hpp"
+#include "SH3/graphics/texture.hpp"
+#include "SH3/system/task.hpp"
+
+namespace sh3_graphics
+{
+    using image_task = sh3::system::task<std::shared_ptr<texture_image>>;
+    using texture_task = sh3::system::task<std::shared_ptr<sh3_texture>>;
+
+    /**
+     *  Read and decode a texture in the background, leaving the upload to the caller.
+     *
+     *  @param files    Where to read the file from; decoding runs on its job system as well.
+     *  @param filename The name of the texture file.
+     *
+     *  @returns A task for the decoded pixels, @c nullptr if the texture is malformed.
+     */
+    image_task DecodeTextureAsync(sh3::arc::async_mft& files, const std::string& filename);
+
+    /**
+     *  Load a texture in the background.
+     *
+     *  The file is read and decoded on the job system of @p files, then uploaded from @p mainQueue.
+     *
+     *  @param files     Where to read the file from.
+     *  @param mainQueue Run by the thread owning the GL context.
+     *  @param filename  The name of the texture file.
+     *
+     *  @returns A task for the texture. Malformed textures result in an empty texture, like @ref sh3_texture::Load.
+     */
+    texture_task LoadTextureAsync(sh3::arc::async_mft& files, sh3::system::main_thread_queue& mainQueue, const std::string& filename);
+}
+
+#endif // SH3_GRAPHICS_ASYNC_TEXTURE_HPP_INCLUDED
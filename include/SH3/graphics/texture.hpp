@@ -19,6 +19,10 @@
 #define SH3_TEXTURE_HPP_INCLUDED
 
 #include "SH3/arc/vfile.hpp"
+#include "SH3/system/memory_tags.hpp"
+
+#include <cstdint>
+#include <vector>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
@@ -103,6 +107,22 @@ namespace sh3_graphics
 
     /**@}*/
 
+    /**
+     *  Pixels decoded from a texture file, ready to be uploaded.
+     *
+     *  Decoding needs no GL context, so it can happen on any thread.
+     */
+    struct texture_image final
+    {
+        GLsizei width = 0;                  /**< The width in pixels */
+        GLsizei height = 0;                 /**< The height in pixels */
+        GLenum srcFormat = GL_RGBA;         /**< Format of @ref pixels */
+        GLint dstFormat = GL_RGBA;          /**< Format of the texture on the gpu */
+        GLenum type = GL_UNSIGNED_BYTE;     /**< Type of the components in @ref pixels */
+        std::vector<std::uint8_t> pixels{}; /**< The pixel data */
+        sh3::system::memory_charge charge{sh3::system::memory_tag::TEXTURE}; /**< Accounts for @ref pixels */
+    };
+
     /**
      *
      * Describes a logical texture that can be bound to OpenGL
@@ -123,8 +143,12 @@ namespace sh3_graphics
             PALETTE = 8,
         };
 
+        sh3_texture() = default;
         sh3_texture(sh3::arc::mft& mft, const std::string& filename){Load(mft, filename);}
-        ~sh3_texture(){}
+        ~sh3_texture();
+
+        sh3_texture(const sh3_texture&) = delete;
+        sh3_texture& operator=(const sh3_texture&) = delete;
 
         /**
          *  Loads a texture from a Virtual File and creates a logical texture
@@ -134,6 +158,27 @@ namespace sh3_graphics
          */
         void Load(sh3::arc::mft& mft, const std::string& filename);
 
+        /**
+         *  Decode the pixels of a texture file, without touching OpenGL.
+         *
+         *  @param file  The texture file.
+         *  @param image Receives the decoded pixels.
+         *
+         *  @returns @c false if the texture is malformed.
+         */
+        static bool Decode(sh3::arc::vfile& file, texture_image& image);
+
+        /**
+         *  Create the logical texture on the gpu from decoded pixels.
+         *
+         *  Uses direct state access where available, so the texture bindings stay as they are.
+         *
+         *  @note Needs the GL context, i.e. must run on the main thread.
+         *
+         *  @param image The pixels from @ref Decode.
+         */
+        void Upload(const texture_image& image);
+
         /**
          *  Bind this texture for use with any draw calls
          *
@@ -147,7 +192,14 @@ namespace sh3_graphics
          void Unbind();
 
     private:
-        GLuint tex;                         /**< ID representing this texture */
+        /**
+         *  @ref Upload without direct state access, binding the texture to edit it.
+         */
+        void UploadBound(const texture_image& image);
+
+    private:
+        GLuint tex = 0;                     /**< ID representing this texture */
+        sh3::system::memory_charge charge{sh3::system::memory_tag::GPU_TEXTURE}; /**< Estimated size of the texture on the gpu */
     };
 }
 
@@ -0,0 +1,218 @@
+/** @file
+ *  Fast polynomial approximations of trigonometric functions.
+ *
+ *  These trade the last bit of precision and the handling of huge arguments for speed, and come in
+ *  batch versions that process four values at a time with SSE2, or eight with AVX2, as picked at runtime by
+ *  @ref sh3::system::GetSimdLevel.
+ *
+ *  Error bounds (absolute, measured against @c libm over the documented domain by @c tests/trig.cpp):
+ *   - @ref Sin, @ref Cos, @ref SinCos: at most 4e-7 for <tt>|x| <= 1e4</tt>.
+ *     Larger arguments lose precision in the range reduction; beyond @ref maxTrigArgument the result is meaningless.
+ *   - @ref Atan2: at most 4e-7 radians for all finite inputs. <tt>Atan2(0, 0)</tt> returns 0.
+ *
+ *  The batch versions compute exactly the same polynomials as the scalar ones.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_MATH_TRIG_HPP_INCLUDED
+#define SH3_MATH_TRIG_HPP_INCLUDED
+
+#include <cmath>
+#include <cstddef>
+
+namespace sh3 { namespace math {
+
+    constexpr float maxTrigArgument = 8388608.0f; /**< Largest argument (2^23) the range reduction of @ref Sin and @ref Cos can handle at all. */
+
+    namespace detail {
+        constexpr float pi = 3.14159265358979323846f;
+        constexpr float halfPi = 1.57079632679489661923f;
+        constexpr float quarterPi = 0.78539816339744830962f;
+        constexpr float twoOverPi = 0.63661977236758134308f;
+        constexpr float tanEighthPi = 0.41421356237309504880f;
+
+        // pi/2 split into three parts (Cody-Waite), so that k * part is exact for the first two
+        constexpr float halfPiA = 1.5703125f;
+        constexpr float halfPiB = 4.837512969970703125e-4f;
+        constexpr float halfPiC = 7.54978995489188216e-8f;
+
+        /**
+         *  sin(x) for x in [-pi/4, pi/4].
+         */
+        inline float SinPoly(float x)
+        {
+            const float z = x * x;
+            return x + x * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+        }
+
+        /**
+         *  cos(x) for x in [-pi/4, pi/4].
+         */
+        inline float CosPoly(float x)
+        {
+            const float z = x * x;
+            return 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f);
+        }
+
+        /**
+         *  atan(x) for x in [0, 1].
+         */
+        inline float AtanPoly(float x)
+        {
+            float offset = 0.0f;
+            if(x > tanEighthPi)
+            {
+                offset = quarterPi;
+                x = (x - 1.0f) / (x + 1.0f);
+            }
+            const float z = x * x;
+            return offset + ((((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * x + x);
+        }
+
+        /**
+         *  Reduce an angle to [-pi/4, pi/4].
+         *
+         *  @param x            The angle.
+         *  @param[out] quadrant The number of quarter turns that were subtracted, modulo 4.
+         *
+         *  @returns The reduced angle.
+         */
+        inline float Reduce(float x, unsigned& quadrant)
+        {
+            // floor(x * 2/pi + 0.5), without the library call std::floor turns into on plain SSE2
+            const float v = x * twoOverPi + 0.5f;
+            long ki = static_cast<long>(v);
+            ki -= static_cast<float>(ki) > v; // truncation rounds negative values up
+            const float k = static_cast<float>(ki);
+            quadrant = static_cast<unsigned>(ki) & 3;
+            return ((x - k * halfPiA) - k * halfPiB) - k * halfPiC;
+        }
+
+        /**
+         *  Get the sign of the result for a quadrant: -1 if bit 1 is set, 1 otherwise.
+         */
+        inline float Sign(unsigned quadrant)
+        {
+            return 1.0f - static_cast<float>(quadrant & 2);
+        }
+    }
+
+    /**
+     *  Compute the sine and cosine of an angle at once.
+     *
+     *  @param x The angle in radians.
+     *  @param[out] sine   sin(x)
+     *  @param[out] cosine cos(x)
+     */
+    inline void SinCos(float x, float& sine, float& cosine)
+    {
+        unsigned quadrant;
+        const float r = detail::Reduce(x, quadrant);
+        // The quadrant is effectively random, so select with table lookups instead of (badly predicted) branches.
+        const float values[2] = {detail::SinPoly(r), detail::CosPoly(r)};
+        sine = values[quadrant & 1] * detail::Sign(quadrant);
+        cosine = values[(quadrant & 1) ^ 1] * detail::Sign(quadrant + 1);
+    }
+
+    /**
+     *  Compute the sine of an angle.
+     *
+     *  @param x The angle in radians.
+     */
+    inline float Sin(float x)
+    {
+        unsigned quadrant;
+        const float r = detail::Reduce(x, quadrant);
+        const float values[2] = {detail::SinPoly(r), detail::CosPoly(r)};
+        return values[quadrant & 1] * detail::Sign(quadrant);
+    }
+
+    /**
+     *  Compute the cosine of an angle.
+     *
+     *  @param x The angle in radians.
+     */
+    inline float Cos(float x)
+    {
+        unsigned quadrant;
+        const float r = detail::Reduce(x, quadrant);
+        const float values[2] = {detail::CosPoly(r), detail::SinPoly(r)};
+        return values[quadrant & 1] * detail::Sign(quadrant + 1);
+    }
+
+    /**
+     *  Compute the angle of the vector (x, y).
+     *
+     *  @param y The y component.
+     *  @param x The x component.
+     *
+     *  @returns The angle in radians, in [-pi, pi].
+     */
+    inline float Atan2(float y, float x)
+    {
+        const float ax = std::fabs(x), ay = std::fabs(y);
+        const bool steep = ay > ax;
+        const float num = steep ? ax : ay;
+        const float den = steep ? ay : ax;
+        float result = den > 0.0f ? detail::AtanPoly(num / den) : 0.0f;
+        if(steep)
+        {
+            result = detail::halfPi - result;
+        }
+        if(x < 0.0f)
+        {
+            result = detail::pi - result;
+        }
+        return std::copysign(result, y);
+    }
+
+    /**
+     *  @ref SinCos of a double, which simply uses the standard library.
+     */
+    inline void SinCos(double x, double& sine, double& cosine)
+    {
+        sine = std::sin(x);
+        cosine = std::cos(x);
+    }
+
+    /**
+     *  Compute @ref SinCos for a number of angles.
+     *
+     *  @param angles The angles in radians.
+     *  @param[out] sines   The sines, one per angle.
+     *  @param[out] cosines The cosines, one per angle.
+     *  @param count  The number of angles.
+     */
+    void SinCos(const float* angles, float* sines, float* cosines, std::size_t count);
+
+    /**
+     *  Compute @ref Sin for a number of angles.
+     *
+     *  @param angles The angles in radians.
+     *  @param[out] sines The sines, one per angle.
+     *  @param count  The number of angles.
+     */
+    void Sin(const float* angles, float* sines, std::size_t count);
+
+    /**
+     *  Compute @ref Cos for a number of angles.
+     *
+     *  @param angles The angles in radians.
+     *  @param[out] cosines The cosines, one per angle.
+     *  @param count  The number of angles.
+     */
+    void Cos(const float* angles, float* cosines, std::size_t count);
+
+    /**
+     *  Compute @ref Atan2 for a number of vectors.
+     *
+     *  @param y The y components.
+     *  @param x The x components.
+     *  @param[out] angles The angles, one per vector.
+     *  @param count The number of vectors.
+     */
+    void Atan2(const float* y, const float* x, float* angles, std::size_t count);
+
+} }
+
+#endif // SH3_MATH_TRIG_HPP_INCLUDED
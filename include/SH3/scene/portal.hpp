@@ -0,0 +1,231 @@
+/** @file
+ *  Cell and portal based visibility for indoor areas.
+ *
+ *  The interiors of SILENT HILL 3 are rooms connected by doors and corridors. Each room is a
+ *  @ref sh3::scene::portal_graph::cell, and each opening between two rooms is a (convex) @ref sh3::scene::portal_graph::portal.
+ *  Starting in the cell the camera is in, the view @ref sh3::camera::frustum is narrowed down through every
+ *  portal that is visible, so only rooms that can actually be seen are handed to the renderer.
+ *
+ *  Optionally a potentially visible set (PVS) can be precomputed per cell, which allows skipping
+ *  the traversal into cells that can never be seen from anywhere in the cell the camera is in.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SCENE_PORTAL_HPP_INCLUDED
+#define SH3_SCENE_PORTAL_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+#include <boost/dynamic_bitset.hpp>
+#include <glm/glm.hpp>
+
+#include "SH3/camera/frustum.hpp"
+#include "SH3/types/aabb.hpp"
+
+namespace sh3 { namespace camera {
+    struct Camera;
+} }
+
+namespace sh3 { namespace scene {
+
+    /**
+     *  The rooms (cells) of an area and the portals that connect them.
+     */
+    class portal_graph final
+    {
+    public:
+        using cell_index = std::uint16_t;    /**< Index of a @ref cell. */
+        using portal_index = std::uint16_t;  /**< Index of a @ref portal. */
+
+        static constexpr cell_index noCell = std::numeric_limits<cell_index>::max();        /**< Returned if a position is not inside any @ref cell. */
+        static constexpr portal_index noPortal = std::numeric_limits<portal_index>::max();  /**< The "portal" the viewer's own cell is seen through. */
+
+        /**
+         *  A room.
+         */
+        struct cell final
+        {
+            aabb bounds;                        /**< Bounds of the room, used to locate the camera. */
+            std::vector<portal_index> portals;  /**< The portals leading out of this room. */
+        };
+
+        /**
+         *  A convex opening between two cells.
+         */
+        struct portal final
+        {
+            std::array<cell_index, 2> cells{{}}; /**< The two cells this portal connects. */
+            std::vector<glm::vec3> polygon{};    /**< The (convex, planar) outline of the opening. */
+            glm::vec4 plane{};                   /**< The plane of @ref polygon, facing into @c cells[1]. */
+            aabb bounds{};                       /**< Bounds of @ref polygon. */
+        };
+
+        /**
+         *  A @ref cell that is visible, and the frustum it is visible through.
+         */
+        struct visible_cell final
+        {
+            cell_index cell;            /**< The visible cell. */
+            portal_index portal;        /**< The portal the cell is seen through, or @ref noPortal for the cell of the viewer. */
+            camera::frustum view;       /**< The view narrowed by all portals leading into the cell. */
+        };
+
+        /**
+         *  Result of a @ref Traverse.
+         *
+         *  A cell may be seen through more than one portal chain, in which case it is listed more than once,
+         *  each time with a different frustum. An object in the cell is visible if it intersects any of them.
+         *  A chain whose frustum lies within one the cell was already seen through is not followed.
+         *
+         *  The set may be reused across frames, @ref Clear does not release memory.
+         */
+        struct visible_set final
+        {
+        public:
+            /**
+             *  Reset the set for another @ref Traverse.
+             *
+             *  @param numCells The number of cells in the @ref portal_graph.
+             */
+            void Clear(std::size_t numCells) { entries.clear(); cells.resize(numCells); cells.reset(); }
+
+            /**
+             *  Check whether a cell was reached by the traversal at all.
+             *
+             *  @param index The cell to check.
+             */
+            bool IsVisible(cell_index index) const { return index < cells.size() && cells.test(index); }
+
+            /**
+             *  Check whether a box inside a cell is visible.
+             *
+             *  @param index The cell the box is in.
+             *  @param box   The box to check.
+             */
+            bool IsVisible(cell_index index, const aabb& box) const;
+
+            std::vector<visible_cell> entries{}; /**< All (cell, frustum) pairs found by the traversal. */
+            boost::dynamic_bitset<> cells{};     /**< One bit per cell, set if the cell is in @ref entries. */
+        };
+
+        /**
+         *  Add a cell.
+         *
+         *  @param bounds The bounds of the room.
+         *
+         *  @returns The index of the new cell.
+         */
+        cell_index AddCell(const aabb& bounds);
+
+        /**
+         *  Add a portal between two cells.
+         *
+         *  Invalidates the PVS.
+         *
+         *  @param from    One of the cells.
+         *  @param to      The other cell.
+         *  @param polygon The convex outline of the opening, at least 3 points.
+         *
+         *  @returns The index of the new portal.
+         */
+        portal_index AddPortal(cell_index from, cell_index to, std::vector<glm::vec3> polygon);
+
+        /**
+         *  Find the cell containing a position.
+         *
+         *  If cells overlap, the smallest one containing the position is returned.
+         *
+         *  @param position The position to locate.
+         *
+         *  @returns The cell, or @ref noCell.
+         */
+        cell_index FindCell(const glm::vec3& position) const;
+
+        /**
+         *  Find all cells visible from a position.
+         *
+         *  @param eye   The position of the viewer.
+         *  @param view  The view frustum, as created by @ref camera::frustum::FromMatrix.
+         *  @param[out] result The visible cells.
+         *
+         *  If @p eye is not inside a cell, @p result will be empty.
+         */
+        void Traverse(const glm::vec3& eye, const camera::frustum& view, visible_set& result) const;
+
+        /**
+         *  Find all cells visible from a @ref camera::Camera.
+         *
+         *  @param cam The camera.
+         *  @param[out] result The visible cells.
+         */
+        void Traverse(const camera::Camera& cam, visible_set& result) const;
+
+        /**
+         *  Precompute the potentially visible set of every cell.
+         *
+         *  The PVS is conservative: a cell is left out only if no line leaving the cell through one of its portals can
+         *  pass through every portal of a chain leading to it. Each portal of a chain is clipped to the planes separating
+         *  the first portal from the (clipped) previous one, which bound all such lines.
+         */
+        void ComputePVS();
+
+        /**
+         *  Drop the precomputed PVS.
+         */
+        void ClearPVS() { pvs.clear(); }
+
+        /**
+         *  Check whether a PVS has been computed.
+         */
+        bool HasPVS() const { return !pvs.empty(); }
+
+        /**
+         *  Check whether a cell may be visible from another.
+         *
+         *  @param from The cell the viewer is in.
+         *  @param to   The cell to check.
+         *
+         *  @returns @c true if there is no PVS.
+         */
+        bool IsPotentiallyVisible(cell_index from, cell_index to) const { return pvs.empty() || pvs[from].test(to); }
+
+        /** Get the number of cells. */
+        std::size_t GetCellCount() const { return cells.size(); }
+        /** Get a cell. */
+        const cell& GetCell(cell_index index) const { return cells[index]; }
+        /** Get the number of portals. */
+        std::size_t GetPortalCount() const { return portals.size(); }
+        /** Get a portal. */
+        const portal& GetPortal(portal_index index) const { return portals[index]; }
+
+    private:
+        /** The cells walked through so far, to avoid walking in circles. */
+        using cell_path = boost::container::small_vector<cell_index, 16>;
+
+        /**
+         *  Recursively walk through the portals of a cell.
+         *
+         *  @param eye      The position of the viewer.
+         *  @param current  The cell to walk out of.
+         *  @param entry    The portal @p current is seen through, or @ref noPortal.
+         *  @param view     The frustum @p current is seen through.
+         *  @param farPlane The far plane of the original view, or @c nullptr if the view is unbounded.
+         *  @param path     The cells that led to @p current; a portal back into one of them is not followed.
+         *  @param root     The cell the viewer is in, for the PVS check.
+         *  @param[out] result The visible cells.
+         */
+        void TraverseCell(const glm::vec3& eye, cell_index current, portal_index entry, const camera::frustum& view, const glm::vec4* farPlane, cell_path& path, cell_index root, visible_set& result) const;
+
+        std::vector<cell> cells{};                  /**< All cells. */
+        std::vector<portal> portals{};              /**< All portals. */
+        std::vector<boost::dynamic_bitset<>> pvs{}; /**< The potentially visible set per cell, if computed. */
+    };
+
+} }
+
+#endif // SH3_SCENE_PORTAL_HPP_INCLUDED
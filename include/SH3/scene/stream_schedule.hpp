@@ -0,0 +1,168 @@
+/** @file
+ *  Defines @ref sh3::scene::stream_schedule and @ref sh3::scene::upload_budget, the decisions of the
+ *  @ref sh3::scene::streaming_manager that don't touch files or the gpu.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SCENE_STREAM_SCHEDULE_HPP_INCLUDED
+#define SH3_SCENE_STREAM_SCHEDULE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SH3/system/perf_clock.hpp"
+#include "SH3/types/aabb.hpp"
+
+namespace sh3 { namespace scene {
+
+    /**
+     *  Decides which cells of an area are loaded and unloaded as the camera moves, and in which order they are loaded.
+     *
+     *  Cells within the load radius of the camera, or of where it is heading, are loaded; cells beyond the larger
+     *  unload radius are unloaded. In between, cells keep their state.
+     */
+    class stream_schedule final
+    {
+    public:
+        using cell_index = std::uint16_t; /**< Index of a cell. */
+
+        /**
+         *  Where a cell is at.
+         */
+        enum class cell_state
+        {
+            UNLOADED,   /**< Not needed. */
+            LOADING,    /**< Needed, but not all assets are there yet. */
+            RESIDENT,   /**< All assets are there. */
+        };
+
+        /**
+         *  The distances deciding about loading and unloading.
+         */
+        struct settings final
+        {
+            float loadRadius;           /**< Distance at which cells are loaded. */
+            float unloadRadius;         /**< Distance at which cells are unloaded; taken to be at least @ref loadRadius. */
+            unsigned lookaheadFrames;   /**< How many frames ahead the camera movement is extrapolated. */
+        };
+
+        stream_schedule() = default;
+
+        /**
+         *  Switch to another area, with all cells unloaded.
+         *
+         *  @param bounds The space covered by each cell.
+         */
+        void SetArea(const std::vector<aabb> &bounds);
+
+        /**
+         *  Move the camera.
+         *
+         *  @param position The position of the camera.
+         *  @param limits   The distances to use.
+         *  @param loaded   Cleared, then filled with the cells that are @ref cell_state::LOADING now and were unloaded before.
+         *  @param unloaded Cleared, then filled with the cells that are @ref cell_state::UNLOADED now and were not before.
+         */
+        void Update(const glm::vec3 &position, const settings &limits, std::vector<cell_index> &loaded, std::vector<cell_index> &unloaded);
+
+        /**
+         *  Get the cells that are @ref cell_state::LOADING, nearest first, as of the last @ref Update.
+         */
+        const std::vector<cell_index>& GetLoadOrder() const { return order; }
+
+        /**
+         *  Mark a loading cell as having all its assets.
+         *
+         *  @param index The cell.
+         */
+        void SetResident(const cell_index index);
+
+        /**
+         *  Get the state of a cell.
+         *
+         *  @param index The index of the cell, as passed to @ref SetArea.
+         */
+        cell_state GetState(const cell_index index) const { return cells[index].state; }
+
+        /**
+         *  Get the number of cells.
+         */
+        std::size_t GetCellCount() const { return cells.size(); }
+
+        /**
+         *  Check whether a position is in a cell that is not resident.
+         *
+         *  @param position The position.
+         */
+        bool IsStalled(const glm::vec3 &position) const;
+
+    private:
+        /**
+         *  A cell and its state.
+         */
+        struct cell_slot final
+        {
+            aabb bounds;                            /**< The space covered by the cell. */
+            cell_state state;                       /**< Its state. */
+            float distance;                         /**< Distance to the camera (or where it is heading) as of the last @ref Update. */
+        };
+
+    private:
+        std::vector<cell_slot> cells{};             /**< The cells of the area. */
+        std::vector<cell_index> order{};            /**< Loading cells, nearest first; reused every @ref Update. */
+        glm::vec3 lastPosition{0.0f};               /**< The position of the previous @ref Update. */
+        bool hasLastPosition = false;               /**< Whether @ref lastPosition is valid. */
+    };
+
+    /**
+     *  What may be uploaded to the gpu in one frame.
+     *
+     *  The first upload always fits, or one larger than the budget would never be done.
+     */
+    class upload_budget final
+    {
+    public:
+        using clock = sh3::system::perf_clock;
+
+        /**
+         *  Constructor.
+         *
+         *  @param bytes    The data that may be uploaded.
+         *  @param deadline When to stop uploading.
+         */
+        upload_budget(const std::size_t bytes, const clock::time_point deadline): limit(bytes), end(deadline) {}
+
+        /**
+         *  Check whether there is budget left for another upload.
+         */
+        bool IsLeft() const { return left; }
+
+        /**
+         *  Account an upload.
+         *
+         *  @param bytes The data uploaded.
+         *  @param now   The time after uploading it.
+         */
+        void Spend(const std::size_t bytes, const clock::time_point now)
+        {
+            spent += bytes;
+            left = spent < limit && now < end;
+        }
+
+        /**
+         *  Get the data uploaded so far.
+         */
+        std::size_t GetSpent() const { return spent; }
+
+    private:
+        std::size_t limit;                          /**< The data that may be uploaded. */
+        clock::time_point end;                      /**< When to stop uploading. */
+        std::size_t spent = 0;                      /**< The data uploaded so far. */
+        bool left = true;                           /**< Whether another upload fits. */
+    };
+} }
+
+#endif //SH3_SCENE_STREAM_SCHEDULE_HPP_INCLUDED
@@ -0,0 +1,206 @@
+/** @file
+ *  Streaming the cells of an area in and out around the camera.
+ *
+ *  An area is split into @ref sh3::scene::streaming_manager::cell%s, each with the assets it needs. Cells within
+ *  the load radius of the camera (or of where it is heading) are loaded in the background, cells beyond the
+ *  larger unload radius are released again; the gap between the two keeps cells at the border from being
+ *  loaded and unloaded over and over.
+ *
+ *  The cells and their texture names, and other data that lives as long as the area, are put into the arena of
+ *  the manager, which is released at once when switching areas.
+ *
+ *  Files are read and decoded on the job system. Uploads to the gpu happen in @ref sh3::scene::streaming_manager::Update,
+ *  nearest cell first, within a per-frame budget, so that streaming never costs a frame more than the budget.
+ *
+ *  The following config options apply:
+ *
+ *  - @c stream_load_radius: Distance at which cells are loaded.
+ *  - @c stream_unload_radius: Distance at which cells are unloaded; at least @c stream_load_radius.
+ *  - @c stream_lookahead_frames: How many frames ahead the camera movement is extrapolated.
+ *  - @c stream_max_loads: Files read or decoded at the same time, to leave the job system to the frame.
+ *  - @c stream_upload_kib: Pixel data uploaded per frame.
+ *  - @c stream_upload_ms: Time spent uploading per frame.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SCENE_STREAMING_HPP_INCLUDED
+#define SH3_SCENE_STREAMING_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <glm/glm.hpp>
+
+#include "SH3/arc/async_mft.hpp"
+#include "SH3/graphics/async_texture.hpp"
+#include "SH3/graphics/texture.hpp"
+#include "SH3/scene/stream_schedule.hpp"
+#include "SH3/system/arena.hpp"
+#include "SH3/types/aabb.hpp"
+
+namespace sh3 { namespace camera {
+    struct Camera;
+} }
+
+namespace sh3 { namespace scene {
+
+    /**
+     *  Loads and unloads the cells of an area around the camera.
+     *
+     *  All members must be called from the thread owning the GL context.
+     *  Which cells to load is decided by a @ref stream_schedule.
+     */
+    class streaming_manager final
+    {
+    public:
+        using cell_index = stream_schedule::cell_index; /**< Index of a @ref cell. */
+        using cell_state = stream_schedule::cell_state; /**< Where a @ref cell is at. */
+
+        /**
+         *  A piece of an area that is loaded and unloaded as a whole.
+         */
+        struct cell final
+        {
+            aabb bounds;                        /**< The space covered by the cell. */
+            std::vector<std::string> textures;  /**< The texture files the cell needs. */
+        };
+
+        /**
+         *  Numbers to keep an eye on.
+         */
+        struct statistics final
+        {
+            std::size_t residentCells = 0;      /**< Cells that are @ref cell_state::RESIDENT. */
+            std::size_t loadingCells = 0;       /**< Cells that are @ref cell_state::LOADING. */
+            std::size_t textures = 0;           /**< Textures in use by any cell, loaded or not. */
+            std::size_t loads = 0;              /**< Texture files being read or decoded. */
+            std::size_t uploads = 0;            /**< Decoded textures waiting for the upload budget. */
+            std::size_t uploadedBytes = 0;      /**< Pixel data uploaded in the last @ref Update. */
+            std::size_t stallFrames = 0;        /**< Frames the camera was in a cell that was not resident yet. */
+        };
+
+        /**
+         *  Constructor.
+         *
+         *  @param files Where to read files from. Must outlive this.
+         */
+        explicit streaming_manager(sh3::arc::async_mft &files);
+
+        streaming_manager(const streaming_manager&) = delete;
+        streaming_manager& operator=(const streaming_manager&) = delete;
+
+        /**
+         *  Switch to another area, releasing all cells of the previous one.
+         *
+         *  @param cells The cells of the area; copied into the arena.
+         */
+        void SetArea(const std::vector<cell> &cells);
+
+        /**
+         *  Load and unload cells around a position, and upload what has been decoded meanwhile.
+         *
+         *  Call once per frame.
+         *
+         *  @param position The position of the camera.
+         */
+        void Update(const glm::vec3 &position);
+
+        /**
+         *  Load and unload cells around the camera, see @ref Update(const glm::vec3&).
+         *
+         *  @param camera The camera.
+         */
+        void Update(const camera::Camera &camera);
+
+        /**
+         *  Get the state of a cell.
+         *
+         *  @param index The index of the cell, as passed to @ref SetArea.
+         */
+        cell_state GetState(const cell_index index) const { return schedule.GetState(index); }
+
+        /**
+         *  Get a texture of a cell.
+         *
+         *  @param filename The texture file.
+         *
+         *  @returns The texture, or @c nullptr if it is not loaded.
+         */
+        std::shared_ptr<sh3_graphics::sh3_texture> GetTexture(const std::string &filename) const;
+
+        /**
+         *  Get the current @ref statistics.
+         */
+        const statistics& GetStatistics() const { return stats; }
+
+        /**
+         *  Get the memory for things that live as long as the current area.
+         *
+         *  It is reset by @ref SetArea, so nothing allocated from it may be used after switching areas.
+         */
+        sh3::system::arena& GetArena() { return areaMemory; }
+
+    private:
+        /**
+         *  A @ref cell of the current area, kept in @ref areaMemory.
+         */
+        struct area_cell final
+        {
+            aabb bounds;                                                    /**< See @ref cell::bounds. */
+            sh3::system::arena_vector<sh3::system::arena_string> textures;  /**< See @ref cell::textures. */
+        };
+
+        /**
+         *  Hashes texture names without copying them.
+         */
+        struct name_hash final
+        {
+            std::size_t operator()(const boost::string_view name) const { return boost::hash_range(name.begin(), name.end()); }
+        };
+
+        /**
+         *  A texture used by at least one cell.
+         */
+        struct texture_entry final
+        {
+            unsigned users = 0;                                     /**< Number of loading or resident cells using this. */
+            boost::optional<sh3_graphics::image_task> decoded{};    /**< The decoded pixels, once the load has been started. */
+            std::shared_ptr<sh3_graphics::sh3_texture> texture{};   /**< The uploaded texture, once done. */
+        };
+
+        /**
+         *  Start using the textures of a cell.
+         */
+        void Acquire(const area_cell &data);
+
+        /**
+         *  Stop using the textures of a cell.
+         */
+        void Release(const area_cell &data);
+
+        /**
+         *  Start loads and do uploads within the budgets, nearest cell first.
+         */
+        void Load();
+
+    private:
+        sh3::arc::async_mft &files;                                         /**< Where to read from. */
+        sh3::system::arena areaMemory;                                      /**< Memory for the current area. */
+        sh3::system::arena_vector<area_cell> cells;                         /**< The cells of the area, in @ref areaMemory. */
+        stream_schedule schedule;                                           /**< Which of @ref cells to load. */
+        std::vector<cell_index> loaded;                                     /**< Cells to start loading; reused every frame. */
+        std::vector<cell_index> unloaded;                                   /**< Cells to unload; reused every frame. */
+        std::unordered_map<boost::string_view, texture_entry, name_hash> textures; /**< The textures used by loading or resident cells, by a name in @ref cells. */
+        bool stalled = false;                                               /**< Whether the previous @ref Update stalled. */
+        statistics stats;                                                   /**< Updated by @ref Update. */
+    };
+} }
+
+#endif //SH3_SCENE_STREAMING_HPP_INCLUDED
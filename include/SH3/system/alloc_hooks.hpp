@@ -0,0 +1,77 @@
+/** @file
+ *  Counting of heap allocations, to keep the frame loop from allocating.
+ *
+ *  With the CMake option @c TRACK_ALLOCATIONS (on by default in debug builds) the global @c operator @c new is
+ *  replaced by one that counts every allocation, per thread. A @ref sh3::system::frame_allocation_check then reports
+ *  frames that allocate once the game has settled, along with where the allocations came from. Allocations of the
+ *  job system's workers don't count against the frame.
+ *
+ *  Only @c operator @c new is hooked. Allocations through @c malloc, @c calloc and @c realloc, which is what
+ *  SDL, the GL driver and other C libraries use, are not counted, so a passing check says nothing about them.
+ *  Replacing those portably would need a wrapping allocator per platform; use a heap profiler for them instead.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_ALLOC_HOOKS_HPP_INCLUDED
+#define SH3_SYSTEM_ALLOC_HOOKS_HPP_INCLUDED
+
+#include <cstdint>
+
+namespace sh3 { namespace system {
+    /** Whether the allocation functions are hooked in this build. */
+#ifdef SH3_TRACK_ALLOCATIONS
+    constexpr bool allocationHooks = true;
+#else
+    constexpr bool allocationHooks = false;
+#endif
+
+    /**
+     *  Get the number of allocations made through @c operator @c new so far by the calling thread.
+     *
+     *  @returns 0 if @ref allocationHooks is @c false.
+     */
+    std::uint64_t GetAllocationCount();
+
+    /**
+     *  Checks that frames don't allocate once warmed up.
+     *
+     *  Only the allocations of the thread running the frame loop are checked; all members must be called from it.
+     *
+     *  The first frames may allocate as caches fill up; their number is set by the config option
+     *  @c alloc_check_warmup, where 0 disables the check. Every allocation of a later frame is a failure,
+     *  logged with the count and the stacks of the first few allocations (where the platform can capture them).
+     *
+     *  Does nothing if @ref allocationHooks is @c false.
+     */
+    class frame_allocation_check final
+    {
+    public:
+        frame_allocation_check();
+
+        frame_allocation_check(const frame_allocation_check&) = delete;
+        frame_allocation_check& operator=(const frame_allocation_check&) = delete;
+
+        /**
+         *  Check the frame that just ended. Call once at the end of every frame.
+         */
+        void EndFrame();
+
+        /**
+         *  Get the number of frames that allocated after warming up.
+         */
+        unsigned GetFailedFrames() const { return failedFrames; }
+
+        /**
+         *  Whether no frame allocated after warming up.
+         */
+        bool Passed() const { return failedFrames == 0; }
+
+    private:
+        unsigned warmup;                /**< Frames allowed to allocate, 0 if disabled. */
+        unsigned frame = 0;             /**< Frames checked so far. */
+        unsigned failedFrames = 0;      /**< Frames that allocated after warming up. */
+        std::uint64_t lastCount = 0;    /**< @ref GetAllocationCount of the frame thread at the start of the frame. */
+    };
+} }
+
+#endif //SH3_SYSTEM_ALLOC_HOOKS_HPP_INCLUDED
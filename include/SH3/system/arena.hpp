@@ -0,0 +1,181 @@
+/** @file
+ *  Defines the @ref sh3::system::arena and an allocator for standard containers using it.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_ARENA_HPP_INCLUDED
+#define SH3_SYSTEM_ARENA_HPP_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sh3 { namespace system {
+    /**
+     *  A region of memory for things that all die at the same time, e.g. the assets of an area.
+     *
+     *  Allocating bumps a pointer in the current block; freeing single allocations does nothing. Instead,
+     *  @ref Reset releases everything at once, running the destructors of objects created with @ref New.
+     *  This avoids both the fragmentation of many small heap allocations over a long session and walking
+     *  them all on teardown.
+     *
+     *  Allocation is thread-safe, so loaders on the job system can share an arena; @ref Reset is not.
+     */
+    class arena final
+    {
+    public:
+        static constexpr std::size_t defaultBlockSize = 1 << 20; /**< Size of the blocks memory is taken from. */
+
+        /**
+         *  Constructor. Memory is only reserved once needed.
+         *
+         *  @param name      The name to report the arena under. Must outlive this.
+         *  @param blockSize The size of the blocks memory is taken from; larger allocations get a block of their own.
+         */
+        explicit arena(const char *name, std::size_t blockSize = defaultBlockSize);
+        ~arena();
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        /**
+         *  Allocate memory.
+         *
+         *  @param size      The number of bytes.
+         *  @param alignment The alignment; a power of two.
+         *
+         *  @returns The memory, valid until the next @ref Reset.
+         */
+        void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+        /**
+         *  Create an object in the arena. Its destructor runs on @ref Reset.
+         *
+         *  @param args The constructor arguments.
+         *
+         *  @returns The object, valid until the next @ref Reset.
+         */
+        template<typename T, typename... Args>
+        T* New(Args&&... args)
+        {
+            T *object = new(Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if(!std::is_trivially_destructible<T>::value)
+            {
+                AddFinalizer(object, [](void *destroyed) { static_cast<T*>(destroyed)->~T(); });
+            }
+            return object;
+        }
+
+        /**
+         *  Release everything allocated, destroying the objects created with @ref New in reverse order.
+         *
+         *  The first block is kept for reuse. Must not be called while other threads allocate.
+         */
+        void Reset();
+
+        /**
+         *  Get the number of bytes allocated since the last @ref Reset, including alignment padding.
+         */
+        std::size_t GetUsed() const;
+
+        /**
+         *  Get the most bytes that were ever allocated between two @ref Reset%s.
+         */
+        std::size_t GetHighWater() const;
+
+        /**
+         *  Log how much memory the arena uses and has used at most.
+         */
+        void Report() const;
+
+    private:
+        struct block;
+
+        /**
+         *  A destructor to run on @ref Reset.
+         */
+        struct finalizer final
+        {
+            void (*destroy)(void*);     /**< Destroys @ref object. */
+            void *object;               /**< The object. */
+            finalizer *next;            /**< The finalizer added before this one. */
+        };
+
+        /**
+         *  Register a destructor to run on @ref Reset.
+         */
+        void AddFinalizer(void *object, void (*destroy)(void*));
+
+        /**
+         *  Allocate from the current block, assuming @ref mutex is locked.
+         *
+         *  @returns @c nullptr if the current block is too small.
+         */
+        void* AllocateFromBlock(std::size_t size, std::size_t alignment);
+
+    private:
+        const char *name;                               /**< Shown by @ref Report. */
+        std::size_t blockSize;                          /**< Size of new blocks. */
+        mutable std::mutex mutex;                       /**< Guards everything below. */
+        std::vector<std::unique_ptr<block>> blocks;     /**< The blocks; the last one is the current one. */
+        std::size_t offset = 0;                         /**< Position in the current block. */
+        std::size_t used = 0;                           /**< Bytes allocated since the last @ref Reset. */
+        std::size_t highWater = 0;                      /**< The most bytes in use at once. */
+        std::size_t reserved = 0;                       /**< Bytes currently reserved in blocks. */
+        std::size_t reservedHighWater = 0;              /**< The most bytes reserved at once. */
+        std::size_t allocations = 0;                    /**< Allocations since the last @ref Reset. */
+        std::size_t resets = 0;                         /**< Number of @ref Reset%s. */
+        finalizer *finalizers = nullptr;                /**< The most recently added destructor. */
+    };
+
+    /**
+     *  Allocator for standard containers, taking memory from an @ref arena.
+     *
+     *  Deallocation does nothing; the memory is released by @ref arena::Reset, so containers using this must not
+     *  outlive it. A growing container leaves its old buffers behind, so reserve up front where the size is known.
+     */
+    template<typename T>
+    class arena_allocator // not final, the standard containers derive from their allocator
+    {
+    public:
+        using value_type = T;
+
+        /**
+         *  Constructor.
+         *
+         *  @param source The arena to take memory from.
+         */
+        arena_allocator(arena &source) noexcept : memory(&source) {}
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U> &other) noexcept : memory(&other.GetArena()) {}
+
+        T* allocate(const std::size_t count) { return static_cast<T*>(memory->Allocate(count * sizeof(T), alignof(T))); }
+        void deallocate(T*, std::size_t) noexcept {}
+
+        /**
+         *  Get the arena memory is taken from.
+         */
+        arena& GetArena() const noexcept { return *memory; }
+
+    private:
+        arena *memory; /**< The arena memory is taken from. */
+    };
+
+    template<typename T, typename U>
+    bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b) noexcept { return &a.GetArena() == &b.GetArena(); }
+
+    template<typename T, typename U>
+    bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b) noexcept { return !(a == b); }
+
+    template<typename T>
+    using arena_vector = std::vector<T, arena_allocator<T>>;                                /**< A @c std::vector in an @ref arena. */
+    using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>; /**< A @c std::string in an @ref arena. */
+} }
+
+#endif //SH3_SYSTEM_ARENA_HPP_INCLUDED
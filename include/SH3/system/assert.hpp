@@ -23,10 +23,39 @@
 #define IGNORE_WARN_OFF
 #endif
 
-#ifndef DOXYGEN
-#ifdef ASSERT_OFF
-#define ASSERT_MSG_IMPL(cond, msg, ignore) do { if(!(cond)) UNREACHABLE(); } while(false)
+#ifdef __GNUC__
+#define ASSERT_LIKELY(cond) __builtin_expect(static_cast<bool>(cond), true)
+#define ASSERT_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define ASSERT_LIKELY(cond) (cond)
+#define ASSERT_COLD __declspec(noinline)
 #else
+#define ASSERT_LIKELY(cond) (cond)
+#define ASSERT_COLD
+#endif
+
+/** @name Assertion levels
+ *  
+ *  How costly the check of an assertion is. Only assertions up to @c ASSERT_LEVEL are checked, which is set
+ *  through the @c ASSERTION_LEVEL CMake option.
+ *  
+ *  @{
+ */
+#define ASSERT_LEVEL_NONE 0         /**< No assertions; same as defining @c ASSERT_OFF. */
+#define ASSERT_LEVEL_CHEAP 1        /**< A comparison or two guarding memory safety, e.g. a bounds check. Kept in release builds. */
+#define ASSERT_LEVEL_NORMAL 2       /**< Everything else that doesn't run per element of a hot loop. */
+#define ASSERT_LEVEL_EXPENSIVE 3    /**< Checks per element of hot loops, e.g. per pixel when decoding textures. */
+#define ASSERT_LEVEL_PARANOID 4     /**< Checks that change the complexity of the code, e.g. validating a whole structure. */
+/** @} */
+
+#ifdef ASSERT_OFF
+#undef ASSERT_LEVEL
+#define ASSERT_LEVEL ASSERT_LEVEL_NONE
+#elif !defined(ASSERT_LEVEL)
+#define ASSERT_LEVEL ASSERT_LEVEL_NORMAL
+#endif
+
+#ifndef DOXYGEN
 #ifdef __GNUC__
 #define ASSERT_FUNC __PRETTY_FUNCTION__
 #elif defined(_MSC_VER)
@@ -35,7 +64,30 @@
 #define ASSERT_FUNC __func__
 #endif
 
-#define ASSERT_MSG_IMPL(cond, msg, ignore) do { static bool assertIgnore = false; if(!assertIgnore && !(IGNORE_WARN_ON cond IGNORE_WARN_OFF)) { if(ignore) assertIgnore = true; sh3_assert(assertIgnore, msg, __FILE__, __LINE__, ASSERT_FUNC); } } while(false)
+// the condition is the only thing on the fast path; the ignore flag is only looked at once it failed
+#define ASSERT_CHECK_IMPL(cond, msg, ignore) do { if(!ASSERT_LIKELY(IGNORE_WARN_ON cond IGNORE_WARN_OFF)) { static bool assertIgnore = false; if(!assertIgnore) { if(ignore) assertIgnore = true; sh3_assert(assertIgnore, msg, __FILE__, __LINE__, ASSERT_FUNC); } } } while(false)
+// unevaluated, but still compiled so that disabled assertions don't rot
+#define ASSERT_SKIP_IMPL(cond) do { static_cast<void>(sizeof(!(IGNORE_WARN_ON cond IGNORE_WARN_OFF))); } while(false)
+
+#if ASSERT_LEVEL >= ASSERT_LEVEL_CHEAP
+#define ASSERT_CHEAP_IMPL(cond, msg, ignore) ASSERT_CHECK_IMPL(cond, msg, ignore)
+#else
+#define ASSERT_CHEAP_IMPL(cond, msg, ignore) ASSERT_SKIP_IMPL(cond)
+#endif
+#if ASSERT_LEVEL >= ASSERT_LEVEL_NORMAL
+#define ASSERT_NORMAL_IMPL(cond, msg, ignore) ASSERT_CHECK_IMPL(cond, msg, ignore)
+#else
+#define ASSERT_NORMAL_IMPL(cond, msg, ignore) ASSERT_SKIP_IMPL(cond)
+#endif
+#if ASSERT_LEVEL >= ASSERT_LEVEL_EXPENSIVE
+#define ASSERT_EXPENSIVE_IMPL(cond, msg, ignore) ASSERT_CHECK_IMPL(cond, msg, ignore)
+#else
+#define ASSERT_EXPENSIVE_IMPL(cond, msg, ignore) ASSERT_SKIP_IMPL(cond)
+#endif
+#if ASSERT_LEVEL >= ASSERT_LEVEL_PARANOID
+#define ASSERT_PARANOID_IMPL(cond, msg, ignore) ASSERT_CHECK_IMPL(cond, msg, ignore)
+#else
+#define ASSERT_PARANOID_IMPL(cond, msg, ignore) ASSERT_SKIP_IMPL(cond)
 #endif
 #endif
 
@@ -43,9 +95,14 @@
  *  
  *  Check that conditions are held.
  *  
+ *  Each assertion has a level saying how costly its check is: @ref ASSERT and @ref ASSERT_MSG are
+ *  @ref ASSERT_LEVEL_NORMAL, the others are named after their level. Assertions above @c ASSERT_LEVEL are not
+ *  checked; release builds default to @ref ASSERT_LEVEL_CHEAP. Failures are handled out of line, so a check
+ *  costs the condition and one branch the compiler knows not to take.
+ *  
  *  If the condition does not hold, one of these actions will be taken:
- *    * default (nothing is defined): Log message and @c std::abort
- *    * @c ASSERT_OFF is defined: Nothing (default for release builds)
+ *    * default (nothing is defined): Log message and @c std::abort (default for release builds)
+ *    * @c ASSERT_OFF is defined: Nothing; same as an @c ASSERT_LEVEL of @ref ASSERT_LEVEL_NONE
  *    * @c ASSERT_CONTINUE is defined: Log message (and continue)
  *    * @c ASSERT_ASK_MSGBOX is defined: Log message and show a graphical dialog-box asking how to continue
  *    * @c ASSERT_ASK_STDERR is defined: Log message and ask via STDIN how to continue
@@ -69,7 +126,7 @@
  *  @param cond The condition to assert.
  *  @param msg  The message to show when the assertion failed.
  */
-#define ASSERT_MSG(cond, msg) ASSERT_MSG_IMPL(cond, msg, false)
+#define ASSERT_MSG(cond, msg) ASSERT_NORMAL_IMPL(cond, msg, false)
 /** @hideinitializer
  *  Debug-Assertion of a condition once.
  *  
@@ -86,12 +143,65 @@
  *  @param cond The condition to assert.
  *  @param msg  The message to show when the assertion failed.
  */
-#define ASSERT_ONCE_MSG(cond, msg) ASSERT_MSG_IMPL(cond, msg, true)
+#define ASSERT_ONCE_MSG(cond, msg) ASSERT_NORMAL_IMPL(cond, msg, true)
+/** @hideinitializer
+ *  Assertion of a cheap condition, checked in release builds too.
+ *  
+ *  @see @ref ASSERT_LEVEL_CHEAP
+ *  
+ *  @param cond The condition to assert.
+ */
+#define ASSERT_CHEAP(cond) ASSERT_CHEAP_MSG(cond, #cond)
+/** @hideinitializer
+ *  Assertion of a cheap condition with failure-message.
+ *  
+ *  @see @ref ASSERT_CHEAP
+ *  
+ *  @param cond The condition to assert.
+ *  @param msg  The message to show when the assertion failed.
+ */
+#define ASSERT_CHEAP_MSG(cond, msg) ASSERT_CHEAP_IMPL(cond, msg, false)
+/** @hideinitializer
+ *  Assertion of a condition that is costly to check in a hot loop.
+ *  
+ *  @see @ref ASSERT_LEVEL_EXPENSIVE
+ *  
+ *  @param cond The condition to assert.
+ */
+#define ASSERT_EXPENSIVE(cond) ASSERT_EXPENSIVE_MSG(cond, #cond)
+/** @hideinitializer
+ *  Assertion of a condition that is costly to check in a hot loop, with failure-message.
+ *  
+ *  @see @ref ASSERT_EXPENSIVE
+ *  
+ *  @param cond The condition to assert.
+ *  @param msg  The message to show when the assertion failed.
+ */
+#define ASSERT_EXPENSIVE_MSG(cond, msg) ASSERT_EXPENSIVE_IMPL(cond, msg, false)
+/** @hideinitializer
+ *  Assertion of a condition that changes the complexity of the code to check.
+ *  
+ *  @see @ref ASSERT_LEVEL_PARANOID
+ *  
+ *  @param cond The condition to assert.
+ */
+#define ASSERT_PARANOID(cond) ASSERT_PARANOID_MSG(cond, #cond)
+/** @hideinitializer
+ *  Assertion of a condition that changes the complexity of the code to check, with failure-message.
+ *  
+ *  @see @ref ASSERT_PARANOID
+ *  
+ *  @param cond The condition to assert.
+ *  @param msg  The message to show when the assertion failed.
+ */
+#define ASSERT_PARANOID_MSG(cond, msg) ASSERT_PARANOID_IMPL(cond, msg, false)
 /** @} */
 
 /**
  *  The function that is invoked when an assertion failed.
  *  
+ *  Marked cold and kept out of line, so the checks don't grow the code around them.
+ *  
  *  @see @ref ASSERT
  *  @see @ref ASSERT_MSG
  *  @see @ref ASSERT_ONCE
@@ -103,6 +213,6 @@
  *  @param line   Source code line in which the assertion takes place.
  *  @param func   Source code function in which the assertion takes place.
  */
-void sh3_assert(bool &ignore, const char* msg, const char* file, int line, const char* func);
+ASSERT_COLD void sh3_assert(bool &ignore, const char* msg, const char* file, int line, const char* func);
 
 #endif //SH3_SYSTEM_ASSHERT_HPP_INCLUDED
@@ -0,0 +1,211 @@
+/** @file
+ *  Running the engine for a fixed workload and reporting how it performed, e.g. for nightly performance tracking.
+ *
+ *  Enabled with <tt>--benchmark NAME</tt> on the command line; see @ref sh3::system::ParseBenchmarkArguments for
+ *  the other options. The run plays an input recording (see input_record.hpp) instead of reading the devices,
+ *  advances time by a fixed step per frame, stops after a given number of frames and writes a report:
+ *
+ *      {
+ *          "name": "...", "frames": N, "timestep_ms": ...,
+ *          "load_ms": {"total": ..., "<startup step>": ..., ...},
+ *          "frame_ms": {"mean": ..., "p50": ..., "p90": ..., "p95": ..., "p99": ..., "max": ...},
+ *          "memory_peak_bytes": {"<memory tag>": ..., ...},
+ *          "passes": {"<pass>": {"cpu_ms": {percentiles}, "gpu_ms": {percentiles}}, ...},
+ *          "latency_ms": {"<latency stage>": {"count": ..., "mean": ..., "p50": ..., "p95": ..., "p99": ..., "max": ...}, ...}
+ *      }
+ *
+ *  @c gpu_ms is left out if the context has no timer queries. @c latency_ms is measured from the start of the frame
+ *  that received replayed input to its present (see latency.hpp), as replayed events are stamped with the start of
+ *  their frame: it covers the work of the frame and the swap, but not how long real input would wait for the frame.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_BENCHMARK_HPP_INCLUDED
+#define SH3_SYSTEM_BENCHMARK_HPP_INCLUDED
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <SDL_events.h>
+
+#include "SH3/system/input_record.hpp"
+#include "SH3/system/latency.hpp"
+#include "SH3/system/perf_clock.hpp"
+#include "SH3/system/startup.hpp"
+
+namespace sh3 { namespace system {
+    /**
+     *  What to run.
+     */
+    struct benchmark_settings final
+    {
+        std::string name{};                 /**< Name of the workload, reported to tell runs apart; empty if not benchmarking. */
+        std::string replay{};               /**< The input recording to play; empty for no input. */
+        std::uint32_t frames = 1000;        /**< Frames to run. */
+        perf_clock::duration timestep = std::chrono::microseconds(16667); /**< Game time per frame. */
+        bool headless = false;              /**< Whether to hide the window and not wait for vsync. */
+        std::string output = "benchmark.json"; /**< Where to write the report. */
+    };
+
+    /**
+     *  Read the benchmark options from the command line:
+     *
+     *  <tt>--benchmark NAME [--replay FILE] [--frames N] [--timestep MS] [--headless] [--output FILE]</tt>
+     *
+     *  @param argc Number of arguments.
+     *  @param argv Argument vector.
+     *  @param[out] settings The options. @c name stays empty without @c --benchmark.
+     *
+     *  @returns @c false if the arguments are wrong; the reason has been logged.
+     */
+    bool ParseBenchmarkArguments(int argc, char **argv, benchmark_settings &settings);
+
+    /**
+     *  Drives and measures a benchmark run.
+     *
+     *  Per frame, get the events from @ref PollEvent, wrap each render pass in @ref BeginPass and @ref EndPass,
+     *  and call @ref EndFrame after swapping; stop when it returns @c false and call @ref Finish.
+     *
+     *  @note Must be constructed and used on the thread owning the GL context.
+     */
+    class benchmark_run final
+    {
+    public:
+        /**
+         *  Constructor.
+         *
+         *  @param runSettings What to run.
+         *  @param startup     The startup that loaded everything; its step times are reported as load times.
+         */
+        benchmark_run(const benchmark_settings &runSettings, const startup_graph &startup);
+
+        /**
+         *  Destructor. Deletes the timer queries.
+         */
+        ~benchmark_run();
+
+        benchmark_run(const benchmark_run&) = delete;
+        benchmark_run& operator=(const benchmark_run&) = delete;
+
+        /**
+         *  Check whether the input recording could be opened.
+         */
+        bool IsGood() const { return good; }
+
+        /**
+         *  Get the next event of the current frame, replacing @c SDL_PollEvent.
+         *
+         *  Events from the devices are dropped, except @c SDL_QUIT so a run can be aborted.
+         *
+         *  @param[out] event The event.
+         *
+         *  @returns @c false if there are no more events in this frame.
+         */
+        bool PollEvent(SDL_Event &event);
+
+        /**
+         *  Get the game time of the current frame, which advances by @ref benchmark_settings::timestep per frame.
+         *  Use it instead of the clock for anything simulated, so runs are reproducible.
+         */
+        perf_clock::time_point GetTime() const { return gameTime; }
+
+        /**
+         *  Start timing a render pass. Passes can't nest.
+         *
+         *  @param name The name of the pass. Must outlive this.
+         */
+        void BeginPass(const char *name);
+
+        /**
+         *  Stop timing the current render pass.
+         */
+        void EndPass();
+
+        /**
+         *  End the current frame.
+         *
+         *  @returns @c false once all frames have been run.
+         */
+        bool EndFrame();
+
+        /**
+         *  Wait for the outstanding GPU timings and write the report.
+         *
+         *  @param latency The input latency of the run.
+         *
+         *  @returns @c false if the report couldn't be written.
+         */
+        bool Finish(const latency_tracker &latency);
+
+    private:
+        static constexpr std::size_t maxPendingQueries = 64;    /**< Timer queries waiting for results before we wait for the oldest. */
+
+        /**
+         *  The timings of a render pass.
+         */
+        struct pass final
+        {
+            const char *name;               /**< The name. */
+            std::vector<double> cpu{};      /**< Milliseconds between @ref BeginPass and @ref EndPass, per frame. */
+            std::vector<double> gpu{};      /**< Milliseconds the GPU spent on the pass, per frame. */
+        };
+
+        /**
+         *  A timer query whose result hasn't been read yet.
+         */
+        struct pending_query final
+        {
+            GLuint query;       /**< The query. */
+            std::size_t pass;   /**< Index of the @ref pass it measured. */
+        };
+
+        /**
+         *  Read the result of the oldest pending timer query.
+         *
+         *  @param wait Whether to wait for it if it hasn't finished.
+         *
+         *  @returns @c false if it hasn't finished and @p wait is @c false.
+         */
+        bool CollectOldestQuery(bool wait);
+
+        /**
+         *  Read the results of the finished timer queries.
+         *
+         *  @param wait Whether to wait for the ones that haven't finished.
+         */
+        void CollectQueries(bool wait);
+
+        /**
+         *  Write the report.
+         */
+        bool Write(const latency_tracker &latency) const;
+
+    private:
+        const benchmark_settings &settings;                 /**< What to run. */
+        std::vector<startup_graph::step_timing> loadTimes;  /**< The startup steps. */
+        perf_clock::duration loadTime;                      /**< All of startup. */
+        std::unique_ptr<input_replay> replay{};             /**< The input recording, if any. */
+        bool good = true;                                   /**< Whether the input recording could be opened. */
+        bool timerQueries = false;                          /**< Whether the context supports timer queries. */
+
+        std::uint32_t frame = 0;                            /**< The current frame. */
+        perf_clock::time_point gameTime;                    /**< The game time of the current frame. */
+        perf_clock::time_point frameStart;                  /**< When the current frame started. */
+        std::vector<double> frameTimes{};                   /**< Milliseconds of each frame. */
+
+        std::vector<pass> passes{};                         /**< All passes seen, in the order they first ran. */
+        std::size_t currentPass = 0;                        /**< Index of the running pass, if @ref inPass. */
+        bool inPass = false;                                /**< Whether a pass is running. */
+        perf_clock::time_point passStart;                   /**< When the running pass started. */
+        std::array<pending_query, maxPendingQueries> pending{}; /**< Ring buffer of queries waiting for results; fixed, so frames don't allocate. */
+        std::size_t pendingHead = 0;                        /**< Number of queries taken out of @ref pending so far; the oldest is at this modulo its size. */
+        std::size_t pendingTail = 0;                        /**< Number of queries put into @ref pending so far. */
+        std::vector<GLuint> freeQueries{};                  /**< Queries to reuse. */
+    };
+} }
+
+#endif //SH3_SYSTEM_BENCHMARK_HPP_INCLUDED
@@ -1,6 +1,13 @@
 /** @file
  *  SILENT HILL 3: Redux Configuration parser
  *
+ *  Options are bound to plain global variables with @ref sh3::system::config_var:
+ *
+ *      unsigned workerThreads = 4;
+ *      static sh3::system::config_var<unsigned> workerThreadsVar("worker_threads", workerThreads, 1, 64);
+ *
+ *  Hot code just reads @c workerThreads; the name is only looked up when the file is (re)loaded.
+ *
  *  @copyright 2016  Palm Studios
  *
  *  @date 27-12-2016
@@ -10,8 +17,149 @@
 #ifndef SH3_CONFIG_H_INCLUDED
 #define SH3_CONFIG_H_INCLUDED
 
-#include <map>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <type_traits>
+
+namespace sh3 { namespace system {
+    /**
+     *  A variable that is set from the configuration file.
+     *
+     *  Instances register themselves by name on construction. If the configuration was already loaded, the
+     *  variable gets its value right away, otherwise when @ref sh3_config::Load is called.
+     *
+     *  @note Registration and (re)loading are not thread-safe; do both on the main thread. Variables that
+     *        are read on other threads should be read once per frame, since a reload may change them between frames.
+     */
+    class config_var_base
+    {
+    public:
+        config_var_base(const config_var_base&) = delete;
+        config_var_base& operator=(const config_var_base&) = delete;
+
+        /**
+         *  Get the name of the option.
+         */
+        const char* GetName() const { return name; }
+
+        /**
+         *  Parse and assign a new value.
+         *
+         *  @param text The value as written in the configuration file.
+         *
+         *  @returns @c false if @p text is not a valid value; the variable is unchanged then.
+         */
+        virtual bool Set(const std::string &text) = 0;
+
+        /**
+         *  Get the current value, formatted like it would be in the configuration file.
+         */
+        virtual std::string Get() const = 0;
+
+    protected:
+        /**
+         *  Constructor.
+         *
+         *  @param optionName The name of the option in the configuration file. Must outlive this.
+         */
+        explicit config_var_base(const char *optionName);
+        virtual ~config_var_base();
+
+        /**
+         *  Look up the loaded value for this variable and assign it.
+         *
+         *  Must be called by the constructor of the derived class, since @ref Set is virtual.
+         */
+        void Resolve();
+
+    private:
+        const char *name; /**< The name of the option. */
+    };
+
+    /**
+     *  Parse a configuration value.
+     *
+     *  All of the text but surrounding whitespace must be consumed, and the value must fit into the type.
+     *  Booleans accept 0/1, true/false, yes/no and on/off.
+     *
+     *  @param text The text.
+     *  @param[out] value The parsed value.
+     *
+     *  @returns @c false if @p text is not a valid value.
+     */
+    ///@{
+    bool ParseConfigValue(const std::string &text, bool &value);
+    bool ParseConfigValue(const std::string &text, int &value);
+    bool ParseConfigValue(const std::string &text, unsigned &value);
+    bool ParseConfigValue(const std::string &text, long &value);
+    bool ParseConfigValue(const std::string &text, unsigned long &value);
+    bool ParseConfigValue(const std::string &text, long long &value);
+    bool ParseConfigValue(const std::string &text, unsigned long long &value);
+    bool ParseConfigValue(const std::string &text, float &value);
+    bool ParseConfigValue(const std::string &text, double &value);
+    bool ParseConfigValue(const std::string &text, std::string &value);
+    ///@}
+
+    /**
+     *  Binds an option of the configuration file to a variable.
+     *
+     *  @tparam T The type of the variable; one supported by @ref ParseConfigValue.
+     */
+    template<typename T>
+    class config_var final : public config_var_base
+    {
+    private:
+        /** Whether the value can be range checked. */
+        using ranged = std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>;
+
+    public:
+        /**
+         *  Constructor.
+         *
+         *  @param optionName The name of the option in the configuration file. Must outlive this.
+         *  @param variable   The variable to assign. Keeps its value until the option is loaded. Must outlive this.
+         *  @param minimum    The smallest valid value (only for numbers).
+         *  @param maximum    The largest valid value (only for numbers).
+         */
+        config_var(const char *optionName, T &variable, const T minimum = Lowest(ranged{}), const T maximum = Highest(ranged{}))
+            : config_var_base(optionName), target(variable), min(minimum), max(maximum)
+        {
+            Resolve();
+        }
+
+        bool Set(const std::string &text) override
+        {
+            T value{};
+            if(!ParseConfigValue(text, value) || !InRange(value, ranged{}))
+            {
+                return false;
+            }
+            target = value;
+            return true;
+        }
+
+        std::string Get() const override
+        {
+            std::ostringstream text;
+            text << target;
+            return text.str();
+        }
+
+    private:
+        static T Lowest(std::true_type) { return std::numeric_limits<T>::lowest(); }
+        static T Lowest(std::false_type) { return T(); }
+        static T Highest(std::true_type) { return std::numeric_limits<T>::max(); }
+        static T Highest(std::false_type) { return T(); }
+        bool InRange(const T &value, std::true_type) const { return !(value < min) && !(max < value); }
+        bool InRange(const T&, std::false_type) const { return true; }
+
+    private:
+        T &target;  /**< The bound variable. */
+        T min;      /**< The smallest valid value. */
+        T max;      /**< The largest valid value. */
+    };
+} }
 
 /**
  *  Interface for configuration file
@@ -19,23 +167,54 @@
 class sh3_config
 {
 public:
+    static constexpr const char *defaultPath = "sh3r.cfg"; /**< The configuration file used by default. */
+
+    /**
+     *  Constructor.
+     *
+     *  @param configPath The configuration file.
+     */
+    explicit sh3_config(const std::string &configPath = defaultPath) : path(configPath) {}
+    ~sh3_config();
+
+    sh3_config(const sh3_config&) = delete;
+    sh3_config& operator=(const sh3_config&) = delete;
 
     /**
-     *  Load the configuration file
+     *  Load the configuration file and assign all registered @ref sh3::system::config_var%s.
+     *
+     *  Malformed lines and invalid values are logged and skipped.
      *
-     *  @return Number of strings read from the file.
+     *  @return Number of options read from the file, or -1 if it could not be opened.
      */
     int Load();
 
     /**
      *  Retrieve a value from an option string
      *
-     *  @return Value of option
+     *  @return Value of option, -1 if it is not set or not a number.
+     */
+    int GetOptionValue(const std::string& option) const;
+
+    /**
+     *  Start watching the configuration file for changes.
+     *
+     *  @returns @c false if watching is not supported or failed.
+     */
+    bool Watch();
+
+    /**
+     *  Reload the configuration file if it has changed since the last call.
+     *
+     *  Cheap enough to call every frame; does nothing unless @ref Watch succeeded.
+     *
+     *  @returns Whether the file was reloaded.
      */
-    int GetOptionValue(const std::string& option);
+    bool Poll();
 
 private:
-    std::map<std::string, int> values;
+    std::string path;       /**< The configuration file. */
+    int watchFd = -1;       /**< The inotify instance watching @ref path. */
 };
 
 #endif // SH3_CONFIG_H_INCLUDED
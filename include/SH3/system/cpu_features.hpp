@@ -0,0 +1,77 @@
+/** @file
+ *  Detection of the SIMD instruction sets of the CPU, to pick kernels at runtime.
+ *
+ *  The build only targets the baseline of the platform, so code for newer instruction sets is compiled per
+ *  function with @ref SH3_TARGET and only called if @ref sh3::system::GetSimdLevel allows it. This way one binary
+ *  uses AVX2 where available and still runs on older CPUs.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_CPU_FEATURES_HPP_INCLUDED
+#define SH3_SYSTEM_CPU_FEATURES_HPP_INCLUDED
+
+#if defined(DOXYGEN) || (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+/**
+ *  Compile a function for an instruction set the build doesn't target, e.g. <tt>SH3_TARGET("avx2")</tt>.
+ *
+ *  Only defined on x86 compilers that need it for using the intrinsics (MSVC doesn't).
+ */
+#define SH3_TARGET(isa) __attribute__((target(isa)))
+#define SH3_X86
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SH3_TARGET(isa)
+#define SH3_X86
+#endif
+
+namespace sh3 { namespace system {
+    /**
+     *  SIMD instruction sets, each including the ones before.
+     */
+    enum class simd_level
+    {
+        SCALAR,     /**< None; plain C++. */
+        SSE2,       /**< SSE2, the x86-64 baseline. */
+        SSE41,      /**< SSE4.1 */
+        AVX2,       /**< AVX and AVX2 */
+        AVX512,     /**< AVX-512 Foundation */
+    };
+
+    /**
+     *  Get the name of a level, as used by the config option @c cpu_simd.
+     */
+    const char* GetSimdLevelName(simd_level level);
+
+    /**
+     *  Get the best level the CPU and the operating system support.
+     */
+    simd_level DetectSimdLevel();
+
+    /**
+     *  Apply the config option @c cpu_simd, which may ask for a lower level than @ref DetectSimdLevel to test the
+     *  kernels of that level.
+     *
+     *  Config options aren't synchronised, so call this on the main thread once the configuration is loaded,
+     *  before kernels run on other threads.
+     *
+     *  @returns The level now used.
+     */
+    simd_level ResolveSimdLevel();
+
+    /**
+     *  Get the level kernels should use. May be called from any thread.
+     *
+     *  This is @ref DetectSimdLevel, unless lowered by @ref ResolveSimdLevel or @ref SetSimdLevel.
+     */
+    simd_level GetSimdLevel();
+
+    /**
+     *  Override the level kernels use, e.g. to test all of them.
+     *
+     *  @param level The level; lowered to @ref DetectSimdLevel if the CPU doesn't support it.
+     *
+     *  @returns The level now used.
+     */
+    simd_level SetSimdLevel(simd_level level);
+} }
+
+#endif //SH3_SYSTEM_CPU_FEATURES_HPP_INCLUDED
@@ -24,6 +24,7 @@ enum class exit_code : std::uint8_t
 {
     SUCCESS,  /**< everything went fine, apparently */
     DEATH,    /**< exit from @ref die() */
+    BENCHMARK_FAILED, /**< a check of a benchmark run failed, e.g. frames allocated after warming up */
 };
 static_assert(static_cast<int>(exit_code::SUCCESS) == 0, "must remain 0 to indicate success");
 
@@ -15,6 +15,8 @@
 #include "GL/glew.h"
 #include "GL/gl.h"
 
+#include "SH3/system/memory_tags.hpp"
+
 #include <string>
 #include <cstddef>
 
@@ -42,7 +44,7 @@ namespace sh3_gl
          *  as we never actually pass anything to this constructor (as well as never passing a buffer_object to
          *  @ref mutablevao).
          */
-        buffer_object(Target type, const std::string& buffName = ""): buffType(type), name(buffName){Create();}
+        buffer_object(Target type, const std::string& buffName = ""): id(0), buffType(type), size(0), name(buffName){Create();}
 
         /**
          *  Destructor.
@@ -120,6 +122,7 @@ namespace sh3_gl
         Target      buffType; /**< What type of buffer this is */
         GLsizei     size;     /**< The size of this buffer in bytes */
         std::string name;     /**< The name of this buffer */
+        sh3::system::memory_charge charge{sh3::system::memory_tag::GPU_BUFFER}; /**< Accounts for @ref size, until released or destroyed */
     };
 }
 
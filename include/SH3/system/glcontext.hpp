@@ -52,6 +52,15 @@ namespace sh3_gl
         */
         void GetExtensions();
 
+       /**
+        *  Check whether the graphics card supports an extension.
+        *
+        *  @param name - Name of the extension, e.g. @c GL_ARB_direct_state_access.
+        *
+        *  @return Whether it is in the list from @ref GetExtensions.
+        */
+        bool HasExtension(const char* name) const;
+
        /**
         *  Print out information about the current GL Context.
         */
@@ -85,6 +94,14 @@ namespace sh3_gl
         std::unique_ptr<flat_sdl_glcontext, sdl_destroyer> glContext;   /**< A pointer to our actual OpenGL Context */
         std::vector<const char*> extensions;                            /**< List of all extensions supported by this OpenGL Driver */
     };
+
+   /**
+    *  Check whether objects can be created and modified without binding them (GL 4.5 or @c ARB_direct_state_access).
+    *
+    *  Decided when the @ref context is created, @c false before. Wrappers like @ref buffer_object use this to skip
+    *  the binds, which otherwise disturb the bindings of whatever is drawn next.
+    */
+    bool HasDirectStateAccess();
 }
 
 #endif // SH3_GLCONTEXT_HPP_INCLUDED
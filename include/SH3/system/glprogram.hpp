@@ -14,6 +14,7 @@
 #define GLPROGRAM_HPP_INCLUDED
 
 #include "SH3/error.hpp"
+#include "SH3/system/memory_tags.hpp"
 
 #include <GL/glew.h>
 #include <GL/gl.h>
@@ -46,7 +47,20 @@ namespace sh3_gl
         private:
         };
 
+        /**
+         *  The sources of a program, read from disk.
+         *
+         *  Reading needs no GL context, so it can happen on any thread.
+         */
+        struct source final
+        {
+            std::string vertex{};   /**< Source of the vertex shader, empty if it couldn't be read. */
+            std::string fragment{}; /**< Source of the fragment shader, empty if it couldn't be read. */
+            sh3::system::memory_charge charge{sh3::system::memory_tag::SHADER}; /**< Accounts for the sources. */
+        };
+
         program(const std::string& name, load_error& err, const std::vector<std::string>& attribs = {}) : programName(name){Load(name, err, attribs);}
+        program(const std::string& name, const source& src, load_error& err, const std::vector<std::string>& attribs = {}) : programName(name){Load(name, src, err, attribs);}
         ~program(){Unbind(); glDeleteProgram(programID);}
 
         void Load(const std::string& name);
@@ -59,6 +73,25 @@ namespace sh3_gl
          */
         void Load(const std::string& shader, load_error& err, const std::vector<std::string> &attribs = {});
 
+        /**
+         *  Compile and link already read shader sources, binding any attributes in the process.
+         *
+         *  @param shader  Name of the shader, for error messages.
+         *  @param src     The sources from @ref ReadSource.
+         *  @param err     Error set by this operation.
+         *  @param attribs Vector of attributes we bind before we link the program.
+         */
+        void Load(const std::string& shader, const source& src, load_error& err, const std::vector<std::string> &attribs = {});
+
+        /**
+         *  Read the sources of a shader from disk.
+         *
+         *  @param shader Name of the shader we want to load (path is hard-coded to /data/shaders). Assumes *.vert and *.frag have the same name.
+         *
+         *  @returns The sources.
+         */
+        static source ReadSource(const std::string& shader);
+
         /**
          *  Bind this shader program for use.
          */
@@ -89,10 +122,11 @@ namespace sh3_gl
          *  Compile a shader, given it's type.
          *
          *  @param type The type of shader we want to compile (either GL_VERTEX_SHADER or GL_FRAGMENT_SHADER).
+         *  @param text The source of the shader.
          *
          *  @return GLuint ID of this shader program.
          */
-        GLuint Compile(GLenum type);
+        GLuint Compile(GLenum type, const std::string& text);
     };
 }
 
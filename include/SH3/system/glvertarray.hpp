@@ -99,6 +99,27 @@ namespace sh3_gl{
         void Draw();
 
     protected:
+        /**
+         *  Point a vertex attribute at a buffer.
+         *
+         *  @param slot     Slot of the attribute (using location = x).
+         *  @param buffer   The buffer containing the attribute.
+         *  @param type     Data Type of the components.
+         *  @param size     The number of components per attribute.
+         *  @param stride   Byte offset between vertex attributes; 0 if they are tightly packed.
+         *  @param offset   Offset to the first attribute in the buffer.
+         */
+        void SetAttribute(GLuint slot, const buffer_object& buffer, GLenum type, GLint size, GLsizei stride, GLint offset);
+
+        /**
+         *  Get the size of a component type of vertex attributes.
+         *
+         *  @param type One of the @c mutablevao::DataType values.
+         *
+         *  @return The size in bytes.
+         */
+        static GLsizei TypeSize(GLenum type);
+
         GLuint  id;                         /**< Our VAO's identification number. **/
         const buffer_object& vertices;      /**< Vertex Buffer Object */
 
@@ -173,27 +194,13 @@ namespace sh3_gl{
         }
     protected:
         std::array<buffer_object, numbuffers> buffers; /**< Our list of current VBOs. */
-
-    private:
-
-        /**
-         *  Get offset (stride) into a buffer stored in @ref buffers.
-         *
-         *  @param offset Offset to the first element.
-         *
-         *  @return void* Pointer to the first element of stride @p offset.
-         */
-        static constexpr void* buffer_offset(GLint offset){return static_cast<char *>(nullptr) + offset;}
     };
 
     template<std::size_t numbuffers>
     void mutablevao<numbuffers>::SetDataLocation(GLuint slot, DataType type, GLint size, GLsizei stride, GLint offset)
     {
-        Bind();
-        glEnableVertexAttribArray(slot);
-        ASSERT_MSG(slot < numbuffers, "VBO index (slot) out of range");
-        buffers[slot].Bind();
-        glVertexAttribPointer(slot, size, static_cast<GLenum>(type), GL_FALSE, stride, buffer_offset(offset));
+        ASSERT_CHEAP_MSG(slot < numbuffers, "VBO index (slot) out of range");
+        SetAttribute(slot, buffers[slot], static_cast<GLenum>(type), size, stride, offset);
     }
 
     /**
@@ -296,13 +303,13 @@ namespace sh3_gl{
          */
         void SetDataLocation(Slot slot, DataType type, GLint size, GLsizei stride, GLint offset)
         {
-            ASSERT_MSG(slot < Slot::MAX, "VBO index (slot) out of range");
+            ASSERT_CHEAP_MSG(slot < Slot::MAX, "VBO index (slot) out of range");
             vaoparent::SetDataLocation(static_cast<GLuint>(slot), type, size, stride, offset);
         }
 
         buffer_object& operator[](Slot slot)
         {
-            ASSERT_MSG(slot < Slot::MAX, "VBO index (slot) out of range");
+            ASSERT_CHEAP_MSG(slot < Slot::MAX, "VBO index (slot) out of range");
             return vaoparent::operator[](static_cast<GLuint>(slot));
         }
     };
@@ -5,21 +5,22 @@
 #define SH3_SYSTEM_INPUT_HPP_INCLUDED
 
 #include <bitset>
+#include <cassert>
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <ratio>
 #include <string>
+#include <vector>
 
 #include <boost/container/flat_map.hpp>
 #include <boost/operators.hpp>
-#include <boost/range/adaptor/map.hpp>
-#include <boost/range/adaptor/transformed.hpp>
 
 #include <SDL_keyboard.h>
 #include <SDL_mouse.h>
-#include <SDL_timer.h>
-
+#include "assert.hpp"
 #include "input_config.hpp"
+#include "perf_clock.hpp"
 
 struct vector2
 {
@@ -36,13 +37,49 @@ namespace sh3 { namespace system {
     {
     public:
         /**
-         *  The identifier for an action.
+         *  The name of an action.
          *  
          *  An @ref action is usually bound to a key or a button.
+         *  Names are only used to set things up; at runtime actions are referred to by their @ref action_id.
          */
-        // Using a fixed sized structure does not seem worth it.
         typedef std::string action;
 
+        /**
+         *  The interned identifier of an @ref action.
+         *  
+         *  Ids are handed out densely, starting at 0, by @ref Intern.
+         */
+        using action_id = std::uint16_t;
+
+        /**
+         *  The hash of an @ref action name.
+         *  
+         *  @see ActionHash
+         */
+        using action_hash = std::uint32_t;
+
+        static constexpr action_id noAction = std::numeric_limits<action_id>::max(); /**< Returned by @ref Find for unknown actions, and by @ref Intern for colliding ones. */
+
+        /**
+         *  Hash the name of an @ref action (32-bit FNV-1a).
+         *  
+         *  This is @c constexpr, so actions defined in code can be referred to by a compile-time constant,
+         *  e.g. as a @c case label.
+         *  
+         *  @param name The name of the action.
+         *  
+         *  @returns The hash.
+         */
+        static constexpr action_hash ActionHash(const char* name)
+        {
+            action_hash hash = 2166136261u;
+            for(; *name; ++name)
+            {
+                hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+            }
+            return hash;
+        }
+
         /**
          *  The state of an @ref action.
          */
@@ -50,42 +87,8 @@ namespace sh3 { namespace system {
         struct action_state final
         {
         public:
-            /**
-             *  Implements SDL Ticks as std TrivialClock concept
-             */
-            struct sdl_clock final
-            {
-            public:
-                sdl_clock() = delete;
-
-                //the sdl_clock should perhaps be somewhere else
-                using duration = std::chrono::duration<Uint32, std::milli>;
-                using rep =  duration::rep;
-                using period = duration::period;
-                struct time_point : public std::chrono::time_point<sdl_clock>
-                {
-                public:
-                    /**
-                     *  Constructor.
-                     */
-                    time_point() = default;
-
-                    /**
-                     *  Constructor.
-                     *  
-                     *  @param timestamp The SDL timestamp.
-                     */
-                    explicit time_point(const Uint32 timestamp) noexcept : time_point(duration(timestamp)) {}
-
-                    using std::chrono::time_point<sdl_clock>::time_point;
-                };
-
-                static constexpr bool is_steady = true;
-
-                static time_point now() noexcept { return time_point(SDL_GetTicks()); }
-            };
-            using timestamp = sdl_clock::time_point;
-            using time_delta = sdl_clock::duration;
+            using timestamp = perf_clock::time_point;
+            using time_delta = perf_clock::duration;
 
             /**
              *  State of an @ref action.
@@ -243,10 +246,20 @@ namespace sh3 { namespace system {
             void EndUpdate(const timestamp stamp);
             //FIXME: take delta time? feasible?
 
+        private:
+            #ifdef INPUT_PROVIDE_TIMING
+                /**
+                 *  Add the time since the last change to the time spent in the current @ref state.
+                 *  
+                 *  @param stamp The now.
+                 */
+                void AddTime(const timestamp stamp);
+            #endif
+
         private:
             state value;
             #ifdef INPUT_PROVIDE_TIMING
-                timestamp lastTimestamp;
+                timestamp lastTimestamp{}; //epoch until the first sample
                 //we only ever need either the absolute (during update) or relative timing (after update)
                 union
                 {
@@ -259,7 +272,7 @@ namespace sh3 { namespace system {
                         //FIXME: typedef
                         float pressedTimeRatio, releasedTimeRatio;
                     } relative;
-                } timing;
+                } timing{};
             #endif
             #ifdef INPUT_PROVIDE_COUNT
                 //we only ever need either the numChanges (during update) or half of it (after update)
@@ -353,6 +366,35 @@ namespace sh3 { namespace system {
             //static from KeyboardScancode?
             constexpr raw(const SDL_Scancode scancode): rawType(type::KEYBOARD_KEY), keyboardKey(scancode) {}
 
+            /**
+             *  Create a mouse button input.
+             *  
+             *  @param button The SDL button index (@c SDL_BUTTON_LEFT, ...).
+             */
+            static raw FromMouseButton(const std::uint8_t button) { raw input{SDL_SCANCODE_UNKNOWN}; input.rawType = type::MOUSE_BUTTON; input.mouseButton = button; return input; }
+
+            /**
+             *  Check whether this is a keyboard key.
+             */
+            bool IsKeyboardKey() const { return rawType == type::KEYBOARD_KEY; }
+            /**
+             *  Check whether this is a mouse button.
+             */
+            bool IsMouseButton() const { return rawType == type::MOUSE_BUTTON; }
+
+            /**
+             *  Get the scancode of a keyboard key.
+             *  
+             *  @note Only valid if @ref IsKeyboardKey.
+             */
+            SDL_Scancode GetScancode() const { assert(IsKeyboardKey()); return keyboardKey; }
+            /**
+             *  Get the SDL button index of a mouse button.
+             *  
+             *  @note Only valid if @ref IsMouseButton.
+             */
+            std::uint8_t GetMouseButton() const { assert(IsMouseButton()); return mouseButton; }
+
             /**
              *  Equality check.
              *  
@@ -375,7 +417,7 @@ namespace sh3 { namespace system {
             union
             {
                 SDL_Scancode keyboardKey;
-                decltype(SDL_GetMouseState(nullptr, nullptr)) mouseButton;
+                std::uint8_t mouseButton; /**< SDL button index, as in @c SDL_MouseButtonEvent::button */
                 //size_t wheelButton;
                 //int jostickButton;
                 //int gamepadButton;
@@ -386,21 +428,65 @@ namespace sh3 { namespace system {
         using state = action_state::state::simple;
 
     private:
-        typedef boost::container::flat_map<action, action_state> action_state_map;
+        typedef std::vector<action_state> action_state_list;
 
     public:
         /**
          *  Return the current @ref action_state of an @ref action.
          *  
-         *  @param the_action The @ref action to retrieve the @ref action_state for.
+         *  @param id The @ref action_id to retrieve the @ref action_state for.
          */
-        const action_state& operator[](const action &the_action) const;
+        const action_state& operator[](const action_id id) const;
         /**
          *  Return the current @ref action_state of an @ref action.
          *  
-         *  @param the_action The @ref action to retrieve the @ref action_state for.
+         *  @param id The @ref action_id to retrieve the @ref action_state for.
+         */
+        action_state& operator[](const action_id id);
+
+        /**
+         *  Get the id of an @ref action, adding the @ref action if it is not known yet.
+         *  
+         *  Look ids up once and keep them around; they stay valid until @ref Clear.
+         *  
+         *  @param name The name of the @ref action.
+         *  
+         *  @returns The @ref action_id, or @ref noAction (and an error is logged) if the @ref ActionHash of
+         *           @p name is already taken by a different @ref action.
+         */
+        action_id Intern(const action &name);
+
+        /**
+         *  Get the id of a known @ref action.
+         *  
+         *  @param hash The @ref ActionHash of the name of the @ref action.
+         *  
+         *  @returns The @ref action_id, or @ref noAction if there is no such @ref action.
+         */
+        action_id Find(const action_hash hash) const;
+
+        /**
+         *  Get the id of a known @ref action.
+         *  
+         *  @param name The name of the @ref action.
+         *  
+         *  @returns The @ref action_id, or @ref noAction if there is no such @ref action.
+         */
+        action_id Find(const action &name) const { return Find(ActionHash(name.c_str())); }
+
+        /**
+         *  Get the name of an @ref action.
+         *  
+         *  @param id The @ref action_id.
+         */
+        const action& GetName(const action_id id) const { return actionNames[id]; }
+
+        /**
+         *  Get the number of known actions.
+         *  
+         *  Valid @ref action_id%s are [0, @ref GetActionCount).
          */
-        action_state& operator[](const action &the_action);
+        std::size_t GetActionCount() const { return actionStates.size(); }
 
         /**
          *  Returns the mouse movement relative to the last frames position.
@@ -421,17 +507,19 @@ namespace sh3 { namespace system {
         //TODO: absolute positions
 
         /**
-         *  Reserves memory for at least size entries in the internal @ref action_state_map.
+         *  Reserves memory for at least size actions.
          *  
-         *  @param size The number of entries to reserve memory for.
+         *  @param size The number of actions to reserve memory for.
          */
-        void Reserve(const action_state_map::size_type size) { actionStates.reserve(size); }
+        void Reserve(const action_state_list::size_type size) { actionStates.reserve(size); actionNames.reserve(size); actionIds.reserve(size); }
 
         /**
-         *  Resets the @ref actionStates.
-         *  Does not allocated free memory.
+         *  Forgets all actions.
+         *  Does not free allocated memory.
+         *  
+         *  @note This invalidates all @ref action_id%s.
          */
-        void Clear() { actionStates.clear(); }
+        void Clear() { actionStates.clear(); actionNames.clear(); actionIds.clear(); }
 
         /**
          *  Prepare the @ref input_system to receive actions.
@@ -441,24 +529,28 @@ namespace sh3 { namespace system {
          *  @param begin An begin-iterator to something convertible to @ref action.
          *  @param end   An end-iterator to something convertible to @ref action.
          *  
+         *  @returns @c false if an @ref action could not be added, see @ref Intern. The others are added anyway.
          */
         template<typename iterator>
-        void Prepare(const iterator begin, const iterator end)
+        bool Prepare(const iterator begin, const iterator end)
         {
-            auto entryRange = boost::make_iterator_range(begin, end)
-                            | boost::adaptors::transformed([](const action &action){ return std::make_pair(action, action_state()); });
-            actionStates.insert(entryRange.begin(), entryRange.end());
+            bool added = true;
+            for(auto it = begin; it != end; ++it)
+            {
+                added &= Intern(*it) != noAction;
+            }
+            return added;
         }
 
         /**
          *  Signal that an @ref action was toggled.
-         *  Sets the @ref action in the @ref action_state_map to the new @ref action_state::state.
+         *  Sets the @ref action_state of the @ref action to the new @ref action_state::state.
          *  
-         *  @param action    The @ref action to set.
+         *  @param id        The @ref action_id to set.
          *  @param new_state The new @ref action_state::state of the @ref action.
          *  @param stamp     The time the action occurred.
          */
-        void SetAction(const action &action, const state new_state, const timestamp stamp) { (*this)[action].Set(stamp, new_state); }
+        void SetAction(const action_id id, const state new_state, const timestamp stamp) { (*this)[id].Set(stamp, new_state); }
 
         /**
          *  Updates @ref actionStates for the next frame.
@@ -466,24 +558,23 @@ namespace sh3 { namespace system {
          *  
          *  @see EndUpdateActions
          */
-        void StartUpdateActions() { for(auto &state : actionStates | boost::adaptors::map_values) { state.StartUpdate(); } }
+        void StartUpdateActions() { for(auto &state : actionStates) { state.StartUpdate(); } }
         /**
          *  Updates @ref actionStates for the previous frame.
          *  Should be called after translating input to @ref SetAction.
          *  
          *  @see StartUpdateActions
          */
-        void EndUpdateActions(const timestamp stamp) { for(auto &state : actionStates | boost::adaptors::map_values) { state.EndUpdate(stamp); } }
+        void EndUpdateActions(const timestamp stamp) { for(auto &state : actionStates) { state.EndUpdate(stamp); } }
 
         //TODO: more generic. SetAxisDelta(index, delta)
         template<typename vec2>
         void SetMovementDelta(vec2 &&mouseDelta, vec2 &&wheelDelta) { mouseMovementDelta = std::forward<vec2>(mouseDelta); wheelScrollDelta = std::forward<vec2>(wheelDelta); }
 
     private:
-        action_state& GetState(const action &action);
-
-    private:
-        action_state_map actionStates;
+        action_state_list actionStates;                                 /**< The state of each action, indexed by @ref action_id. */
+        std::vector<action> actionNames{};                              /**< The name of each action, indexed by @ref action_id. */
+        boost::container::flat_map<action_hash, action_id> actionIds{}; /**< Maps the @ref ActionHash of a name to its @ref action_id. */
 
         vector2 mouseMovementDelta, wheelScrollDelta;
     };
@@ -515,18 +606,16 @@ namespace sh3 { namespace system {
 
         status[index::JUST_CHANGED] = true;
     }
-    inline auto input_system::operator[](const action &action) const -> const action_state&
+    inline auto input_system::operator[](const action_id id) const -> const action_state&
     {
-        const auto iter = actionStates.find(action);
-        assert(iter != actionStates.cend());
-        return iter->second;
+        ASSERT_CHEAP_MSG(id < actionStates.size(), "Unknown action_id; was Intern refused?");
+        return actionStates[id];
     }
 
-    inline auto input_system::operator[](const action &action) -> action_state&
+    inline auto input_system::operator[](const action_id id) -> action_state&
     {
-        const auto iter = actionStates.find(action);
-        assert(iter != actionStates.cend());
-        return iter->second;
+        ASSERT_CHEAP_MSG(id < actionStates.size(), "Unknown action_id; was Intern refused?");
+        return actionStates[id];
     }
 } }
 
@@ -0,0 +1,122 @@
+/** @file
+ *  Defines the @ref sh3::system::input_bindings.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_INPUT_BINDINGS_HPP_INCLUDED
+#define SH3_SYSTEM_INPUT_BINDINGS_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/range/iterator_range.hpp>
+
+#include <SDL_events.h>
+#include <SDL_scancode.h>
+
+#include "SH3/system/input.hpp"
+
+namespace sh3 { namespace system {
+    /**
+     *  Maps @ref input_system::raw inputs to actions.
+     *
+     *  The bindings are stored as a table indexed directly by scancode (and mouse button), where each entry
+     *  refers to a contiguous run of @ref input_system::action_id%s. Dispatching an event is thus a single array
+     *  lookup, no matter how many bindings there are.
+     */
+    struct input_bindings final
+    {
+    public:
+        using action_id = input_system::action_id;
+        using action_range = boost::iterator_range<const action_id*>;
+
+        static constexpr std::size_t maxMouseButtons = 32; /**< Mouse buttons with an SDL index above this cannot be bound. */
+
+        input_bindings();
+
+        /**
+         *  Bind an input to an action.
+         *
+         *  An input can be bound to several actions and vice versa. Binding the same pair twice has no effect.
+         *
+         *  @param input The input.
+         *  @param id    The action to trigger.
+         *
+         *  @returns @c false if the input cannot be bound, or @p id is @ref input_system::noAction.
+         */
+        bool Bind(const input_system::raw &input, const action_id id);
+
+        /**
+         *  Remove a binding.
+         *
+         *  @param input The input.
+         *  @param id    The action.
+         */
+        void Unbind(const input_system::raw &input, const action_id id);
+
+        /**
+         *  Remove all bindings.
+         */
+        void Clear();
+
+        /**
+         *  Get the actions bound to a key.
+         *
+         *  @param scancode The key.
+         */
+        action_range Lookup(const SDL_Scancode scancode) const { return Actions(KeySlot(scancode)); }
+
+        /**
+         *  Get the actions bound to a mouse button.
+         *
+         *  @param button The SDL button index (@c SDL_BUTTON_LEFT, ...).
+         */
+        action_range LookupMouseButton(const std::uint8_t button) const { return Actions(MouseButtonSlot(button)); }
+
+        /**
+         *  Translate an SDL event into actions.
+         *
+         *  Key and mouse button events set all bound actions on @p input. Key repeats are ignored.
+         *
+         *  @param event The event.
+         *  @param input The @ref input_system to update.
+         *  @param stamp The time the event was received, e.g. from the @ref input_sampler.
+         *
+         *  @returns @c true if the event was a key or button event, whether it was bound or not.
+         */
+        bool Dispatch(const SDL_Event &event, input_system &input, const input_system::timestamp stamp) const;
+
+    private:
+        using slot = std::uint16_t;
+
+        static constexpr std::size_t keySlots = SDL_NUM_SCANCODES;              /**< Number of slots used by keys. */
+        static constexpr std::size_t slotCount = keySlots + maxMouseButtons;    /**< Total number of slots. */
+        static constexpr slot noSlot = slotCount;                               /**< Returned for unbindable input. */
+
+        static slot KeySlot(const SDL_Scancode scancode) { return static_cast<std::size_t>(scancode) < keySlots ? static_cast<slot>(scancode) : noSlot; }
+        static slot MouseButtonSlot(const std::uint8_t button) { return button < maxMouseButtons ? static_cast<slot>(keySlots + button) : noSlot; }
+        static slot SlotOf(const input_system::raw &input);
+
+        action_range Actions(const slot index) const
+        {
+            // offsets has one extra entry at noSlot, so an unbindable input just yields an empty range
+            const action_id *base = actions.data();
+            return action_range(base + offsets[index], base + offsets[index + (index != noSlot ? 1u : 0u)]);
+        }
+
+        /**
+         *  Rebuild @ref offsets and @ref actions from @ref bindings.
+         */
+        void Rebuild();
+
+    private:
+        std::vector<std::pair<slot, action_id>> bindings;   /**< All bindings, sorted. */
+        std::array<std::uint16_t, slotCount + 1> offsets;   /**< Start of the actions of each slot in @ref actions; the next entry is the end. */
+        std::vector<action_id> actions;                     /**< The bound actions, grouped by slot. */
+    };
+} }
+
+#endif //SH3_SYSTEM_INPUT_BINDINGS_HPP_INCLUDED
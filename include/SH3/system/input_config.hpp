@@ -9,13 +9,13 @@
  *  
  *  With this enabled, the @ref sh3::system::input_system keeps track what fraction of a frame the actions were active for.
  *  
- * @note Doesn't work right with SDL timestamps.
- *       I think the event times are not when the input *happened*, but when the event-loop *received* them, which is not useful to us.
+ * @note The SDL event timestamps only have millisecond resolution and are taken when the event-loop *receives* the events.
+ *       Use the @ref sh3::system::perf_clock stamps of the @ref sh3::system::input_sampler instead, which are as exact as its polling rate.
  */
 #ifdef DOXYGEN
-#define INPUT_PROVIDE_TIMING 0
+#define INPUT_PROVIDE_TIMING 1
 #else
-#undef INPUT_PROVIDE_TIMING
+#define INPUT_PROVIDE_TIMING
 #endif
 /**
  *  Whether the @ref sh3::system::input_system should provide counting support for inputs.
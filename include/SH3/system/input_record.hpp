@@ -0,0 +1,158 @@
+/** @file
+ *  Recording and replaying of input events.
+ *
+ *  A recording is a sequence of SDL events tagged with the frame they were received in, so that a
+ *  session can be replayed frame by frame, without a window and independent of wall-clock time.
+ *  Together with a fixed start position this makes runs reproducible, e.g. for comparing the performance of two builds.
+ *
+ *  File layout (native byte order, recordings are not meant to be moved between platforms):
+ *
+ *      header:  char magic[4] = "SH3I", u16 version, u16 eventSize (= sizeof(SDL_Event) of the recording build)
+ *      records: u32 frame, i64 stamp, u8 length, u8 data[length]
+ *
+ *  @c stamp is the @ref sh3::system::perf_clock time the event was received, in nanoseconds.
+ *  @c data is the first @c length bytes of the @c SDL_Event, which is enough for the event types we know of.
+ *  The end of each frame is marked by a record with event type @c SDL_FIRSTEVENT, whose stamp is the
+ *  time the frame ended.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_INPUT_RECORD_HPP_INCLUDED
+#define SH3_SYSTEM_INPUT_RECORD_HPP_INCLUDED
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <SDL_events.h>
+
+#include "SH3/error.hpp"
+#include "SH3/system/input.hpp"
+
+namespace sh3 { namespace system {
+    /**
+     *  Writes input events to a file.
+     *
+     *  Call @ref Record for every event received, and @ref EndFrame once per frame.
+     */
+    struct input_recorder final
+    {
+    public:
+        /**
+         *  Constructor.
+         *
+         *  @param path Path of the file to write. An existing file is overwritten.
+         */
+        explicit input_recorder(const std::string &path);
+
+        /**
+         *  Check whether the file could be opened, and all writes succeeded so far.
+         */
+        bool IsGood() const { return static_cast<bool>(file); }
+
+        /**
+         *  Record an event in the current frame.
+         *
+         *  @param event The event.
+         *  @param stamp The time the event was received.
+         */
+        void Record(const SDL_Event &event, const input_system::timestamp stamp);
+
+        /**
+         *  End the current frame.
+         *
+         *  @param stamp The time the frame ended; replayed as the time of @ref input_system::EndUpdateActions.
+         */
+        void EndFrame(const input_system::timestamp stamp);
+
+        /**
+         *  Get the number of the current frame.
+         */
+        std::uint32_t GetFrame() const { return frame; }
+
+    private:
+        /**
+         *  Write a record.
+         */
+        void Write(const SDL_Event &event, const input_system::timestamp stamp);
+
+    private:
+        std::ofstream file;         /**< The recording. */
+        std::uint32_t frame = 0;    /**< The current frame. */
+    };
+
+    /**
+     *  Plays back a recording made by an @ref input_recorder.
+     *
+     *  Replaces the @c SDL_PollEvent loop: @ref PollEvent returns the events of the current frame, then @c false.
+     *  @ref EndFrame advances to the next frame.
+     */
+    struct input_replay final
+    {
+    public:
+        enum class load_result
+        {
+            SUCCESS,
+            FILE_NOT_FOUND,
+            BAD_HEADER,
+            TRUNCATED,
+        };
+
+        struct load_error final : public error<load_result>
+        {
+        public:
+            std::string message() const;
+        };
+
+        /**
+         *  Constructor.
+         *
+         *  @param path Path of the recording.
+         *  @param[out] err The @ref load_error of opening the file. Reading a truncated record later is logged.
+         */
+        input_replay(const std::string &path, load_error &err);
+
+        /**
+         *  Get the next event of the current frame.
+         *
+         *  @param[out] event The event.
+         *  @param[out] stamp The time the event was received when it was recorded.
+         *
+         *  @returns @c false if there are no more events in this frame.
+         */
+        bool PollEvent(SDL_Event &event, input_system::timestamp &stamp);
+
+        /**
+         *  Skip the remaining events of the current frame and advance to the next frame.
+         *
+         *  @returns The time the frame ended when it was recorded.
+         */
+        input_system::timestamp EndFrame();
+
+        /**
+         *  Check whether all recorded frames have been played.
+         */
+        bool IsFinished() const { return finished; }
+
+        /**
+         *  Get the number of the current frame.
+         */
+        std::uint32_t GetFrame() const { return frame; }
+
+    private:
+        /**
+         *  Read the next record into @ref next.
+         */
+        void ReadNext();
+
+    private:
+        std::ifstream file;             /**< The recording. */
+        std::uint32_t frame = 0;        /**< The current frame. */
+        std::uint32_t nextFrame = 0;    /**< The frame of @ref next. */
+        SDL_Event next;                 /**< The next record, already read. */
+        input_system::timestamp nextStamp;  /**< The stamp of @ref next. */
+        bool finished = false;          /**< Whether the end of the recording has been reached. */
+    };
+} }
+
+#endif //SH3_SYSTEM_INPUT_RECORD_HPP_INCLUDED
@@ -0,0 +1,81 @@
+/** @file
+ *  Defines the @ref sh3::system::input_sampler.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_INPUT_SAMPLER_HPP_INCLUDED
+#define SH3_SYSTEM_INPUT_SAMPLER_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include <SDL_events.h>
+
+#include "SH3/system/input.hpp"
+#include "SH3/system/perf_clock.hpp"
+#include "SH3/system/spsc_queue.hpp"
+
+namespace sh3 { namespace system {
+    /**
+     *  Takes events from SDL as soon as they arrive, stamps them with the @ref perf_clock and hands them to the game.
+     *
+     *  SDL only allows pumping events on the thread that created the window, so the producer side (@ref Pump,
+     *  @ref PumpUntil) must run there. The game consumes the samples with @ref Poll, which may happen on any
+     *  one other thread; the two sides are connected by a lock-free @ref spsc_queue.
+     *
+     *  The more often @ref Pump is called, the closer the stamps are to when the input actually happened.
+     *  Calling @ref PumpUntil instead of sleeping while waiting for the next frame keeps the sampling rate high,
+     *  which is what makes the sub-frame timing of @ref INPUT_PROVIDE_TIMING useful.
+     */
+    struct input_sampler final
+    {
+    public:
+        /**
+         *  A received event.
+         */
+        struct sample final
+        {
+            SDL_Event event{};                  /**< The event. */
+            input_system::timestamp stamp{};    /**< When the event was taken from SDL. */
+        };
+
+        static constexpr std::size_t queueSize = 1024; /**< Samples that can be in flight at once. */
+
+        /**
+         *  Take all pending events from SDL and queue them (producer only).
+         *
+         *  If the queue is full the remaining events are left to SDL, to be taken by a later call.
+         *
+         *  @returns The number of events queued.
+         */
+        std::size_t Pump();
+
+        /**
+         *  Repeatedly @ref Pump until @p deadline (producer only).
+         *
+         *  @param deadline When to return.
+         *  @param interval How long to sleep between pumps.
+         */
+        void PumpUntil(const input_system::timestamp deadline, const perf_clock::duration interval = std::chrono::milliseconds(1));
+
+        /**
+         *  Get the oldest queued sample (consumer only).
+         *
+         *  @param[out] out The sample.
+         *
+         *  @returns @c false if no samples are queued.
+         */
+        bool Poll(sample &out) { return samples.Pop(out); }
+
+        /**
+         *  Get how often the queue ran full, leaving events to SDL. Non-zero means the game consumes too slowly.
+         */
+        std::uint64_t GetDeferredCount() const { return deferred; }
+
+    private:
+        spsc_queue<sample, queueSize> samples{};    /**< Samples not yet seen by the game. */
+        std::uint64_t deferred = 0;                 /**< See @ref GetDeferredCount; producer side only. */
+    };
+} }
+
+#endif //SH3_SYSTEM_INPUT_SAMPLER_HPP_INCLUDED
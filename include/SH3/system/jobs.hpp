@@ -0,0 +1,223 @@
+/** @file
+ *  Defines the @ref sh3::system::job_system.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_JOBS_HPP_INCLUDED
+#define SH3_SYSTEM_JOBS_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SH3/system/work_stealing_deque.hpp"
+
+namespace sh3 { namespace system {
+    class job_system;
+
+    /**
+     *  Counts unfinished jobs.
+     *
+     *  Pass it to @ref job_system::Run to count a job, then @ref job_system::Wait for it or run other jobs after it.
+     *  A counter may be reused once it is done.
+     */
+    class job_counter final
+    {
+    public:
+        job_counter() = default;
+        job_counter(const job_counter&) = delete;
+        job_counter& operator=(const job_counter&) = delete;
+
+        /**
+         *  Check whether all counted jobs have finished.
+         *
+         *  Once this returned @c true, the counter may be destroyed or reused.
+         */
+        bool IsDone() const
+        {
+            if(pending.load(std::memory_order_acquire) != 0)
+            {
+                return false;
+            }
+            // the last job may still hold the lock after decrementing
+            std::lock_guard<std::mutex> lock(mutex);
+            return true;
+        }
+
+    private:
+        friend class job_system;
+
+        struct job;
+
+        std::atomic<std::size_t> pending{0};    /**< Number of unfinished jobs. */
+        mutable std::mutex mutex{};             /**< Guards @ref waiting and the last decrement of @ref pending. */
+        std::vector<job*> waiting{};            /**< Jobs to run once @ref pending drops to zero. */
+    };
+
+    /**
+     *  The engine-wide pool of worker threads.
+     *
+     *  There is one worker per core; the thread constructing the job_system is worker 0 and runs jobs when it
+     *  @ref Wait%s, the others are dedicated threads, pinned to a core each where supported. Each worker has a
+     *  @ref work_stealing_deque of jobs: jobs run from a worker go to its own deque, idle workers steal from the others.
+     *  Jobs run from threads outside the pool go through a shared queue.
+     *
+     *  The number of workers defaults to the config option @c job_threads (0, the default, means one per core);
+     *  pinning can be disabled with @c job_pin_threads.
+     *
+     *  @note All counted jobs must be waited for before the job_system is destroyed.
+     */
+    class job_system final
+    {
+    public:
+        using job_function = std::function<void()>;
+
+        static constexpr std::size_t dequeCapacity = 4096;   /**< Jobs queued per worker before further ones run inline. */
+        static constexpr std::size_t chunksPerWorker = 4;    /**< @ref ParallelFor aims for this many chunks per worker, to even out load. */
+
+        /**
+         *  Constructor. Starts the workers.
+         *
+         *  @param threadCount The number of workers including the calling thread, 0 for the configured value.
+         */
+        explicit job_system(const unsigned threadCount = 0);
+        ~job_system();
+
+        job_system(const job_system&) = delete;
+        job_system& operator=(const job_system&) = delete;
+
+        /**
+         *  Get the number of workers, including the thread that constructed the job_system.
+         */
+        unsigned GetWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+        /**
+         *  Schedule a job.
+         *
+         *  @param function The work to do.
+         *  @param counter  Incremented now and decremented when the job has finished, if not @c nullptr.
+         *  @param after    The job is only started once this counter is done, if not @c nullptr.
+         */
+        void Run(job_function function, job_counter *counter = nullptr, job_counter *after = nullptr);
+
+        /**
+         *  Run jobs until @p counter is done.
+         *
+         *  The calling thread helps out instead of sleeping, so waiting on the main thread does not stall it.
+         *
+         *  @param counter The counter.
+         */
+        void Wait(const job_counter &counter);
+
+        /**
+         *  Run one pending job, if there is any.
+         *
+         *  Lets a thread that has to wait for something else, e.g. vsync, do useful work meanwhile.
+         *
+         *  @returns Whether a job was run.
+         */
+        bool RunPending();
+
+        /**
+         *  Call @p body for chunks of the range [0, @p count) in parallel, and wait for all of them.
+         *
+         *  The range is split into about @ref chunksPerWorker chunks per worker, but no smaller than @p minChunk.
+         *
+         *  @param count    The size of the range.
+         *  @param body     Called as @c body(first, last) for each chunk [first, last).
+         *  @param minChunk The smallest chunk worth a job of its own.
+         */
+        template<typename function>
+        void ParallelFor(const std::size_t count, function &&body, const std::size_t minChunk = 1)
+        {
+            if(count == 0)
+            {
+                return;
+            }
+
+            const std::size_t chunks = GetWorkerCount() * chunksPerWorker;
+            const std::size_t chunk = std::max(std::max<std::size_t>(minChunk, 1), (count + chunks - 1) / chunks);
+            if(chunk >= count)
+            {
+                body(std::size_t{0}, count);
+                return;
+            }
+
+            job_counter counter;
+            for(std::size_t first = 0; first < count; first += chunk)
+            {
+                const std::size_t last = std::min(count, first + chunk);
+                Run([&body, first, last]() { body(first, last); }, &counter);
+            }
+            Wait(counter);
+        }
+
+    private:
+        using job = job_counter::job;
+        struct worker;
+
+        /**
+         *  Queue a job that may start right away.
+         */
+        void Submit(job *work);
+
+        /**
+         *  Take a job from the own deque, the shared queue or another worker.
+         *
+         *  @param self The calling worker, @c nullptr for threads outside the pool.
+         */
+        job* FindJob(worker *self);
+
+        /**
+         *  Run a job, finish its counter and release it.
+         */
+        void Execute(job *work);
+
+        /**
+         *  The main loop of the dedicated workers.
+         */
+        void WorkerLoop(worker &self);
+
+        /**
+         *  Get the calling thread's worker of this job_system, or @c nullptr.
+         */
+        worker* CurrentWorker() const;
+
+        /**
+         *  Get a job to fill, reusing one released to the calling worker if there is any.
+         *
+         *  Threads outside the pool always allocate a new one.
+         */
+        job* AllocateJob();
+
+        /**
+         *  Give a job that ran back to the worker that allocated it, or delete it if a thread outside the pool did.
+         *
+         *  Jobs go back to where they came from, so a worker that mostly runs what others submit doesn't pile up
+         *  released jobs, and one whose jobs are mostly stolen doesn't have to allocate new ones.
+         */
+        void ReleaseJob(job *work);
+
+    private:
+        std::vector<std::unique_ptr<worker>> workers{}; /**< All workers; the first is the constructing thread. */
+
+        std::mutex injectedMutex{};                     /**< Guards @ref injected. */
+        std::deque<job*> injected{};                    /**< Jobs run from threads outside the pool. */
+        std::atomic<std::size_t> injectedCount{0};      /**< Size of @ref injected, to skip locking when it's empty. */
+
+        std::atomic<std::size_t> queued{0};             /**< Jobs that can start but have not been taken yet. */
+        std::atomic<unsigned> sleeping{0};              /**< Workers waiting on @ref wake. */
+        std::mutex sleepMutex{};                        /**< Guards sleeping on @ref wake. */
+        std::condition_variable wake{};                 /**< Wakes idle workers when there is work or on shutdown. */
+        std::atomic<bool> stop{false};                  /**< Set on destruction. */
+    };
+} }
+
+#endif //SH3_SYSTEM_JOBS_HPP_INCLUDED
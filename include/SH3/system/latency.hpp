@@ -0,0 +1,155 @@
+/** @file
+ *  Defines the @ref sh3::system::latency_tracker.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_LATENCY_HPP_INCLUDED
+#define SH3_SYSTEM_LATENCY_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "SH3/system/input.hpp"
+#include "SH3/system/perf_clock.hpp"
+
+namespace sh3 { namespace system {
+    /**
+     *  Measures the latency from input to the frame showing its effect ("input-to-photon").
+     *
+     *  Every frame that applied input is tagged with the @ref perf_clock stamp of its oldest input event. That has to
+     *  be when the event was queued, not when the game got to it, or the time it waited for the once-per-frame poll
+     *  is missed: use @ref perf_clock::FromTicks on the @c timestamp of the @c SDL_Event, or the stamp of an
+     *  @ref input_sampler that is pumped while waiting for the next frame. The tag is carried along while the frame is submitted, swapped and
+     *  finally completed by the GPU, and the time from the tag to each of these @ref stage%s is recorded.
+     *
+     *  Per frame, call @ref Input for each applied event, then @ref Submit after issuing the draw calls,
+     *  @ref Swap after @c SDL_GL_SwapWindow and @ref Poll once the next frame begins.
+     *
+     *  GPU completion is measured with fences if the context supports them (GL 3.2 or @c ARB_sync), otherwise
+     *  the @ref stage::GPU samples stay empty. The fences are only checked in @ref Poll, so those samples are
+     *  an upper bound, off by at most the time between two calls.
+     *
+     *  @note Must be constructed and used on the thread owning the GL context.
+     */
+    struct latency_tracker final
+    {
+    public:
+        using timestamp = input_system::timestamp;
+        using duration = perf_clock::duration;
+
+        /**
+         *  Point in the life of a frame up to which latency is measured.
+         */
+        enum stage : std::size_t
+        {
+            SUBMIT,         /**< All draw calls issued. */
+            SWAP,           /**< @c SDL_GL_SwapWindow returned. */
+            GPU,            /**< The GPU finished rendering the frame. */
+            STAGE_COUNT,
+        };
+
+        /**
+         *  Summary of the recorded latencies of a @ref stage.
+         */
+        struct distribution final
+        {
+            std::size_t count = 0;                  /**< Number of samples; the other fields are zero if this is. */
+            duration min = duration::zero();
+            duration mean = duration::zero();
+            duration median = duration::zero();
+            duration p95 = duration::zero();        /**< 95th percentile. */
+            duration p99 = duration::zero();        /**< 99th percentile. */
+            duration max = duration::zero();
+        };
+
+        static constexpr std::size_t defaultHistory = 1024;    /**< Default number of frames kept per @ref stage. */
+        static constexpr std::size_t maxPendingFrames = 8;     /**< Frames waiting for the GPU before we stop waiting for the oldest. */
+
+        /**
+         *  Constructor.
+         *
+         *  @param historySize Number of most recent samples kept per @ref stage.
+         */
+        explicit latency_tracker(const std::size_t historySize = defaultHistory);
+        ~latency_tracker();
+
+        latency_tracker(const latency_tracker&) = delete;
+        latency_tracker& operator=(const latency_tracker&) = delete;
+
+        /**
+         *  Tag the current frame with an input event.
+         *
+         *  @param stamp The time the event was received.
+         */
+        void Input(const timestamp stamp);
+
+        /**
+         *  Signal that the draw calls of the current frame have been issued.
+         */
+        void Submit();
+
+        /**
+         *  Signal that the current frame has been swapped, and begin the next.
+         */
+        void Swap();
+
+        /**
+         *  Check whether the GPU has finished earlier frames.
+         */
+        void Poll();
+
+        /**
+         *  Get the name of a @ref stage, as used in reports.
+         */
+        static const char* GetStageName(const stage which);
+
+        /**
+         *  Get the distribution of the recorded latencies of a @ref stage.
+         *
+         *  @param which The @ref stage.
+         */
+        distribution GetDistribution(const stage which) const;
+
+        /**
+         *  Log the distributions of all stages.
+         */
+        void Report() const;
+
+        /**
+         *  Forget all samples.
+         */
+        void Reset();
+
+    private:
+        /**
+         *  A swapped frame waiting for the GPU.
+         */
+        struct pending_frame final
+        {
+            timestamp input{};          /**< The tag. */
+            GLsync fence = nullptr;     /**< Signalled when the GPU finished the frame. */
+        };
+
+        /**
+         *  Add a sample to a @ref stage.
+         */
+        void Record(const stage which, const timestamp input, const timestamp now);
+
+    private:
+        std::size_t history;                                    /**< Maximum samples per stage. */
+        std::array<std::vector<duration>, STAGE_COUNT> samples; /**< Ring buffer of samples per stage. */
+        std::array<std::size_t, STAGE_COUNT> next;              /**< Where the next sample of each stage goes. */
+        std::array<pending_frame, maxPendingFrames> pending;    /**< Ring buffer of swapped frames; fixed, so frames don't allocate. */
+        std::size_t pendingFirst = 0;                           /**< Index of the oldest entry in @ref pending. */
+        std::size_t pendingCount = 0;                           /**< Number of entries in @ref pending. */
+        bool useFences;                                         /**< Whether the context supports fences. */
+        bool tagged = false;                                    /**< Whether the current frame received input. */
+        timestamp tag;                                          /**< Oldest input of the current frame. */
+        GLsync submitFence = nullptr;                           /**< Fence of the current frame, if submitted. */
+    };
+} }
+
+#endif //SH3_SYSTEM_LATENCY_HPP_INCLUDED
@@ -0,0 +1,155 @@
+/** @file
+ *  Defines the @ref sh3::system::linear_allocator for short-lived temporaries.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_LINEAR_ALLOCATOR_HPP_INCLUDED
+#define SH3_SYSTEM_LINEAR_ALLOCATOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sh3 { namespace system {
+    /**
+     *  A stack of memory for temporaries, one per thread.
+     *
+     *  Allocating bumps an offset, without locking; nothing is freed individually. Instead, everything allocated
+     *  after a @ref marker is released at once with @ref Rewind, usually through a @ref transient_scope. Each
+     *  job runs in a scope of its own, and the main thread calls @ref Reset once per frame.
+     *
+     *  The size of each thread's buffer is set by the config option @c transient_kib. Should it run out,
+     *  allocations fall back to the heap until the next rewind, and a warning is logged once.
+     */
+    class linear_allocator final
+    {
+    public:
+        /**
+         *  A position to @ref Rewind to.
+         */
+        struct marker final
+        {
+            std::size_t offset;     /**< Bytes in use. */
+            std::size_t overflows;  /**< Heap allocations in use. */
+        };
+
+        /**
+         *  Constructor. The buffer is only allocated once needed.
+         *
+         *  @param capacity The size of the buffer in bytes.
+         */
+        explicit linear_allocator(std::size_t capacity);
+
+        linear_allocator(const linear_allocator&) = delete;
+        linear_allocator& operator=(const linear_allocator&) = delete;
+
+        /**
+         *  Allocate memory.
+         *
+         *  @param size      The number of bytes.
+         *  @param alignment The alignment; a power of two.
+         *
+         *  @returns The memory, valid until rewound past.
+         */
+        void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+        /**
+         *  Give back memory early, which only works for the latest allocation; others wait for the rewind.
+         *
+         *  @param memory The memory from @ref Allocate.
+         *  @param size   The size it was allocated with.
+         */
+        void Deallocate(void *memory, std::size_t size);
+
+        /**
+         *  Get the current position, to @ref Rewind to later.
+         */
+        marker GetMarker() const { return marker{offset, overflow.size()}; }
+
+        /**
+         *  Release everything allocated since @p position was taken.
+         *
+         *  @param position The position from @ref GetMarker.
+         */
+        void Rewind(const marker position);
+
+        /**
+         *  Release everything.
+         */
+        void Reset() { Rewind(marker{0, 0}); }
+
+        /**
+         *  Get the most bytes that were in use at once, not counting heap fallbacks.
+         */
+        std::size_t GetHighWater() const { return highWater; }
+
+        /**
+         *  Get the allocator of the calling thread.
+         */
+        static linear_allocator& ForThread();
+
+    private:
+        std::size_t capacity;                               /**< Size of @ref buffer. */
+        std::unique_ptr<char[]> buffer;                     /**< The memory. */
+        std::size_t offset = 0;                             /**< Bytes of @ref buffer in use. */
+        std::size_t highWater = 0;                          /**< The most bytes of @ref buffer in use at once. */
+        std::vector<std::unique_ptr<char[]>> overflow;      /**< Heap allocations made when @ref buffer was full. */
+        bool warned = false;                                /**< Whether running out has been logged. */
+    };
+
+    /**
+     *  Rewinds the thread's @ref linear_allocator on leaving the scope.
+     */
+    class transient_scope final
+    {
+    public:
+        transient_scope() : allocator(linear_allocator::ForThread()), position(allocator.GetMarker()) {}
+        ~transient_scope() { allocator.Rewind(position); }
+
+        transient_scope(const transient_scope&) = delete;
+        transient_scope& operator=(const transient_scope&) = delete;
+
+    private:
+        linear_allocator &allocator;            /**< The allocator of the thread. */
+        linear_allocator::marker position;      /**< Where to rewind to. */
+    };
+
+    /**
+     *  Allocator for standard containers, taking memory from the thread's @ref linear_allocator.
+     *
+     *  Containers using this must not leave their thread, nor outlive the enclosing @ref transient_scope.
+     */
+    template<typename T>
+    class transient_allocator // not final, the standard containers derive from their allocator
+    {
+    public:
+        using value_type = T;
+
+        transient_allocator() noexcept : allocator(&linear_allocator::ForThread()) {}
+
+        template<typename U>
+        transient_allocator(const transient_allocator<U> &other) noexcept : allocator(&other.GetAllocator()) {}
+
+        T* allocate(const std::size_t count) { return static_cast<T*>(allocator->Allocate(count * sizeof(T), alignof(T))); }
+        void deallocate(T *memory, const std::size_t count) noexcept { allocator->Deallocate(memory, count * sizeof(T)); }
+
+        /**
+         *  Get the allocator memory is taken from.
+         */
+        linear_allocator& GetAllocator() const noexcept { return *allocator; }
+
+    private:
+        linear_allocator *allocator; /**< The allocator memory is taken from. */
+    };
+
+    template<typename T, typename U>
+    bool operator==(const transient_allocator<T> &a, const transient_allocator<U> &b) noexcept { return &a.GetAllocator() == &b.GetAllocator(); }
+
+    template<typename T, typename U>
+    bool operator!=(const transient_allocator<T> &a, const transient_allocator<U> &b) noexcept { return !(a == b); }
+
+    template<typename T>
+    using transient_vector = std::vector<T, transient_allocator<T>>; /**< A @c std::vector of temporaries. */
+} }
+
+#endif //SH3_SYSTEM_LINEAR_ALLOCATOR_HPP_INCLUDED
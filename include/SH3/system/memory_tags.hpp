@@ -0,0 +1,140 @@
+/** @file
+ *  Memory accounting by subsystem.
+ *
+ *  Allocations are tracked under a @ref sh3::system::memory_tag with @ref sh3::system::TrackAllocation and
+ *  @ref sh3::system::TrackFree, or with a @ref sh3::system::memory_charge owned by whatever holds the memory.
+ *  Each thread counts into counters of its own, so tracking costs a relaxed add; the counters are only
+ *  summed up by @ref sh3::system::SampleMemory, once per frame.
+ *
+ *  GPU memory can't be measured directly, so the GPU tags hold estimates from sizes and formats.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_MEMORY_TAGS_HPP_INCLUDED
+#define SH3_SYSTEM_MEMORY_TAGS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sh3 { namespace system {
+    /**
+     *  The subsystems memory is accounted to.
+     */
+    enum class memory_tag
+    {
+        ARC,            /**< File contents read from the arc sections. */
+        TEXTURE,        /**< Decoded pixel data. */
+        MESH,           /**< Model geometry. */
+        AUDIO,          /**< Sound data. */
+        SHADER,         /**< Shader sources. */
+        GPU_TEXTURE,    /**< Textures on the gpu (estimate). */
+        GPU_BUFFER,     /**< Buffer objects on the gpu (estimate). */
+        MAX
+    };
+
+    /**
+     *  Memory statistics of a @ref memory_tag.
+     */
+    struct memory_stats final
+    {
+        std::int64_t current = 0;           /**< Bytes in use. */
+        std::int64_t peak = 0;              /**< The most bytes in use at any sample. */
+        std::uint64_t allocations = 0;      /**< Number of allocations so far. */
+        double rate = 0.0;                  /**< Bytes allocated per second between the last two samples. */
+    };
+
+    /**
+     *  Get the name of a tag.
+     */
+    const char* GetMemoryTagName(memory_tag tag);
+
+    /**
+     *  Account an allocation.
+     *
+     *  @param tag   The subsystem.
+     *  @param bytes The size.
+     */
+    void TrackAllocation(memory_tag tag, std::size_t bytes);
+
+    /**
+     *  Account a deallocation. May happen on another thread than the allocation.
+     *
+     *  @param tag   The subsystem.
+     *  @param bytes The size.
+     */
+    void TrackFree(memory_tag tag, std::size_t bytes);
+
+    /**
+     *  Sum up the counters of all threads, updating peaks and rates.
+     *
+     *  Call once per frame; peaks are only as precise as the sampling.
+     */
+    void SampleMemory();
+
+    /**
+     *  Get the statistics of a tag as of the last @ref SampleMemory.
+     *
+     *  @param tag The subsystem.
+     */
+    memory_stats GetMemoryStats(memory_tag tag);
+
+    /**
+     *  Sample and log the statistics of all tags.
+     */
+    void DumpMemoryStats();
+
+    /**
+     *  Memory accounted to a tag for as long as this exists.
+     *
+     *  Meant as member next to the memory it accounts for; copying it accounts the memory again, like copying
+     *  the memory would.
+     */
+    class memory_charge final
+    {
+    public:
+        /**
+         *  Constructor.
+         *
+         *  @param chargedTag The subsystem.
+         *  @param bytes      The size to account right away.
+         */
+        explicit memory_charge(const memory_tag chargedTag, const std::size_t bytes = 0) : tag(chargedTag) { Set(bytes); }
+        memory_charge(const memory_charge &other) : tag(other.tag) { Set(other.size); }
+        ~memory_charge() { Set(0); }
+
+        memory_charge& operator=(const memory_charge &other)
+        {
+            if(this != &other)
+            {
+                Set(0);
+                tag = other.tag;
+                Set(other.size);
+            }
+            return *this;
+        }
+
+        /**
+         *  Change the size accounted.
+         *
+         *  @param bytes The new size.
+         */
+        void Set(const std::size_t bytes)
+        {
+            if(bytes > size)
+            {
+                TrackAllocation(tag, bytes - size);
+            }
+            else if(bytes < size)
+            {
+                TrackFree(tag, size - bytes);
+            }
+            size = bytes;
+        }
+
+    private:
+        memory_tag tag;         /**< The subsystem. */
+        std::size_t size = 0;   /**< The size accounted. */
+    };
+} }
+
+#endif //SH3_SYSTEM_MEMORY_TAGS_HPP_INCLUDED
@@ -0,0 +1,68 @@
+/** @file
+ *  Defines the @ref sh3::system::perf_clock.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_PERF_CLOCK_HPP_INCLUDED
+#define SH3_SYSTEM_PERF_CLOCK_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <ratio>
+
+#include <SDL_timer.h>
+
+namespace sh3 { namespace system {
+    /**
+     *  High resolution clock based on @c SDL_GetPerformanceCounter.
+     *
+     *  Implements the TrivialClock concept, with nanosecond @ref duration.
+     *  The epoch is whatever the performance counter counts from, so time points are only useful relative to each other.
+     */
+    struct perf_clock final
+    {
+    public:
+        perf_clock() = delete;
+
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<perf_clock>;
+
+        static constexpr bool is_steady = true;
+
+        /**
+         *  Get the current time.
+         */
+        static time_point now() noexcept { return FromCounter(SDL_GetPerformanceCounter()); }
+
+        /**
+         *  Convert a value of @c SDL_GetPerformanceCounter to a @ref time_point.
+         *
+         *  @param counter The counter value.
+         */
+        static time_point FromCounter(const Uint64 counter) noexcept
+        {
+            static const Uint64 frequency = SDL_GetPerformanceFrequency();
+            // split to avoid overflowing counter * 1e9
+            const Uint64 seconds = counter / frequency;
+            const Uint64 fraction = counter % frequency;
+            return time_point(duration(static_cast<rep>(seconds * std::nano::den + fraction * std::nano::den / frequency)));
+        }
+
+        /**
+         *  Convert a past value of @c SDL_GetTicks to a @ref time_point, e.g. the @c timestamp SDL gives an
+         *  @c SDL_Event when queueing it.
+         *
+         *  @param ticks The ticks, in milliseconds; the result is only as precise.
+         */
+        static time_point FromTicks(const Uint32 ticks) noexcept
+        {
+            // unsigned, so this survives the ticks wrapping around
+            const Uint32 age = SDL_GetTicks() - ticks;
+            return now() - std::chrono::milliseconds(age);
+        }
+    };
+} }
+
+#endif //SH3_SYSTEM_PERF_CLOCK_HPP_INCLUDED
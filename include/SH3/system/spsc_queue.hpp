@@ -0,0 +1,89 @@
+/** @file
+ *  Defines the @ref sh3::system::spsc_queue.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_SPSC_QUEUE_HPP_INCLUDED
+#define SH3_SYSTEM_SPSC_QUEUE_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace sh3 { namespace system {
+    /**
+     *  A bounded, lock-free queue for one producer and one consumer thread.
+     *
+     *  @ref Push may only be called from the producer, @ref Pop only from the consumer. Neither ever blocks.
+     *
+     *  @tparam T        The element type. Must be copy-assignable.
+     *  @tparam capacity The maximum number of queued elements; must be a power of two.
+     */
+    template<typename T, std::size_t capacity>
+    class spsc_queue final
+    {
+        static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        spsc_queue() = default;
+        spsc_queue(const spsc_queue&) = delete;
+        spsc_queue& operator=(const spsc_queue&) = delete;
+
+        /**
+         *  Append an element (producer only).
+         *
+         *  @param item The element.
+         *
+         *  @returns @c false if the queue is full.
+         */
+        bool Push(const T &item)
+        {
+            const std::size_t tail = tailIndex.load(std::memory_order_relaxed);
+            if(tail - headIndex.load(std::memory_order_acquire) == capacity)
+            {
+                return false;
+            }
+            items[tail & (capacity - 1)] = item;
+            tailIndex.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         *  Remove the oldest element (consumer only).
+         *
+         *  @param[out] item The element.
+         *
+         *  @returns @c false if the queue is empty.
+         */
+        bool Pop(T &item)
+        {
+            const std::size_t head = headIndex.load(std::memory_order_relaxed);
+            if(head == tailIndex.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = items[head & (capacity - 1)];
+            headIndex.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         *  Check whether the queue is full (exact on the producer, a snapshot elsewhere).
+         */
+        bool IsFull() const { return tailIndex.load(std::memory_order_relaxed) - headIndex.load(std::memory_order_acquire) == capacity; }
+
+        /**
+         *  Check whether the queue is empty (exact on the consumer, a snapshot elsewhere).
+         */
+        bool IsEmpty() const { return headIndex.load(std::memory_order_relaxed) == tailIndex.load(std::memory_order_acquire); }
+
+    private:
+        static constexpr std::size_t cacheLine = 64; /**< Keeps the indices from sharing a cache line. */
+
+        alignas(cacheLine) std::atomic<std::size_t> headIndex{0};   /**< Next element to pop; written by the consumer. */
+        alignas(cacheLine) std::atomic<std::size_t> tailIndex{0};   /**< Next slot to push to; written by the producer. */
+        alignas(cacheLine) std::array<T, capacity> items{};         /**< The ring buffer. */
+    };
+} }
+
+#endif //SH3_SYSTEM_SPSC_QUEUE_HPP_INCLUDED
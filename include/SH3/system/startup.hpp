@@ -0,0 +1,123 @@
+/** @file
+ *  Defines the @ref sh3::system::startup_graph.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_STARTUP_HPP_INCLUDED
+#define SH3_SYSTEM_STARTUP_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SH3/system/jobs.hpp"
+#include "SH3/system/perf_clock.hpp"
+#include "SH3/system/task.hpp"
+
+namespace sh3 { namespace system {
+    /**
+     *  The steps of engine startup and what they depend on.
+     *
+     *  Steps run as soon as their dependencies are done: steps that need the GL context run on the main thread,
+     *  everything else (reading files, parsing, decoding) on the @ref job_system meanwhile.
+     *  Options are read without synchronisation, so the configuration has to be loaded before, not in a step.
+     *
+     *  Afterwards, @ref Report logs when each step ran and the critical path, i.e. the chain of steps that
+     *  determined how long startup took.
+     */
+    class startup_graph final
+    {
+    public:
+        using step_index = std::size_t; /**< Identifies a step. */
+
+        /**
+         *  Where a step may run.
+         */
+        enum class affinity
+        {
+            ANY,    /**< Any worker of the job system. */
+            MAIN,   /**< The thread calling @ref Run, which owns the window and GL context. */
+        };
+
+        startup_graph();
+        ~startup_graph();
+
+        startup_graph(const startup_graph&) = delete;
+        startup_graph& operator=(const startup_graph&) = delete;
+
+        /**
+         *  Add a step.
+         *
+         *  @param name         The name of the step, for @ref Report. Must outlive this.
+         *  @param function     The work to do.
+         *  @param dependencies Steps that must be done before this one starts.
+         *  @param where        Where the step may run.
+         *
+         *  @returns The index of the step, to depend on.
+         */
+        step_index Add(const char *name, std::function<void()> function, std::vector<step_index> dependencies = {}, affinity where = affinity::ANY);
+
+        /**
+         *  Run all steps and wait for them.
+         *
+         *  @param jobs The job system to run steps on.
+         */
+        void Run(job_system &jobs);
+
+        /**
+         *  Log the timeline of the last @ref Run and its critical path.
+         */
+        void Report() const;
+
+        /**
+         *  How long a step of the last @ref Run took.
+         */
+        struct step_timing final
+        {
+            const char *name;               /**< The name of the step. */
+            perf_clock::duration duration;  /**< From its start to its end. */
+        };
+
+        /**
+         *  Get how long each step of the last @ref Run took, in the order they were added.
+         */
+        std::vector<step_timing> GetTimings() const;
+
+        /**
+         *  Get the critical path of the last @ref Run, first step first.
+         *
+         *  It ends with the step that finished last and goes back through the dependency that finished last each time.
+         */
+        std::vector<step_index> GetCriticalPath() const;
+
+        /**
+         *  Get how long the last @ref Run took, from the start of the first step to the end of the last.
+         */
+        perf_clock::duration GetDuration() const { return endTime - startTime; }
+
+    private:
+        struct step;
+
+        /**
+         *  Queue a step whose dependencies are done.
+         */
+        void Schedule(step &ready);
+
+        /**
+         *  Run a step and queue the steps waiting for it.
+         */
+        void Execute(step &current);
+
+    private:
+        std::vector<std::unique_ptr<step>> steps{};     /**< All steps, in the order they were added. */
+        job_system *runJobs = nullptr;                  /**< The job system of the current @ref Run. */
+        main_thread_queue mainQueue{};                  /**< Steps ready to run on the main thread. */
+        std::atomic<std::size_t> finished{0};           /**< Number of steps done. */
+        perf_clock::time_point startTime{};             /**< When @ref Run started. */
+        perf_clock::time_point endTime{};               /**< When @ref Run finished. */
+    };
+} }
+
+#endif //SH3_SYSTEM_STARTUP_HPP_INCLUDED
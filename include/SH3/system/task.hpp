@@ -0,0 +1,318 @@
+/** @file
+ *  Defines @ref sh3::system::task and @ref sh3::system::promise, values that become available later,
+ *  and the @ref sh3::system::main_thread_queue.
+ *
+ *  Asynchronous work is written as a chain of continuations, each running on an executor of its choice:
+ *
+ *      files.Open(name)
+ *          .Then(jobs, [](const std::shared_ptr<vfile> &file) { return Decode(*file); })   // on a worker
+ *          .Then(mainQueue, [](const image &decoded) { return Upload(decoded); });         // on the GL thread
+ *
+ *  A continuation may itself return a @ref task, e.g. a model loading its textures; the chain then continues
+ *  once that inner task is ready. Several tasks are joined with @ref WhenAll.
+ *
+ *  An executor is anything with a @c Run(std::function<void()>) member, like @ref job_system and @ref main_thread_queue.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_TASK_HPP_INCLUDED
+#define SH3_SYSTEM_TASK_HPP_INCLUDED
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/jobs.hpp"
+
+namespace sh3 { namespace system {
+    template<typename T> class task;
+    template<typename T> class promise;
+
+    namespace detail {
+        /**
+         *  What a @ref task and its @ref promise share.
+         */
+        template<typename T>
+        struct task_state final
+        {
+            std::mutex mutex{};                                     /**< Guards everything else. */
+            boost::optional<T> value{};                             /**< The result, once set. */
+            std::vector<std::function<void()>> continuations{};     /**< Called once @ref value is set. */
+        };
+
+        template<typename T> struct unwrap_task { using type = T; };
+        template<typename T> struct unwrap_task<task<T>> { using type = T; };
+    }
+
+    /**
+     *  Runs functions on the main thread, which owns the GL context.
+     *
+     *  @ref Run may be called from any thread, @ref RunAll once per frame on the main thread.
+     */
+    class main_thread_queue final
+    {
+    public:
+        main_thread_queue() = default;
+        main_thread_queue(const main_thread_queue&) = delete;
+        main_thread_queue& operator=(const main_thread_queue&) = delete;
+
+        /**
+         *  Queue a function.
+         *
+         *  @param function The function.
+         */
+        void Run(std::function<void()> function)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued.push_back(std::move(function));
+        }
+
+        /**
+         *  Run all queued functions, including ones queued meanwhile.
+         *
+         *  @returns The number of functions run.
+         */
+        std::size_t RunAll()
+        {
+            std::size_t count = 0;
+            for(;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(queued.empty())
+                    {
+                        return count;
+                    }
+                    running.swap(queued);
+                }
+                for(auto &function : running)
+                {
+                    function();
+                }
+                count += running.size();
+                running.clear();
+            }
+        }
+
+    private:
+        std::mutex mutex{};                                 /**< Guards @ref queued. */
+        std::vector<std::function<void()>> queued{};        /**< Functions to run. */
+        std::vector<std::function<void()>> running{};       /**< Functions being run; only touched by @ref RunAll. */
+    };
+
+    /**
+     *  A value of type @p T that becomes available later.
+     *
+     *  Tasks are cheap handles; copies refer to the same value.
+     */
+    template<typename T>
+    class task final
+    {
+    public:
+        using value_type = T;
+
+        /**
+         *  Create a task that is ready right away.
+         *
+         *  @param value The value.
+         */
+        static task FromValue(T value)
+        {
+            promise<T> source;
+            source.Set(std::move(value));
+            return source.GetTask();
+        }
+
+        /**
+         *  Check whether the value is available.
+         */
+        bool IsReady() const
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            return static_cast<bool>(state->value);
+        }
+
+        /**
+         *  Get the value.
+         *
+         *  @note Only valid if @ref IsReady.
+         */
+        const T& Get() const
+        {
+            ASSERT_MSG(IsReady(), "task::Get called before the value was set");
+            return *state->value;
+        }
+
+        /**
+         *  Run jobs until the value is available.
+         *
+         *  Meant for start-up and tests; frame code should chain with @ref Then instead.
+         *
+         *  @param jobs The job system the remaining work runs on.
+         *
+         *  @returns The value.
+         */
+        const T& Wait(job_system &jobs) const
+        {
+            while(!IsReady())
+            {
+                if(!jobs.RunPending())
+                {
+                    std::this_thread::yield();
+                }
+            }
+            return *state->value;
+        }
+
+        /**
+         *  Call a function once the value is available.
+         *
+         *  The function is called right away on the calling thread if the value is already set, otherwise on
+         *  the thread setting it. It should thus be short; use @ref Then for real work.
+         *
+         *  @param function Called without arguments.
+         */
+        void OnReady(std::function<void()> function) const
+        {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if(!state->value)
+                {
+                    state->continuations.push_back(std::move(function));
+                    return;
+                }
+            }
+            function();
+        }
+
+        /**
+         *  Continue with a function of the value, once it is available.
+         *
+         *  @param exec     The executor to run @p function on.
+         *  @param function Called with the value as <tt>const T&</tt>. If it returns a @ref task, the result is the value of that task.
+         *
+         *  @returns A task for the result of @p function.
+         */
+        template<typename executor, typename function>
+        auto Then(executor &exec, function &&continuation) const
+            -> task<typename detail::unwrap_task<typename std::result_of<typename std::decay<function>::type(const T&)>::type>::type>
+        {
+            using result = typename std::result_of<typename std::decay<function>::type(const T&)>::type;
+            using unwrapped = typename detail::unwrap_task<result>::type;
+
+            promise<unwrapped> next;
+            task<unwrapped> nextTask = next.GetTask();
+            const std::shared_ptr<detail::task_state<T>> source = state;
+            typename std::decay<function>::type call(std::forward<function>(continuation));
+            OnReady([&exec, source, next, call]() mutable
+            {
+                exec.Run([source, next, call]() mutable
+                {
+                    Fulfil(next, call(*source->value));
+                });
+            });
+            return nextTask;
+        }
+
+    private:
+        friend class promise<T>;
+
+        explicit task(std::shared_ptr<detail::task_state<T>> shared) : state(std::move(shared)) {}
+
+        template<typename U>
+        static void Fulfil(promise<U> &target, U value) { target.Set(std::move(value)); }
+
+        template<typename U>
+        static void Fulfil(promise<U> &target, const task<U> &inner)
+        {
+            inner.OnReady([target, inner]() mutable { target.Set(inner.Get()); });
+        }
+
+    private:
+        std::shared_ptr<detail::task_state<T>> state; /**< The shared value. */
+    };
+
+    /**
+     *  The producing side of a @ref task.
+     */
+    template<typename T>
+    class promise final
+    {
+    public:
+        promise() : state(std::make_shared<detail::task_state<T>>()) {}
+
+        /**
+         *  Get the @ref task for the value.
+         */
+        task<T> GetTask() const { return task<T>(state); }
+
+        /**
+         *  Set the value and run the continuations.
+         *
+         *  @param value The value. Must only be set once.
+         */
+        void Set(T value)
+        {
+            std::vector<std::function<void()>> continuations;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                ASSERT_MSG(!state->value, "promise::Set called twice");
+                state->value = std::move(value);
+                continuations.swap(state->continuations);
+            }
+            for(auto &continuation : continuations)
+            {
+                continuation();
+            }
+        }
+
+    private:
+        std::shared_ptr<detail::task_state<T>> state; /**< The shared value. */
+    };
+
+    /**
+     *  Join several tasks.
+     *
+     *  @param tasks The tasks.
+     *
+     *  @returns A task for the values of all @p tasks, in the same order, ready once all of them are.
+     */
+    template<typename T>
+    task<std::vector<T>> WhenAll(const std::vector<task<T>> &tasks)
+    {
+        if(tasks.empty())
+        {
+            return task<std::vector<T>>::FromValue({});
+        }
+
+        promise<std::vector<T>> all;
+        const auto remaining = std::make_shared<std::atomic<std::size_t>>(tasks.size());
+        for(const task<T> &part : tasks)
+        {
+            part.OnReady([all, remaining, tasks]() mutable
+            {
+                if(--*remaining == 0)
+                {
+                    std::vector<T> values;
+                    values.reserve(tasks.size());
+                    for(const task<T> &done : tasks)
+                    {
+                        values.push_back(done.Get());
+                    }
+                    all.Set(std::move(values));
+                }
+            });
+        }
+        return all.GetTask();
+    }
+} }
+
+#endif //SH3_SYSTEM_TASK_HPP_INCLUDED
@@ -23,7 +23,15 @@ class sh3_window
 private:
 
 public:
-    sh3_window(int width, int height, const std::string& title);
+    /**
+     *  Constructor.
+     *
+     *  @param width  Width of the window.
+     *  @param height Height of the window.
+     *  @param title  Title of the window.
+     *  @param flags  @c SDL_WindowFlags in addition to @c SDL_WINDOW_OPENGL, e.g. @c SDL_WINDOW_HIDDEN.
+     */
+    sh3_window(int width, int height, const std::string& title, Uint32 flags = 0);
 
     std::unique_ptr<SDL_Window, sdl_destroyer> hwnd;        /**< Our window handle */
     sh3_gl::context context;                                /**< This window's OpenGL Context */
@@ -0,0 +1,128 @@
+/** @file
+ *  Defines the @ref sh3::system::work_stealing_deque.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_SYSTEM_WORK_STEALING_DEQUE_HPP_INCLUDED
+#define SH3_SYSTEM_WORK_STEALING_DEQUE_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace sh3 { namespace system {
+    /**
+     *  A bounded Chase-Lev work-stealing deque.
+     *
+     *  The owning thread pushes and pops at the bottom (LIFO, which keeps its caches warm), any other thread
+     *  may steal from the top (FIFO, taking the oldest and usually largest pieces of work). Neither side ever blocks.
+     *
+     *  This follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013), without growing.
+     *
+     *  @tparam T        The element type; a pointer, so that @c nullptr can signal "nothing".
+     *  @tparam capacity The maximum number of elements; must be a power of two.
+     */
+    template<typename T, std::size_t capacity>
+    class work_stealing_deque final
+    {
+        static_assert(std::is_pointer<T>::value, "elements must be pointers");
+        static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        work_stealing_deque() = default;
+        work_stealing_deque(const work_stealing_deque&) = delete;
+        work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+        /**
+         *  Add an element at the bottom (owner only).
+         *
+         *  @param item The element.
+         *
+         *  @returns @c false if the deque is full.
+         */
+        bool Push(const T item)
+        {
+            const std::int64_t b = bottom.load(std::memory_order_relaxed);
+            const std::int64_t t = top.load(std::memory_order_acquire);
+            if(b - t >= static_cast<std::int64_t>(capacity))
+            {
+                return false;
+            }
+            Slot(b).store(item, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         *  Remove the element at the bottom (owner only).
+         *
+         *  @returns The element, or @c nullptr if the deque is empty.
+         */
+        T Pop()
+        {
+            const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top.load(std::memory_order_relaxed);
+
+            if(t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T item = Slot(b).load(std::memory_order_relaxed);
+            if(t == b)
+            {
+                // last element; race the thieves for it
+                if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        /**
+         *  Remove the element at the top (any thread).
+         *
+         *  @returns The element, or @c nullptr if the deque is empty or another thread got it first.
+         */
+        T Steal()
+        {
+            std::int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b = bottom.load(std::memory_order_acquire);
+            if(t >= b)
+            {
+                return nullptr;
+            }
+
+            T item = Slot(t).load(std::memory_order_relaxed);
+            if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return item;
+        }
+
+    private:
+        static constexpr std::size_t cacheLine = 64; /**< Keeps the indices from sharing a cache line. */
+
+        std::atomic<T>& Slot(const std::int64_t index) { return items[static_cast<std::size_t>(index) & (capacity - 1)]; }
+
+    private:
+        // padded rather than aligned, since operator new does not honour extended alignment before C++17
+        std::atomic<std::int64_t> top{0};                                       /**< Next element to steal; advanced by thieves and the last pop. */
+        char topPadding[cacheLine - sizeof(std::atomic<std::int64_t>)];         /**< Keeps @ref bottom off the cache line of @ref top. */
+        std::atomic<std::int64_t> bottom{0};                                    /**< Next slot to push to; written by the owner only. */
+        char bottomPadding[cacheLine - sizeof(std::atomic<std::int64_t>)];      /**< Keeps @ref items off the cache line of @ref bottom. */
+        std::array<std::atomic<T>, capacity> items{};                           /**< The ring buffer. */
+    };
+} }
+
+#endif //SH3_SYSTEM_WORK_STEALING_DEQUE_HPP_INCLUDED
@@ -0,0 +1,102 @@
+/** @file
+ *  Definition of @ref aabb.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_TYPES_AABB_HPP_INCLUDED
+#define SH3_TYPES_AABB_HPP_INCLUDED
+
+#include <limits>
+
+#include <glm/glm.hpp>
+
+/**
+ *  An axis-aligned bounding box.
+ *
+ *  A default constructed @ref aabb is empty (@ref IsEmpty) and can be grown with @ref Extend.
+ */
+struct aabb final
+{
+public:
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());    /**< Minimum corner. */
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());   /**< Maximum corner. */
+
+    aabb() = default;
+
+    /**
+     *  Constructor.
+     *
+     *  @param lo The minimum corner.
+     *  @param hi The maximum corner.
+     */
+    aabb(const glm::vec3& lo, const glm::vec3& hi): min(lo), max(hi) {}
+
+    /**
+     *  Check whether this box contains no points at all.
+     */
+    bool IsEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+    /**
+     *  Grow the box to contain a point.
+     *
+     *  @param point The point to include.
+     */
+    void Extend(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+
+    /**
+     *  Grow the box to contain another box.
+     *
+     *  @param other The @ref aabb to include.
+     */
+    void Extend(const aabb& other) { min = glm::min(min, other.min); max = glm::max(max, other.max); }
+
+    /**
+     *  Get the center of the box.
+     */
+    glm::vec3 Center() const { return (min + max) * 0.5f; }
+
+    /**
+     *  Get the half-size of the box along each axis.
+     */
+    glm::vec3 Extents() const { return (max - min) * 0.5f; }
+
+    /**
+     *  Get the surface area of the box.
+     *
+     *  @returns The surface area, or 0 for an empty box.
+     */
+    float SurfaceArea() const
+    {
+        if(IsEmpty())
+        {
+            return 0.0f;
+        }
+        const glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    /**
+     *  Check whether a point lies inside the box (boundary inclusive).
+     *
+     *  @param point The point to check.
+     */
+    bool Contains(const glm::vec3& point) const
+    {
+        return point.x >= min.x && point.y >= min.y && point.z >= min.z
+            && point.x <= max.x && point.y <= max.y && point.z <= max.z;
+    }
+
+    /**
+     *  Check whether two boxes overlap (boundary inclusive).
+     *
+     *  @param other The @ref aabb to check against.
+     */
+    bool Intersects(const aabb& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x
+            && min.y <= other.max.y && max.y >= other.min.y
+            && min.z <= other.max.z && max.z >= other.min.z;
+    }
+};
+
+#endif // SH3_TYPES_AABB_HPP_INCLUDED
@@ -0,0 +1,25 @@
+/** @file
+ *  Implementation of async_mft.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/arc/async_mft.hpp"
+
+#include "SH3/arc/mft.hpp"
+
+using namespace sh3::arc;
+
+auto async_mft::Open(const std::string &filename) -> file_task
+{
+    sh3::system::promise<std::shared_ptr<vfile>> opened;
+    jobs.Run([this, filename, opened]() mutable
+    {
+        std::shared_ptr<vfile> file;
+        {
+            std::lock_guard<std::mutex> lock(readMutex);
+            file = std::make_shared<vfile>(files, filename);
+        }
+        opened.Set(std::move(file));
+    });
+    return opened.GetTask();
+}
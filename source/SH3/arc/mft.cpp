@@ -21,6 +21,7 @@
 
 #include "SH3/arc/subarc.hpp"
 #include "SH3/error.hpp"
+#include "SH3/system/linear_allocator.hpp"
 #include "SH3/system/log.hpp"
 
 using namespace sh3::arc;
@@ -349,7 +350,8 @@ namespace {
     {
         assert(len <= std::numeric_limits<int>::max()); // overflow check
 
-        std::vector<char> buf(len);
+        sh3::system::transient_scope scope;
+        sh3::system::transient_vector<char> buf(len);
         std::size_t res = ReadData(buf.data(), buf.size(), e);
         assert(res <= buf.size());
 
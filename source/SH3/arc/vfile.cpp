@@ -39,6 +39,7 @@ bool vfile::Open(mft& mft, const std::string& filename)
     {
         assert(size >= 0);
         fsize = static_cast<unsigned>(size);
+        charge.Set(buffer.capacity());
 
         open = true;
     }
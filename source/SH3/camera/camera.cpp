@@ -16,39 +16,120 @@
 
 static constexpr glm::vec3 worldUp = glm::vec3(0, 1, 0); /**< Which axis is considered 'world up'. */
 
+constexpr std::uint8_t sh3::camera::Camera::DIRTY_POSITION;
+constexpr std::uint8_t sh3::camera::Camera::DIRTY_ROTATION;
+constexpr std::uint8_t sh3::camera::Camera::DIRTY_LENS;
+
 sh3::camera::Camera::Camera(const glm::vec3& pos, angle<float> fov, float aspect, float zNear, float zFar)
 : camPos(pos), camFov(fov), aRatio(aspect), camNear(zNear), camFar(zFar),
-  camFront(glm::vec3(0.0f, 0.0f, -1.0f)), camUp(glm::vec3(0.0f, 1.0f, 0.0f)),
+  camFront(glm::vec3(0.0f, 0.0f, -1.0f)), camUp(glm::vec3(0.0f, 1.0f, 0.0f)), camRight(glm::vec3(1.0f, 0.0f, 0.0f)),
+  vMatrix(), pMatrix(), vpMatrix(), invVMatrix(), invPMatrix(), invVpMatrix(),
+  dirty(DIRTY_ROTATION | DIRTY_LENS),
   camPitch(angle<float>::FromDegrees(0.0f)),
   camYaw(angle<float>::FromDegrees(-90.0f)),
   camMode(MODE::FIRST_PERSON)
 {
-    RecalculatePerspective();
 }
 
-void sh3::camera::Camera::RecalculatePerspective()
+bool sh3::camera::Camera::Clean(dirty_flag flag) const
+{
+    if(!(dirty & flag))
+    {
+        return false;
+    }
+    dirty = static_cast<std::uint8_t>(dirty & ~flag);
+    return true;
+}
+
+void sh3::camera::Camera::UpdateOrientation() const
 {
+    if(!Clean(DIRTY_ORIENTATION))
+    {
+        return;
+    }
+
+    const auto pitch = camPitch.SinCos();
+    const auto yaw = camYaw.SinCos();
     glm::vec3 front;
-    front.x = std::cos(camPitch.AsRadians()) * std::cos(camYaw.AsRadians());
-    front.y = std::sin(camPitch.AsRadians());
-    front.z = std::cos(camPitch.AsRadians()) * std::sin(camYaw.AsRadians());
+    front.x = pitch.cos * yaw.cos;
+    front.y = pitch.sin;
+    front.z = pitch.cos * yaw.sin;
     camFront = glm::normalize(front);
 
     camRight = glm::normalize(glm::cross(camFront, worldUp));
-    camUp = glm::normalize(glm::cross(camRight, camFront));
+    camUp = glm::cross(camRight, camFront); // already unit length, since camRight and camFront are orthonormal
+}
 
-    //vMatrix = glm::lookAt(camPos, camPos + camFront, camUp);
-    pMatrix = glm::perspective(camFov.AsRadians(), aRatio, camNear, camFar) * glm::lookAt(camPos, camPos + camFront, camUp); // Set our perspective matrix
+const glm::mat4& sh3::camera::Camera::GetViewMatrix() const
+{
+    UpdateOrientation();
+    if(Clean(DIRTY_VIEW))
+    {
+        vMatrix = glm::lookAt(camPos, camPos + camFront, camUp);
+    }
+    return vMatrix;
 }
 
 const glm::mat4& sh3::camera::Camera::GetProjectionMatrix() const
 {
+    if(Clean(DIRTY_PROJECTION))
+    {
+        pMatrix = glm::perspective(camFov.AsRadians(), aRatio, camNear, camFar);
+    }
     return pMatrix;
 }
 
+const glm::mat4& sh3::camera::Camera::GetViewProjectionMatrix() const
+{
+    if(dirty & DIRTY_VIEW_PROJECTION)
+    {
+        const glm::mat4 combined = GetProjectionMatrix() * GetViewMatrix();
+        Clean(DIRTY_VIEW_PROJECTION);
+        vpMatrix = combined;
+    }
+    return vpMatrix;
+}
+
+const glm::mat4& sh3::camera::Camera::GetInverseViewMatrix() const
+{
+    UpdateOrientation();
+    if(Clean(DIRTY_INVERSE_VIEW))
+    {
+        // The view matrix is a rotation followed by a translation, so its inverse can just be written down.
+        invVMatrix[0] = glm::vec4(camRight, 0.0f);
+        invVMatrix[1] = glm::vec4(camUp, 0.0f);
+        invVMatrix[2] = glm::vec4(-camFront, 0.0f);
+        invVMatrix[3] = glm::vec4(camPos, 1.0f);
+    }
+    return invVMatrix;
+}
+
+const glm::mat4& sh3::camera::Camera::GetInverseProjectionMatrix() const
+{
+    if(dirty & DIRTY_INVERSE_PROJECTION)
+    {
+        const glm::mat4 inverse = glm::inverse(GetProjectionMatrix());
+        Clean(DIRTY_INVERSE_PROJECTION);
+        invPMatrix = inverse;
+    }
+    return invPMatrix;
+}
+
+const glm::mat4& sh3::camera::Camera::GetInverseViewProjectionMatrix() const
+{
+    if(dirty & DIRTY_INVERSE_VIEW_PROJECTION)
+    {
+        const glm::mat4 inverse = GetInverseViewMatrix() * GetInverseProjectionMatrix();
+        Clean(DIRTY_INVERSE_VIEW_PROJECTION);
+        invVpMatrix = inverse;
+    }
+    return invVpMatrix;
+}
+
 void sh3::camera::Camera::SetPosition(const glm::vec3& pos)
 {
     camPos = pos;
+    dirty |= DIRTY_POSITION;
 }
 
 void sh3::camera::Camera::Translate(const glm::vec3& trans)
@@ -56,7 +137,7 @@ void sh3::camera::Camera::Translate(const glm::vec3& trans)
     if(camMode == MODE::FIRST_PERSON)
     {
         camPos += trans;
-        RecalculatePerspective();
+        dirty |= DIRTY_POSITION;
     }
 }
 
@@ -64,15 +145,16 @@ void sh3::camera::Camera::Translate(const float factor)
 {
     if(camMode == MODE::FIRST_PERSON)
     {
+        UpdateOrientation();
         camPos += camFront * factor;
-        RecalculatePerspective();
+        dirty |= DIRTY_POSITION;
     }
 }
 
 void sh3::camera::Camera::SetFOV(angle<float> fov)
 {
     camFov = fov;
-    RecalculatePerspective();
+    dirty |= DIRTY_LENS;
 }
 
 void sh3::camera::Camera::SetMode(sh3::camera::MODE mode)
@@ -83,14 +165,14 @@ void sh3::camera::Camera::SetMode(sh3::camera::MODE mode)
 void sh3::camera::Camera::AddYaw(angle<float> yaw)
 {
     camYaw += yaw;
-    RecalculatePerspective();
+    dirty |= DIRTY_ROTATION;
 }
 
 void sh3::camera::Camera::AddPitch(angle<float> pitch)
 {
     //FIXME: This clamp causes a weird perspective when clamped between [-90, 90], which could be due to the way we are calculating the right vector (@ref camRight)
     camPitch = boost::algorithm::clamp(camPitch + pitch, angle<float>::FromDegrees(-89.0f), angle<float>::FromDegrees(89.0f));
-    RecalculatePerspective();
+    dirty |= DIRTY_ROTATION;
 }
 
 void sh3::camera::Camera::LookAt(const glm::vec3& look)
@@ -98,7 +180,7 @@ void sh3::camera::Camera::LookAt(const glm::vec3& look)
     glm::vec3 lookDir = camPos - look;
     camYaw += camYaw.FromRadians(-std::asin(lookDir.x / (std::sqrt((lookDir.x * lookDir.x) + (lookDir.z * lookDir.z)))));
     camPitch += camPitch.FromRadians(-std::atan(lookDir.y/lookDir.z));
-    RecalculatePerspective();
+    dirty |= DIRTY_ROTATION;
 }
 
 float sh3::camera::Camera::GetX() const
@@ -116,6 +198,17 @@ float sh3::camera::Camera::GetZ() const
     return camPos.z;
 }
 
+const glm::vec3& sh3::camera::Camera::GetPosition() const
+{
+    return camPos;
+}
+
+const glm::vec3& sh3::camera::Camera::GetFront() const
+{
+    UpdateOrientation();
+    return camFront;
+}
+
 angle<float> sh3::camera::Camera::GetYaw() const
 {
     return camYaw;
@@ -0,0 +1,88 @@
+/** @file
+ *  Implementation of frustum.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/camera/frustum.hpp"
+
+#include <cmath>
+
+using namespace sh3::camera;
+
+namespace {
+    /**
+     *  Get a row of a (column-major) matrix.
+     */
+    glm::vec4 Row(const glm::mat4& m, int row)
+    {
+        return glm::vec4(m[0][row], m[1][row], m[2][row], m[3][row]);
+    }
+
+    /**
+     *  Scale a plane so that its normal has unit length.
+     */
+    glm::vec4 NormalizePlane(const glm::vec4& plane)
+    {
+        const float len = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        return plane * (1.0f / len);
+    }
+}
+
+frustum frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+    // Gribb & Hartmann: each clip plane is the sum/difference of the w-row and one of the other rows.
+    const glm::vec4 x = Row(viewProjection, 0);
+    const glm::vec4 y = Row(viewProjection, 1);
+    const glm::vec4 z = Row(viewProjection, 2);
+    const glm::vec4 w = Row(viewProjection, 3);
+
+    frustum result;
+    result.planes.resize(PLANE_MAX);
+    result.planes[PLANE_LEFT]   = NormalizePlane(w + x);
+    result.planes[PLANE_RIGHT]  = NormalizePlane(w - x);
+    result.planes[PLANE_BOTTOM] = NormalizePlane(w + y);
+    result.planes[PLANE_TOP]    = NormalizePlane(w - y);
+    result.planes[PLANE_NEAR]   = NormalizePlane(w + z);
+    result.planes[PLANE_FAR]    = NormalizePlane(w - z);
+    return result;
+}
+
+bool frustum::Contains(const glm::vec3& point) const
+{
+    for(const glm::vec4& plane : planes)
+    {
+        if(Distance(plane, point) < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool frustum::Intersects(const glm::vec3& center, float radius) const
+{
+    for(const glm::vec4& plane : planes)
+    {
+        if(Distance(plane, center) < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool frustum::Intersects(const aabb& box) const
+{
+    const glm::vec3 center  = box.Center();
+    const glm::vec3 extents = box.Extents();
+    for(const glm::vec4& plane : planes)
+    {
+        // projected "radius" of the box onto the plane normal
+        const float r = extents.x * std::fabs(plane.x) + extents.y * std::fabs(plane.y) + extents.z * std::fabs(plane.z);
+        if(Distance(plane, center) < -r)
+        {
+            return false;
+        }
+    }
+    return true;
+}
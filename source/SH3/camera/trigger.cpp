@@ -0,0 +1,279 @@
+/** @file
+ *  Implementation of trigger.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/camera/trigger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "SH3/arc/mft.hpp"
+#include "SH3/arc/subarc.hpp"
+#include "SH3/system/assert.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::camera;
+
+constexpr float trigger_map::defaultCellSize;
+constexpr std::size_t trigger_map::maxCellsPerTrigger;
+
+namespace {
+    /** Number of bits per axis in a cell key. */
+    constexpr unsigned keyBits = 21;
+    /** Added to the grid coordinates so that they are positive. */
+    constexpr std::int32_t keyBias = 1 << (keyBits - 1);
+
+    glm::vec3 Vector(const float (&v)[4])
+    {
+        return glm::vec3(v[0], v[1], v[2]);
+    }
+}
+
+std::string trigger_map::load_error::message() const
+{
+    std::string error;
+    switch(result)
+    {
+    case load_result::SUCCESS:
+        error = "Success";
+        break;
+    case load_result::FILE_NOT_FOUND:
+        error = "File not found";
+        break;
+    case load_result::BAD_HEADER:
+        error = "Bad header";
+        break;
+    case load_result::TRUNCATED:
+        error = "Truncated file";
+        break;
+    }
+    return error;
+}
+
+trigger_map::trigger_map(arc::mft& mft, const std::string& filename, sh3::system::arena& memory, load_error& err, float gridCellSize)
+    : trigger_map(Load(mft, filename, err), memory, gridCellSize)
+{
+}
+
+trigger_map::trigger_map(const std::vector<trigger>& triggerList, sh3::system::arena& memory, float gridCellSize)
+    : triggers(triggerList.begin(), triggerList.end(), memory), cellSize(gridCellSize), invCellSize(1.0f / gridCellSize),
+      cells(0, cell_map::hasher(), cell_map::key_equal(), memory), oversized(memory), active(), scratch()
+{
+    ASSERT(cellSize > 0.0f);
+    Build();
+}
+
+glm::ivec3 trigger_map::CellOf(const glm::vec3& point) const
+{
+    const glm::vec3 scaled = point * invCellSize;
+    return glm::ivec3(static_cast<int>(std::floor(scaled.x)), static_cast<int>(std::floor(scaled.y)), static_cast<int>(std::floor(scaled.z)));
+}
+
+trigger_map::cell_key trigger_map::KeyOf(const glm::ivec3& cell)
+{
+    // Coordinates outside the representable range wrap around. This only makes distant cells share a key,
+    // which is harmless since every candidate is tested against its bounds anyway.
+    constexpr cell_key mask = (cell_key(1) << keyBits) - 1;
+    const auto component = [](int c) { return static_cast<cell_key>(static_cast<std::uint32_t>(c + keyBias)) & mask; };
+    return component(cell.x) | (component(cell.y) << keyBits) | (component(cell.z) << (2 * keyBits));
+}
+
+void trigger_map::Build()
+{
+    ASSERT(triggers.size() < std::numeric_limits<trigger_index>::max());
+
+    for(std::size_t i = 0; i < triggers.size(); ++i)
+    {
+        const auto index = static_cast<trigger_index>(i);
+        const aabb& bounds = triggers[i].bounds;
+        if(bounds.IsEmpty())
+        {
+            Log(LogLevel::WARN, "trigger_map::Build( ): Trigger %u has an empty volume, ignoring it.", index);
+            continue;
+        }
+
+        const glm::ivec3 lo = CellOf(bounds.min);
+        const glm::ivec3 hi = CellOf(bounds.max);
+        const glm::ivec3 span = hi - lo + glm::ivec3(1);
+        const double cellCount = static_cast<double>(span.x) * span.y * span.z;
+        if(cellCount > static_cast<double>(maxCellsPerTrigger))
+        {
+            oversized.push_back(index);
+            continue;
+        }
+
+        for(int z = lo.z; z <= hi.z; ++z)
+        {
+            for(int y = lo.y; y <= hi.y; ++y)
+            {
+                for(int x = lo.x; x <= hi.x; ++x)
+                {
+                    // triggers are visited in ascending order, so each list stays sorted
+                    const cell_key key = KeyOf(glm::ivec3(x, y, z));
+                    auto cell = cells.find(key);
+                    if(cell == cells.end())
+                    {
+                        cell = cells.emplace(key, index_list(cells.get_allocator())).first;
+                    }
+                    cell->second.push_back(index);
+                }
+            }
+        }
+    }
+
+    if(oversized.size() > triggers.size() / 4 + 1)
+    {
+        Log(LogLevel::WARN, "trigger_map::Build( ): %zu of %zu triggers are too large for a cell size of %f.", oversized.size(), triggers.size(), static_cast<double>(cellSize));
+    }
+}
+
+void trigger_map::Query(const glm::vec3& position, std::vector<trigger_index>& found) const
+{
+    found.clear();
+
+    const auto collect = [&](const index_list& candidates)
+    {
+        for(const trigger_index index : candidates)
+        {
+            if(triggers[index].bounds.Contains(position))
+            {
+                found.push_back(index);
+            }
+        }
+    };
+
+    const auto cell = cells.find(KeyOf(CellOf(position)));
+    if(cell != cells.end())
+    {
+        collect(cell->second);
+    }
+
+    const auto middle = static_cast<std::ptrdiff_t>(found.size());
+    collect(oversized);
+    std::inplace_merge(found.begin(), found.begin() + middle, found.end());
+}
+
+void trigger_map::Query(const aabb& box, std::vector<trigger_index>& found) const
+{
+    found.clear();
+    if(box.IsEmpty())
+    {
+        return;
+    }
+
+    const auto collect = [&](const index_list& candidates)
+    {
+        for(const trigger_index index : candidates)
+        {
+            if(triggers[index].bounds.Intersects(box))
+            {
+                found.push_back(index);
+            }
+        }
+    };
+
+    const glm::ivec3 lo = CellOf(box.min);
+    const glm::ivec3 hi = CellOf(box.max);
+    const glm::ivec3 span = hi - lo + glm::ivec3(1);
+    const double cellCount = static_cast<double>(span.x) * span.y * span.z;
+    if(cellCount > static_cast<double>(cells.size()))
+    {
+        // the box covers more cells than are occupied, walk the occupied ones instead
+        for(const auto& cell : cells)
+        {
+            collect(cell.second);
+        }
+    }
+    else
+    {
+        for(int z = lo.z; z <= hi.z; ++z)
+        {
+            for(int y = lo.y; y <= hi.y; ++y)
+            {
+                for(int x = lo.x; x <= hi.x; ++x)
+                {
+                    const auto cell = cells.find(KeyOf(glm::ivec3(x, y, z)));
+                    if(cell != cells.end())
+                    {
+                        collect(cell->second);
+                    }
+                }
+            }
+        }
+    }
+    collect(oversized);
+
+    // a trigger spanning several cells is found once per cell
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+}
+
+bool trigger_map::Update(const glm::vec3& position, std::vector<trigger_index>& entered, std::vector<trigger_index>& exited)
+{
+    entered.clear();
+    exited.clear();
+
+    Query(position, scratch);
+    std::set_difference(scratch.begin(), scratch.end(), active.begin(), active.end(), std::back_inserter(entered));
+    std::set_difference(active.begin(), active.end(), scratch.begin(), scratch.end(), std::back_inserter(exited));
+    std::swap(active, scratch);
+
+    return !entered.empty() || !exited.empty();
+}
+
+std::vector<trigger> trigger_map::Load(arc::mft& mft, const std::string& filename, load_error& err)
+{
+    std::vector<trigger> result;
+    std::vector<std::uint8_t> buffer;
+
+    const int size = mft.LoadFile(filename, buffer);
+    if(size == arc::arcFileNotFound)
+    {
+        Log(LogLevel::ERROR, "trigger_map::Load( ): Unable to find %s!", filename.c_str());
+        err.set_error(load_result::FILE_NOT_FOUND);
+        return result;
+    }
+
+    cam_header header;
+    static_assert(std::is_trivially_copyable<cam_header>::value, "must be deserializable through memcpy");
+    if(buffer.size() < sizeof(header))
+    {
+        err.set_error(load_result::BAD_HEADER);
+        return result;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+
+    if(header.triggerOffset < sizeof(header) || header.triggerOffset > buffer.size())
+    {
+        Log(LogLevel::ERROR, "trigger_map::Load( ): %s: trigger offset 0x%x is out of range!", filename.c_str(), header.triggerOffset);
+        err.set_error(load_result::BAD_HEADER);
+        return result;
+    }
+
+    std::size_t triggerCount = header.triggerCount;
+    const std::size_t available = (buffer.size() - header.triggerOffset) / sizeof(cam_trigger);
+    if(triggerCount > available)
+    {
+        Log(LogLevel::WARN, "trigger_map::Load( ): %s: header claims %zu triggers, but there is only room for %zu!", filename.c_str(), triggerCount, available);
+        err.set_error(load_result::TRUNCATED);
+        triggerCount = available;
+    }
+
+    result.reserve(triggerCount);
+    static_assert(std::is_trivially_copyable<cam_trigger>::value, "must be deserializable through memcpy");
+    for(std::size_t i = 0; i < triggerCount; ++i)
+    {
+        cam_trigger record;
+        std::memcpy(&record, buffer.data() + header.triggerOffset + i * sizeof(record), sizeof(record));
+
+        const glm::vec3 lo = Vector(record.min), hi = Vector(record.max);
+        result.push_back(trigger{aabb(glm::min(lo, hi), glm::max(lo, hi)), Vector(record.position), Vector(record.target), record.mode});
+    }
+
+    return result;
+}
@@ -0,0 +1,685 @@
+/** @file
+ *  Implementation of bvh.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/collision/bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+#include "SH3/system/assert.hpp"
+
+using namespace sh3::collision;
+
+constexpr std::uint32_t hit::noTriangle;
+constexpr std::size_t bvh::maxDepth;
+
+namespace {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    constexpr float epsilon = 1e-7f;
+
+    /** Number of bins the centroids are sorted into when looking for the best split. */
+    constexpr std::size_t sahBins = 16;
+    /** Leaves are not split further below this many triangles. */
+    constexpr std::uint32_t minLeafSize = 2;
+
+    /**
+     *  Component-wise reciprocal that avoids infinities.
+     */
+    glm::vec3 SafeInverse(const glm::vec3& v)
+    {
+        const auto inv = [](float f) { return 1.0f / (std::fabs(f) > 1e-20f ? f : std::copysign(1e-20f, f)); };
+        return glm::vec3(inv(v.x), inv(v.y), inv(v.z));
+    }
+
+    /**
+     *  Slab test of a ray against a box.
+     *
+     *  @returns The distance at which the ray enters the box, or infinity if it misses within @p maxT.
+     */
+    float RayBox(const glm::vec3& origin, const glm::vec3& invDir, float maxT, const glm::vec3& lo, const glm::vec3& hi)
+    {
+        const glm::vec3 t1 = (lo - origin) * invDir;
+        const glm::vec3 t2 = (hi - origin) * invDir;
+        const float tmin = std::max(std::max(std::min(t1.x, t2.x), std::min(t1.y, t2.y)), std::max(std::min(t1.z, t2.z), 0.0f));
+        const float tmax = std::min(std::min(std::max(t1.x, t2.x), std::max(t1.y, t2.y)), std::min(std::max(t1.z, t2.z), maxT));
+        return tmin <= tmax ? tmin : infinity;
+    }
+
+    /**
+     *  Möller-Trumbore ray/triangle intersection.
+     *
+     *  @returns The distance along @p dir, or infinity.
+     */
+    float RayTriangle(const glm::vec3& origin, const glm::vec3& dir, const triangle& tri)
+    {
+        const glm::vec3 e1 = tri.v1 - tri.v0;
+        const glm::vec3 e2 = tri.v2 - tri.v0;
+        const glm::vec3 p = glm::cross(dir, e2);
+        const float det = glm::dot(e1, p);
+        if(std::fabs(det) < epsilon)
+        {
+            return infinity;
+        }
+
+        const float invDet = 1.0f / det;
+        const glm::vec3 s = origin - tri.v0;
+        const float u = glm::dot(s, p) * invDet;
+        if(u < 0.0f || u > 1.0f)
+        {
+            return infinity;
+        }
+
+        const glm::vec3 q = glm::cross(s, e1);
+        const float v = glm::dot(dir, q) * invDet;
+        if(v < 0.0f || u + v > 1.0f)
+        {
+            return infinity;
+        }
+
+        const float t = glm::dot(e2, q) * invDet;
+        return t >= 0.0f ? t : infinity;
+    }
+
+    /**
+     *  Get the normal of a triangle, facing against a direction.
+     */
+    glm::vec3 FacingNormal(const triangle& tri, const glm::vec3& dir)
+    {
+        glm::vec3 normal = glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0);
+        const float length = glm::length(normal);
+        if(length < epsilon)
+        {
+            return -dir;
+        }
+        normal /= length;
+        return glm::dot(normal, dir) > 0.0f ? -normal : normal;
+    }
+
+    /**
+     *  Closest point on a triangle to a point (Ericson, Real-Time Collision Detection, 5.1.5).
+     */
+    glm::vec3 ClosestPointTriangle(const glm::vec3& p, const triangle& tri)
+    {
+        const glm::vec3& a = tri.v0;
+        const glm::vec3& b = tri.v1;
+        const glm::vec3& c = tri.v2;
+        const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+
+        const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+        if(d1 <= 0.0f && d2 <= 0.0f)
+        {
+            return a;
+        }
+
+        const glm::vec3 bp = p - b;
+        const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+        if(d3 >= 0.0f && d4 <= d3)
+        {
+            return b;
+        }
+
+        const float vc = d1 * d4 - d3 * d2;
+        if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            return a + ab * (d1 / (d1 - d3));
+        }
+
+        const glm::vec3 cp = p - c;
+        const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+        if(d6 >= 0.0f && d5 <= d6)
+        {
+            return c;
+        }
+
+        const float vb = d5 * d2 - d1 * d6;
+        if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        {
+            return a + ac * (d2 / (d2 - d6));
+        }
+
+        const float va = d3 * d6 - d5 * d4;
+        if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        {
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        const float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    /**
+     *  Closest points between two segments (Ericson, Real-Time Collision Detection, 5.1.9).
+     */
+    void ClosestPointsSegments(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2, glm::vec3& c1, glm::vec3& c2)
+    {
+        const glm::vec3 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+        const float a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+        float s, t;
+
+        if(a <= epsilon && e <= epsilon)
+        {
+            c1 = p1;
+            c2 = p2;
+            return;
+        }
+        if(a <= epsilon)
+        {
+            s = 0.0f;
+            t = glm::clamp(f / e, 0.0f, 1.0f);
+        }
+        else
+        {
+            const float c = glm::dot(d1, r);
+            if(e <= epsilon)
+            {
+                t = 0.0f;
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else
+            {
+                const float b = glm::dot(d1, d2);
+                const float denom = a * e - b * b;
+                s = denom > epsilon ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+                t = (b * s + f) / e;
+                if(t < 0.0f)
+                {
+                    t = 0.0f;
+                    s = glm::clamp(-c / a, 0.0f, 1.0f);
+                }
+                else if(t > 1.0f)
+                {
+                    t = 1.0f;
+                    s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+                }
+            }
+        }
+
+        c1 = p1 + d1 * s;
+        c2 = p2 + d2 * t;
+    }
+
+    /**
+     *  Closest points between a segment and a triangle.
+     *
+     *  If the segment does not pierce the triangle, the closest points are either an end of the segment
+     *  and the triangle, or the segment and one of the edges.
+     */
+    void ClosestPointsSegmentTriangle(const glm::vec3& a, const glm::vec3& b, const triangle& tri, glm::vec3& onSegment, glm::vec3& onTriangle)
+    {
+        const float t = RayTriangle(a, b - a, tri);
+        if(t <= 1.0f)
+        {
+            onSegment = onTriangle = a + (b - a) * t;
+            return;
+        }
+
+        float best = infinity;
+        const auto consider = [&](const glm::vec3& s, const glm::vec3& q)
+        {
+            const glm::vec3 delta = s - q;
+            const float distance = glm::dot(delta, delta);
+            if(distance < best)
+            {
+                best = distance;
+                onSegment = s;
+                onTriangle = q;
+            }
+        };
+
+        consider(a, ClosestPointTriangle(a, tri));
+        consider(b, ClosestPointTriangle(b, tri));
+
+        const std::array<std::pair<const glm::vec3*, const glm::vec3*>, 3> edges{{{&tri.v0, &tri.v1}, {&tri.v1, &tri.v2}, {&tri.v2, &tri.v0}}};
+        for(const auto& edge : edges)
+        {
+            glm::vec3 s, q;
+            ClosestPointsSegments(a, b, *edge.first, *edge.second, s, q);
+            consider(s, q);
+        }
+    }
+
+    /**
+     *  Ray against a sphere.
+     *
+     *  @returns The smallest non-negative distance along @p dir, or infinity.
+     */
+    float RaySphere(const glm::vec3& origin, const glm::vec3& dir, const glm::vec3& center, float radius)
+    {
+        const glm::vec3 oc = origin - center;
+        const float a = glm::dot(dir, dir);
+        const float b = glm::dot(dir, oc);
+        const float c = glm::dot(oc, oc) - radius * radius;
+        const float h = b * b - a * c;
+        if(h < 0.0f || a < epsilon)
+        {
+            return infinity;
+        }
+        const float t = (-b - std::sqrt(h)) / a;
+        return t >= 0.0f ? t : infinity;
+    }
+
+    /**
+     *  Ray against a capsule.
+     *
+     *  @returns The smallest non-negative distance along @p dir, or infinity.
+     */
+    float RayCapsule(const glm::vec3& origin, const glm::vec3& dir, const glm::vec3& pa, const glm::vec3& pb, float radius)
+    {
+        const glm::vec3 ba = pb - pa;
+        const glm::vec3 oa = origin - pa;
+        const float baba = glm::dot(ba, ba);
+        const float bard = glm::dot(ba, dir);
+        const float baoa = glm::dot(ba, oa);
+        const float rdrd = glm::dot(dir, dir);
+        const float rdoa = glm::dot(dir, oa);
+        const float oaoa = glm::dot(oa, oa);
+
+        // infinite cylinder around the axis
+        const float a = baba * rdrd - bard * bard;
+        const float b = baba * rdoa - baoa * bard;
+        const float c = baba * oaoa - baoa * baoa - radius * radius * baba;
+        const float h = b * b - a * c;
+        if(a > epsilon && h >= 0.0f)
+        {
+            const float t = (-b - std::sqrt(h)) / a;
+            const float y = baoa + t * bard;
+            if(t >= 0.0f && y > 0.0f && y < baba)
+            {
+                return t;
+            }
+        }
+
+        // caps
+        return std::min(RaySphere(origin, dir, pa, radius), RaySphere(origin, dir, pb, radius));
+    }
+
+    /**
+     *  Move a sphere against a triangle.
+     *
+     *  @param from   Start of the center.
+     *  @param delta  Movement of the center.
+     *  @param radius Radius of the sphere.
+     *  @param tri    The triangle.
+     *  @param[out] point The touched point on the triangle.
+     *
+     *  @returns The fraction of @p delta at which the sphere touches the triangle, or infinity.
+     */
+    float SweepSphereTriangle(const glm::vec3& from, const glm::vec3& delta, float radius, const triangle& tri, glm::vec3& point)
+    {
+        // already touching?
+        const glm::vec3 closest = ClosestPointTriangle(from, tri);
+        const glm::vec3 offset = from - closest;
+        if(glm::dot(offset, offset) <= radius * radius)
+        {
+            point = closest;
+            return 0.0f;
+        }
+
+        // face: the sphere first touches the plane of the triangle inside the triangle
+        const glm::vec3 normal = FacingNormal(tri, delta);
+        const float distance = glm::dot(normal, from - tri.v0);
+        const float approach = glm::dot(normal, delta);
+        if(distance > radius && approach < -epsilon)
+        {
+            const float t = (radius - distance) / approach;
+            if(t <= 1.0f)
+            {
+                const glm::vec3 touch = from + delta * t - normal * radius;
+                if(glm::distance(ClosestPointTriangle(touch, tri), touch) <= 1e-4f)
+                {
+                    point = touch;
+                    return t;
+                }
+            }
+        }
+
+        // edges and corners: the center hits a capsule around each edge
+        float best = infinity;
+        const std::array<std::pair<const glm::vec3*, const glm::vec3*>, 3> edges{{{&tri.v0, &tri.v1}, {&tri.v1, &tri.v2}, {&tri.v2, &tri.v0}}};
+        for(const auto& edge : edges)
+        {
+            const float t = RayCapsule(from, delta, *edge.first, *edge.second, radius);
+            if(t < best && t <= 1.0f)
+            {
+                best = t;
+                glm::vec3 onMove, onEdge;
+                const glm::vec3 center = from + delta * t;
+                ClosestPointsSegments(center, center, *edge.first, *edge.second, onMove, onEdge);
+                point = onEdge;
+            }
+        }
+        return best;
+    }
+}
+
+bvh::bvh(const std::vector<triangle>& source)
+    : nodes(), triangles(source), indices(source.size())
+{
+    ASSERT(source.size() < std::numeric_limits<std::uint32_t>::max());
+    if(source.empty())
+    {
+        return;
+    }
+
+    std::vector<glm::vec3> centroids;
+    centroids.reserve(triangles.size());
+    for(std::size_t i = 0; i < triangles.size(); ++i)
+    {
+        indices[i] = static_cast<std::uint32_t>(i);
+        centroids.push_back((triangles[i].v0 + triangles[i].v1 + triangles[i].v2) * (1.0f / 3.0f));
+    }
+
+    nodes.reserve(triangles.size() * 2);
+    nodes.push_back(node{glm::vec3(), 0, glm::vec3(), static_cast<std::uint32_t>(triangles.size())});
+    UpdateBounds(nodes.front());
+    Subdivide(0, 1, centroids);
+    nodes.shrink_to_fit();
+}
+
+void bvh::UpdateBounds(node& n) const
+{
+    aabb bounds;
+    for(std::uint32_t i = n.first; i < n.first + n.count; ++i)
+    {
+        bounds.Extend(triangles[i].v0);
+        bounds.Extend(triangles[i].v1);
+        bounds.Extend(triangles[i].v2);
+    }
+    n.min = bounds.min;
+    n.max = bounds.max;
+}
+
+void bvh::Subdivide(std::uint32_t index, std::size_t depth, std::vector<glm::vec3>& centroids)
+{
+    const std::uint32_t first = nodes[index].first;
+    const std::uint32_t count = nodes[index].count;
+    if(count <= minLeafSize || depth >= maxDepth)
+    {
+        return;
+    }
+
+    aabb centroidBounds;
+    for(std::uint32_t i = first; i < first + count; ++i)
+    {
+        centroidBounds.Extend(centroids[i]);
+    }
+
+    // binned SAH: find the axis and bin boundary with the lowest cost
+    struct bin final
+    {
+        aabb bounds = aabb();
+        std::uint32_t count = 0;
+    };
+
+    float bestCost = infinity;
+    int bestAxis = -1;
+    std::size_t bestSplit = 0;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        const float lo = centroidBounds.min[axis];
+        const float extent = centroidBounds.max[axis] - lo;
+        if(extent <= epsilon)
+        {
+            continue;
+        }
+
+        std::array<bin, sahBins> bins;
+        const float scale = static_cast<float>(sahBins) / extent;
+        for(std::uint32_t i = first; i < first + count; ++i)
+        {
+            const auto b = std::min(static_cast<std::size_t>((centroids[i][axis] - lo) * scale), sahBins - 1);
+            ++bins[b].count;
+            bins[b].bounds.Extend(triangles[i].v0);
+            bins[b].bounds.Extend(triangles[i].v1);
+            bins[b].bounds.Extend(triangles[i].v2);
+        }
+
+        std::array<float, sahBins - 1> leftCost;
+        aabb leftBounds;
+        std::uint32_t leftCount = 0;
+        for(std::size_t split = 0; split < sahBins - 1; ++split)
+        {
+            leftBounds.Extend(bins[split].bounds);
+            leftCount += bins[split].count;
+            leftCost[split] = static_cast<float>(leftCount) * leftBounds.SurfaceArea();
+        }
+
+        aabb rightBounds;
+        std::uint32_t rightCount = 0;
+        for(std::size_t split = sahBins - 1; split > 0; --split)
+        {
+            rightBounds.Extend(bins[split].bounds);
+            rightCount += bins[split].count;
+            const float cost = leftCost[split - 1] + static_cast<float>(rightCount) * rightBounds.SurfaceArea();
+            if(cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    const float leafCost = static_cast<float>(count) * aabb(nodes[index].min, nodes[index].max).SurfaceArea();
+    if(bestAxis < 0 || bestCost >= leafCost)
+    {
+        return;
+    }
+
+    // partition the triangles
+    const float lo = centroidBounds.min[bestAxis];
+    const float scale = static_cast<float>(sahBins) / (centroidBounds.max[bestAxis] - lo);
+    std::uint32_t i = first;
+    std::uint32_t j = first + count;
+    while(i < j)
+    {
+        const auto b = std::min(static_cast<std::size_t>((centroids[i][bestAxis] - lo) * scale), sahBins - 1);
+        if(b < bestSplit)
+        {
+            ++i;
+        }
+        else
+        {
+            --j;
+            std::swap(triangles[i], triangles[j]);
+            std::swap(centroids[i], centroids[j]);
+            std::swap(indices[i], indices[j]);
+        }
+    }
+
+    const std::uint32_t leftCount = i - first;
+    if(leftCount == 0 || leftCount == count)
+    {
+        return;
+    }
+
+    const auto left = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(node{glm::vec3(), first, glm::vec3(), leftCount});
+    nodes.push_back(node{glm::vec3(), i, glm::vec3(), count - leftCount});
+    UpdateBounds(nodes[left]);
+    UpdateBounds(nodes[left + 1]);
+    nodes[index].first = left;
+    nodes[index].count = 0;
+
+    Subdivide(left, depth + 1, centroids);
+    Subdivide(left + 1, depth + 1, centroids);
+}
+
+template<typename node_test, typename triangle_test>
+void bvh::Traverse(node_test&& enterNode, triangle_test&& visitTriangle) const
+{
+    if(nodes.empty() || !(enterNode(nodes.front()) < infinity))
+    {
+        return;
+    }
+
+    std::array<std::uint32_t, maxDepth> stack;
+    std::size_t top = 0;
+    std::uint32_t current = 0;
+    while(true)
+    {
+        const node& n = nodes[current];
+        if(n.count > 0)
+        {
+            for(std::uint32_t i = n.first; i < n.first + n.count; ++i)
+            {
+                if(!visitTriangle(i))
+                {
+                    return;
+                }
+            }
+        }
+        else
+        {
+            std::uint32_t nearChild = n.first, farChild = n.first + 1;
+            float nearDistance = enterNode(nodes[nearChild]);
+            float farDistance = enterNode(nodes[farChild]);
+            if(farDistance < nearDistance)
+            {
+                std::swap(nearChild, farChild);
+                std::swap(nearDistance, farDistance);
+            }
+            if(nearDistance < infinity)
+            {
+                if(farDistance < infinity)
+                {
+                    ASSERT_CHEAP(top < stack.size());
+                    stack[top++] = farChild;
+                }
+                current = nearChild;
+                continue;
+            }
+        }
+
+        // pop the next node that is still worth visiting
+        do
+        {
+            if(top == 0)
+            {
+                return;
+            }
+            current = stack[--top];
+        } while(!(enterNode(nodes[current]) < infinity));
+    }
+}
+
+hit bvh::Raycast(const ray& query) const
+{
+    hit result;
+    result.distance = query.maxDistance;
+    const glm::vec3 invDir = SafeInverse(query.direction);
+
+    Traverse([&](const node& n) { return RayBox(query.origin, invDir, result.distance, n.min, n.max); },
+             [&](std::uint32_t i)
+             {
+                 const float t = RayTriangle(query.origin, query.direction, triangles[i]);
+                 // a miss is infinity, which an unbounded ray would otherwise accept
+                 if(t < infinity && t <= result.distance)
+                 {
+                     result.distance = t;
+                     result.triangle = i;
+                 }
+                 return true;
+             });
+
+    if(result)
+    {
+        const triangle& tri = triangles[result.triangle];
+        result.point = query.origin + query.direction * result.distance;
+        result.normal = FacingNormal(tri, query.direction);
+        result.triangle = indices[result.triangle];
+    }
+    return result;
+}
+
+bool bvh::RaycastAny(const ray& query) const
+{
+    bool found = false;
+    const glm::vec3 invDir = SafeInverse(query.direction);
+
+    Traverse([&](const node& n) { return RayBox(query.origin, invDir, query.maxDistance, n.min, n.max); },
+             [&](std::uint32_t i)
+             {
+                 const float t = RayTriangle(query.origin, query.direction, triangles[i]);
+                 found = t < infinity && t <= query.maxDistance;
+                 return !found;
+             });
+    return found;
+}
+
+void bvh::Raycast(const ray* queries, hit* hits, std::size_t count) const
+{
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        hits[i] = Raycast(queries[i]);
+    }
+}
+
+hit bvh::SphereSweep(const glm::vec3& from, const glm::vec3& to, float radius) const
+{
+    hit result;
+    result.distance = 1.0f;
+    const glm::vec3 delta = to - from;
+    const glm::vec3 invDir = SafeInverse(delta);
+    const glm::vec3 grow(radius);
+
+    Traverse([&](const node& n) { return RayBox(from, invDir, result.distance, n.min - grow, n.max + grow); },
+             [&](std::uint32_t i)
+             {
+                 glm::vec3 point;
+                 const float t = SweepSphereTriangle(from, delta, radius, triangles[i], point);
+                 if(t <= result.distance && (t < result.distance || !result))
+                 {
+                     result.distance = t;
+                     result.triangle = i;
+                     result.point = point;
+                 }
+                 return result.distance > 0.0f || !result;
+             });
+
+    if(result)
+    {
+        const glm::vec3 center = from + delta * result.distance;
+        const glm::vec3 away = center - result.point;
+        const float length = glm::length(away);
+        result.normal = length > epsilon ? away / length : FacingNormal(triangles[result.triangle], delta);
+        result.triangle = indices[result.triangle];
+    }
+    return result;
+}
+
+void bvh::SphereSweep(const glm::vec3* from, const glm::vec3* to, float radius, hit* hits, std::size_t count) const
+{
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        hits[i] = SphereSweep(from[i], to[i], radius);
+    }
+}
+
+std::size_t bvh::OverlapCapsule(const glm::vec3& a, const glm::vec3& b, float radius, std::vector<contact>& contacts) const
+{
+    const std::size_t before = contacts.size();
+    const aabb bounds(glm::min(a, b) - glm::vec3(radius), glm::max(a, b) + glm::vec3(radius));
+
+    Traverse([&](const node& n) { return bounds.Intersects(aabb(n.min, n.max)) ? 0.0f : infinity; },
+             [&](std::uint32_t i)
+             {
+                 const triangle& tri = triangles[i];
+                 glm::vec3 onAxis, onTriangle;
+                 ClosestPointsSegmentTriangle(a, b, tri, onAxis, onTriangle);
+                 const glm::vec3 away = onAxis - onTriangle;
+                 const float distance = glm::length(away);
+                 if(distance <= radius)
+                 {
+                     const glm::vec3 normal = distance > epsilon ? away / distance : FacingNormal(tri, b - a);
+                     contacts.push_back(contact{indices[i], onTriangle, normal, radius - distance});
+                 }
+                 return true;
+             });
+
+    return contacts.size() - before;
+}
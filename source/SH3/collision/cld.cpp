@@ -0,0 +1,118 @@
+/** @file
+ *  Implementation of cld.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/collision/cld.hpp"
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "SH3/arc/mft.hpp"
+#include "SH3/arc/subarc.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::collision;
+
+namespace {
+    /**
+     *  Get a corner of a face.
+     */
+    glm::vec3 Corner(const cld_face& face, std::size_t corner)
+    {
+        return glm::vec3(face.vertices[corner][0], face.vertices[corner][1], face.vertices[corner][2]);
+    }
+}
+
+std::string collision_mesh::load_error::message() const
+{
+    std::string error;
+    switch(result)
+    {
+    case load_result::SUCCESS:
+        error = "Success";
+        break;
+    case load_result::FILE_NOT_FOUND:
+        error = "File not found";
+        break;
+    case load_result::BAD_HEADER:
+        error = "Bad header";
+        break;
+    case load_result::TRUNCATED:
+        error = "Truncated file";
+        break;
+    }
+    return error;
+}
+
+collision_mesh::collision_mesh(arc::mft& mft, const std::string& filename, load_error& err)
+    : attributes(), triangles(Load(mft, filename, err)), hierarchy(triangles)
+{
+}
+
+collision_mesh::collision_mesh(std::vector<triangle> tris)
+    : attributes(tris.size(), 0), triangles(std::move(tris)), hierarchy(triangles)
+{
+}
+
+std::vector<triangle> collision_mesh::Load(arc::mft& mft, const std::string& filename, load_error& err)
+{
+    std::vector<triangle> result;
+    std::vector<std::uint8_t> buffer;
+
+    const int size = mft.LoadFile(filename, buffer);
+    if(size == arc::arcFileNotFound)
+    {
+        Log(LogLevel::ERROR, "collision_mesh::Load( ): Unable to find %s!", filename.c_str());
+        err.set_error(load_result::FILE_NOT_FOUND);
+        return result;
+    }
+
+    cld_header header;
+    static_assert(std::is_trivially_copyable<cld_header>::value, "must be deserializable through memcpy");
+    if(buffer.size() < sizeof(header))
+    {
+        err.set_error(load_result::BAD_HEADER);
+        return result;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+
+    if(header.faceOffset < sizeof(header) || header.faceOffset > buffer.size())
+    {
+        Log(LogLevel::ERROR, "collision_mesh::Load( ): %s: face offset 0x%x is out of range!", filename.c_str(), header.faceOffset);
+        err.set_error(load_result::BAD_HEADER);
+        return result;
+    }
+
+    std::size_t faceCount = header.faceCount;
+    const std::size_t available = (buffer.size() - header.faceOffset) / sizeof(cld_face);
+    if(faceCount > available)
+    {
+        Log(LogLevel::WARN, "collision_mesh::Load( ): %s: header claims %zu faces, but there is only room for %zu!", filename.c_str(), faceCount, available);
+        err.set_error(load_result::TRUNCATED);
+        faceCount = available;
+    }
+
+    result.reserve(faceCount * 2);
+    attributes.reserve(faceCount * 2);
+    static_assert(std::is_trivially_copyable<cld_face>::value, "must be deserializable through memcpy");
+    for(std::size_t i = 0; i < faceCount; ++i)
+    {
+        cld_face face;
+        std::memcpy(&face, buffer.data() + header.faceOffset + i * sizeof(face), sizeof(face));
+
+        const glm::vec3 a = Corner(face, 0), b = Corner(face, 1), c = Corner(face, 2), d = Corner(face, 3);
+        result.push_back(triangle{a, b, c});
+        attributes.push_back(face.attributes);
+
+        // quads are split along the a-c diagonal
+        if(d != c)
+        {
+            result.push_back(triangle{a, c, d});
+            attributes.push_back(face.attributes);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,36 @@
+/** @file
+ *  Implementation of async_texture.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/graphics/async_texture.hpp"
+
+using namespace sh3_graphics;
+
+image_task sh3_graphics::DecodeTextureAsync(sh3::arc::async_mft& files, const std::string& filename)
+{
+    return files.Open(filename)
+        .Then(files.GetJobs(), [](const std::shared_ptr<sh3::arc::vfile>& file)
+        {
+            auto image = std::make_shared<texture_image>();
+            if(!sh3_texture::Decode(*file, *image))
+            {
+                image.reset();
+            }
+            return image;
+        });
+}
+
+texture_task sh3_graphics::LoadTextureAsync(sh3::arc::async_mft& files, sh3::system::main_thread_queue& mainQueue, const std::string& filename)
+{
+    return DecodeTextureAsync(files, filename)
+        .Then(mainQueue, [](const std::shared_ptr<texture_image>& image)
+        {
+            auto texture = std::make_shared<sh3_texture>();
+            if(image)
+            {
+                texture->Upload(*image);
+            }
+            return texture;
+        });
+}
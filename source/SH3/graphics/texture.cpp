@@ -10,6 +10,8 @@
  */
 #include <SH3/graphics/texture.hpp>
 #include <SH3/system/assert.hpp>
+#include <SH3/system/glcontext.hpp>
+#include <SH3/system/linear_allocator.hpp>
 #include <SH3/system/log.hpp>
 #include <SH3/arc/mft.hpp>
 #include <SH3/arc/vfile.hpp>
@@ -74,6 +76,14 @@ struct tga_header
 
 namespace
 {
+/**
+ *  Whether @ref DumpRGB2Bitmap writes anything, for debugging the decoder.
+ *
+ *  Off by default: every decode would overwrite the same file, from whichever worker is decoding, and the write
+ *  costs more than the decode.
+ */
+constexpr bool dumpTextures = false;
+
 /**
  *  Dump a texture to a TARGA/TGA file
  *
@@ -84,6 +94,11 @@ namespace
  */
 void DumpRGB2Bitmap(std::uint32_t width, std::uint32_t height, std::vector<std::uint8_t>& data, std::uint8_t bpp)
 {
+    if(!dumpTextures)
+    {
+        return;
+    }
+
     tga_header header;
     std::ofstream file("output.tga", std::ios::binary); // Open the stream for binary output
 
@@ -116,13 +131,33 @@ void DumpRGB2Bitmap(std::uint32_t width, std::uint32_t height, std::vector<std::
 }
 
 
+sh3_texture::~sh3_texture()
+{
+    if(tex != 0)
+    {
+        glDeleteTextures(1, &tex);
+    }
+}
+
 //TODO: Scale the texture and then
 void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
 {
+    sh3::arc::vfile file(mft, filename);
+    texture_image   image;
+
+    if(Decode(file, image))
+    {
+        Upload(image);
+    }
+}
+
+bool sh3_texture::Decode(sh3::arc::vfile& file, texture_image& image)
+{
+    sh3::system::transient_scope scope;     // Temporaries below are released on return
+
     sh3_texture_header          header;
-    sh3::arc::vfile             file(mft, filename);
     sh3::arc::vfile::read_error e;
-    std::vector<std::uint8_t>   data;       // Pixel data of this texture (with the header stripped)
+    std::vector<std::uint8_t>&  data = image.pixels; // Pixel data of this texture (with the header stripped)
 
     std::streamsize             offset = 0;
 
@@ -152,7 +187,7 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
     if(header.texSize != static_cast<decltype(header.texSize)>(header.texWidth * header.texHeight * header.bpp) / 8u)
     {
         Log(LogLevel::WARN, "sh3_texture::Load( ): Warning, texSize != width * height * (bpp / 8)!");
-        return; // TODO: Bind a color shader here
+        return false; // TODO: Bind a color shader here
     }
 
     data.resize(header.texSize); // Early data resize (if it's an 8bpp texture, it will be resized anyway)
@@ -160,7 +195,7 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
     if(header.bpp == PixelFormat::PALETTE)
     {
         palette_info         pal_header;
-        std::vector<rgba>    palette;    // Palette Data (I think this is BGRA)
+        sh3::system::transient_vector<rgba> palette; // Palette Data (I think this is BGRA)
 
         // First, we need to seek to the palette and read it in.
         file.Seek(offset + header.batchHeaderSize + header.texFileSize, std::ios_base::beg);
@@ -216,7 +251,7 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
         // from the data section of the file and get it's color in the palette!
 
         //===---THIS IS A CLUSTER FUCK FOR NOW UNTIL WE UNDERSTAND HOW IN THE NAME OF CHRIST THIS WORKS---===//
-        std::vector<std::uint8_t> iBuffer;  // Our index buffer that we put transformed indecies into
+        sh3::system::transient_vector<std::uint8_t> iBuffer;  // Our index buffer that we put transformed indecies into
 
         data.resize(static_cast<std::size_t>(header.texWidth * header.texHeight) * 3u); // We strip the Alpha channel from the BGRA pixel beacuse it is hard locked to 0x80 (not 0xFF!!)
         iBuffer.resize(header.texSize);
@@ -265,7 +300,9 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
                     // every other pixel is for (y + 2)
                     const auto tempy = y + ((i % 2u) ? 2u : 0u);
 
-                    iBuffer[(header.texWidth * tempy) + tempx % header.texWidth] = index;
+                    const std::size_t position = (header.texWidth * tempy) + tempx % header.texWidth;
+                    ASSERT_EXPENSIVE(position < iBuffer.size());
+                    iBuffer[position] = index;
                 }
 
                 x += 16;
@@ -302,6 +339,7 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
             // Christ help me...
             for(std::size_t pindex = 0, doff = 0; pindex < iBuffer.size() && doff < data.size(); pindex++, doff += 3)
             {
+                ASSERT_EXPENSIVE(iBuffer[pindex] < palette.size());
                 rgba pixel = palette[iBuffer[pindex]];
 
                 data[doff + 0]  = pixel.r;
@@ -315,6 +353,7 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
             {
                 std::uint8_t index;
                 file.ReadData(&index, sizeof(index), e);
+                ASSERT_EXPENSIVE(index < palette.size());
                 rgba pixel = palette[index];
 
                 data[i + 0]   = pixel.r;
@@ -347,41 +386,75 @@ void sh3_texture::Load(sh3::arc::mft& mft, const std::string& filename)
     }
 
 
-    glGenTextures(1, &tex);             // Create a texture
-    glBindTexture(GL_TEXTURE_2D, tex);  // Bind it for use
-
-    GLenum srcFormat;
-    GLint dstFormat;
-    GLenum type;
+    image.width = header.texWidth;
+    image.height = header.texHeight;
+    image.charge.Set(data.capacity());
 
-    // Create the texture according to its pixel format!
+    // Describe the texture according to its pixel format!
     switch(header.bpp)
     {
         case PixelFormat::RGBA:     // Regular 32-bit RGBA
-            srcFormat = GL_RGBA;
-            dstFormat = GL_RGBA;
-            type = GL_UNSIGNED_BYTE;
+            image.srcFormat = GL_RGBA;
+            image.dstFormat = GL_RGBA;
+            image.type = GL_UNSIGNED_BYTE;
             break;
         case PixelFormat::BGR:      // 24-bit BGR
-            srcFormat = GL_BGR;
-            dstFormat = GL_RGB;
-            type = GL_UNSIGNED_BYTE;
+            image.srcFormat = GL_BGR;
+            image.dstFormat = GL_RGB;
+            image.type = GL_UNSIGNED_BYTE;
             break;
         case PixelFormat::RGBA16:   // 16-bit RGBA. OpenGL supports this (I think)
-            srcFormat = GL_RGBA;
-            dstFormat = GL_RGBA;
-            type = GL_UNSIGNED_SHORT_5_5_5_1;
+            image.srcFormat = GL_RGBA;
+            image.dstFormat = GL_RGBA;
+            image.type = GL_UNSIGNED_SHORT_5_5_5_1;
             break;
         case PixelFormat::PALETTE:
-            srcFormat = GL_RGB;
-            dstFormat = GL_RGB;
-            type = GL_UNSIGNED_BYTE;
+            image.srcFormat = GL_RGB;
+            image.dstFormat = GL_RGB;
+            image.type = GL_UNSIGNED_BYTE;
             break;
         default:
             die("sh3_texture::Load( ): Invalid pixel format: %d", header.bpp);
     }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, dstFormat, header.texWidth, header.texHeight, 0, srcFormat, type, data.data());
+    return true;
+}
+
+void sh3_texture::Upload(const texture_image& image)
+{
+    if(sh3_gl::HasDirectStateAccess())
+    {
+        // immutable storage needs a sized format
+        GLenum storageFormat = static_cast<GLenum>(image.dstFormat);
+        if(storageFormat == GL_RGB)
+            storageFormat = GL_RGB8;
+        else if(storageFormat == GL_RGBA)
+            storageFormat = GL_RGBA8;
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+        glTextureStorage2D(tex, 1, storageFormat, image.width, image.height);
+        glTextureSubImage2D(tex, 0, 0, 0, image.width, image.height, image.srcFormat, image.type, image.pixels.data());
+
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+    else
+    {
+        UploadBound(image);
+    }
+
+    // Drivers usually pad RGB to four bytes per texel, so estimate that for every format
+    charge.Set(static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height) * 4u);
+}
+
+void sh3_texture::UploadBound(const texture_image& image)
+{
+    glGenTextures(1, &tex);             // Create a texture
+    glBindTexture(GL_TEXTURE_2D, tex);  // Bind it for use
+
+    glTexImage2D(GL_TEXTURE_2D, 0, image.dstFormat, image.width, image.height, 0, image.srcFormat, image.type, image.pixels.data());
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -395,6 +468,12 @@ void sh3_texture::Bind(GLenum textureUnit)
 {
     ASSERT(textureUnit >= GL_TEXTURE0 && textureUnit <= GL_TEXTURE31);
 
+    if(sh3_gl::HasDirectStateAccess())
+    {
+        glBindTextureUnit(textureUnit - GL_TEXTURE0, tex);
+        return;
+    }
+
     glActiveTexture(textureUnit);
     glBindTexture(GL_TEXTURE_2D, tex);
 }
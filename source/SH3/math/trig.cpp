@@ -0,0 +1,365 @@
+/** @file
+ *  Implementation of trig.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/math/trig.hpp"
+#include "SH3/system/cpu_features.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SH3_MATH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(SH3_MATH_SSE2) && defined(SH3_X86)
+#define SH3_MATH_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace sh3::math;
+using sh3::system::GetSimdLevel;
+using sh3::system::simd_level;
+
+namespace {
+#ifdef SH3_MATH_SSE2
+    constexpr std::size_t width = 4; /**< Number of floats in an SSE register. */
+
+    /**
+     *  Select @p a where @p mask is set, @p b elsewhere.
+     */
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    /**
+     *  Vector version of @ref detail::Reduce.
+     */
+    inline __m128 Reduce(__m128 x, __m128i& quadrant)
+    {
+        // floor(x * 2/pi + 0.5), SSE2 only truncates
+        const __m128 v = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(detail::twoOverPi)), _mm_set1_ps(0.5f));
+        __m128i ki = _mm_cvttps_epi32(v);
+        __m128 k = _mm_cvtepi32_ps(ki);
+        const __m128 tooLarge = _mm_cmpgt_ps(k, v);
+        ki = _mm_add_epi32(ki, _mm_castps_si128(tooLarge)); // -1 where truncation rounded up
+        k = _mm_sub_ps(k, _mm_and_ps(tooLarge, _mm_set1_ps(1.0f)));
+        quadrant = ki;
+
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(detail::halfPiA)));
+        r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(detail::halfPiB)));
+        return _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(detail::halfPiC)));
+    }
+
+    /**
+     *  Vector version of @ref detail::SinPoly.
+     */
+    inline __m128 SinPoly(__m128 x)
+    {
+        const __m128 z = _mm_mul_ps(x, x);
+        __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), z), _mm_set1_ps(8.3321608736e-3f));
+        p = _mm_sub_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.6666654611e-1f));
+        return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, z), p));
+    }
+
+    /**
+     *  Vector version of @ref detail::CosPoly.
+     */
+    inline __m128 CosPoly(__m128 x)
+    {
+        const __m128 z = _mm_mul_ps(x, x);
+        __m128 p = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), z), _mm_set1_ps(1.388731625493765e-3f));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(4.166664568298827e-2f));
+        const __m128 head = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), z));
+        return _mm_add_ps(head, _mm_mul_ps(_mm_mul_ps(z, z), p));
+    }
+
+    /**
+     *  Vector version of @ref sh3::math::SinCos.
+     */
+    inline void SinCos4(__m128 x, __m128& sine, __m128& cosine)
+    {
+        __m128i quadrant;
+        const __m128 r = Reduce(x, quadrant);
+        const __m128 s = SinPoly(r);
+        const __m128 c = CosPoly(r);
+
+        const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        // move bit 1 of the quadrant into the sign bit
+        const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+        sine = _mm_xor_ps(Select(swap, c, s), sineSign);
+        cosine = _mm_xor_ps(Select(swap, s, c), cosineSign);
+    }
+
+    /**
+     *  Vector version of @ref sh3::math::Atan2.
+     */
+    inline __m128 Atan24(__m128 y, __m128 x)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 ax = _mm_andnot_ps(signMask, x), ay = _mm_andnot_ps(signMask, y);
+        const __m128 steep = _mm_cmpgt_ps(ay, ax);
+        const __m128 num = _mm_min_ps(ax, ay);
+        const __m128 den = _mm_max_ps(ax, ay);
+        const __m128 valid = _mm_cmpgt_ps(den, _mm_setzero_ps());
+
+        // detail::AtanPoly without branches
+        __m128 t = _mm_div_ps(num, _mm_max_ps(den, _mm_set1_ps(1e-30f)));
+        const __m128 reduce = _mm_cmpgt_ps(t, _mm_set1_ps(detail::tanEighthPi));
+        const __m128 one = _mm_set1_ps(1.0f);
+        t = Select(reduce, _mm_div_ps(_mm_sub_ps(t, one), _mm_add_ps(t, one)), t);
+        const __m128 offset = _mm_and_ps(reduce, _mm_set1_ps(detail::quarterPi));
+        const __m128 z = _mm_mul_ps(t, t);
+        __m128 p = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(8.05374449538e-2f), z), _mm_set1_ps(1.38776856032e-1f));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.99777106478e-1f));
+        p = _mm_sub_ps(_mm_mul_ps(p, z), _mm_set1_ps(3.33329491539e-1f));
+        __m128 result = _mm_add_ps(offset, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, z), t), t));
+        result = _mm_and_ps(valid, result);
+
+        result = Select(steep, _mm_sub_ps(_mm_set1_ps(detail::halfPi), result), result);
+        result = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(detail::pi), result), result);
+        return _mm_or_ps(result, _mm_and_ps(y, signMask));
+    }
+#endif
+
+#ifdef SH3_MATH_AVX2
+    constexpr std::size_t avxWidth = 8; /**< Number of floats in an AVX register. */
+
+    /**
+     *  AVX version of @ref Select.
+     */
+    SH3_TARGET("avx2") inline __m256 Select(__m256 mask, __m256 a, __m256 b)
+    {
+        return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b));
+    }
+
+    /**
+     *  AVX2 version of @ref detail::Reduce.
+     */
+    SH3_TARGET("avx2") inline __m256 Reduce(__m256 x, __m256i& quadrant)
+    {
+        const __m256 v = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(detail::twoOverPi)), _mm256_set1_ps(0.5f));
+        __m256i ki = _mm256_cvttps_epi32(v);
+        __m256 k = _mm256_cvtepi32_ps(ki);
+        const __m256 tooLarge = _mm256_cmp_ps(k, v, _CMP_GT_OQ);
+        ki = _mm256_add_epi32(ki, _mm256_castps_si256(tooLarge)); // -1 where truncation rounded up
+        k = _mm256_sub_ps(k, _mm256_and_ps(tooLarge, _mm256_set1_ps(1.0f)));
+        quadrant = ki;
+
+        __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(detail::halfPiA)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(detail::halfPiB)));
+        return _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(detail::halfPiC)));
+    }
+
+    /**
+     *  AVX version of @ref detail::SinPoly. Doesn't use FMA, to round exactly like the scalar version.
+     */
+    SH3_TARGET("avx2") inline __m256 SinPoly(__m256 x)
+    {
+        const __m256 z = _mm256_mul_ps(x, x);
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-1.9515295891e-4f), z), _mm256_set1_ps(8.3321608736e-3f));
+        p = _mm256_sub_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(1.6666654611e-1f));
+        return _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(x, z), p));
+    }
+
+    /**
+     *  AVX version of @ref detail::CosPoly.
+     */
+    SH3_TARGET("avx2") inline __m256 CosPoly(__m256 x)
+    {
+        const __m256 z = _mm256_mul_ps(x, x);
+        __m256 p = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.443315711809948e-5f), z), _mm256_set1_ps(1.388731625493765e-3f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(4.166664568298827e-2f));
+        const __m256 head = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), z));
+        return _mm256_add_ps(head, _mm256_mul_ps(_mm256_mul_ps(z, z), p));
+    }
+
+    /**
+     *  AVX2 version of @ref SinCos4.
+     */
+    SH3_TARGET("avx2") inline void SinCos8(__m256 x, __m256& sine, __m256& cosine)
+    {
+        __m256i quadrant;
+        const __m256 r = Reduce(x, quadrant);
+        const __m256 s = SinPoly(r);
+        const __m256 c = CosPoly(r);
+
+        const __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+        const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+        const __m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+        const __m256 cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+
+        sine = _mm256_xor_ps(Select(swap, c, s), sineSign);
+        cosine = _mm256_xor_ps(Select(swap, s, c), cosineSign);
+    }
+
+    /**
+     *  AVX version of @ref Atan24.
+     */
+    SH3_TARGET("avx2") inline __m256 Atan28(__m256 y, __m256 x)
+    {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        const __m256 ax = _mm256_andnot_ps(signMask, x), ay = _mm256_andnot_ps(signMask, y);
+        const __m256 steep = _mm256_cmp_ps(ay, ax, _CMP_GT_OQ);
+        const __m256 num = _mm256_min_ps(ax, ay);
+        const __m256 den = _mm256_max_ps(ax, ay);
+        const __m256 valid = _mm256_cmp_ps(den, _mm256_setzero_ps(), _CMP_GT_OQ);
+
+        __m256 t = _mm256_div_ps(num, _mm256_max_ps(den, _mm256_set1_ps(1e-30f)));
+        const __m256 reduce = _mm256_cmp_ps(t, _mm256_set1_ps(detail::tanEighthPi), _CMP_GT_OQ);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        t = Select(reduce, _mm256_div_ps(_mm256_sub_ps(t, one), _mm256_add_ps(t, one)), t);
+        const __m256 offset = _mm256_and_ps(reduce, _mm256_set1_ps(detail::quarterPi));
+        const __m256 z = _mm256_mul_ps(t, t);
+        __m256 p = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(8.05374449538e-2f), z), _mm256_set1_ps(1.38776856032e-1f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(1.99777106478e-1f));
+        p = _mm256_sub_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(3.33329491539e-1f));
+        __m256 result = _mm256_add_ps(offset, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(p, z), t), t));
+        result = _mm256_and_ps(valid, result);
+
+        result = Select(steep, _mm256_sub_ps(_mm256_set1_ps(detail::halfPi), result), result);
+        result = Select(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_sub_ps(_mm256_set1_ps(detail::pi), result), result);
+        return _mm256_or_ps(result, _mm256_and_ps(y, signMask));
+    }
+
+    /**
+     *  The AVX2 kernel of the batch sine and cosine functions.
+     *
+     *  @param sines   Receives the sines, or @c nullptr.
+     *  @param cosines Receives the cosines, or @c nullptr.
+     *
+     *  @returns The number of angles processed, a multiple of @ref avxWidth.
+     */
+    SH3_TARGET("avx2") std::size_t SinCosAvx2(const float* angles, float* sines, float* cosines, std::size_t count)
+    {
+        std::size_t i = 0;
+        for(; i + avxWidth <= count; i += avxWidth)
+        {
+            __m256 s, c;
+            SinCos8(_mm256_loadu_ps(angles + i), s, c);
+            if(sines)
+            {
+                _mm256_storeu_ps(sines + i, s);
+            }
+            if(cosines)
+            {
+                _mm256_storeu_ps(cosines + i, c);
+            }
+        }
+        return i;
+    }
+
+    /**
+     *  The AVX2 kernel of the batch @ref sh3::math::Atan2.
+     *
+     *  @returns The number of vectors processed, a multiple of @ref avxWidth.
+     */
+    SH3_TARGET("avx2") std::size_t Atan2Avx2(const float* y, const float* x, float* angles, std::size_t count)
+    {
+        std::size_t i = 0;
+        for(; i + avxWidth <= count; i += avxWidth)
+        {
+            _mm256_storeu_ps(angles + i, Atan28(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+        }
+        return i;
+    }
+#endif
+}
+
+void sh3::math::SinCos(const float* angles, float* sines, float* cosines, std::size_t count)
+{
+    const simd_level level = GetSimdLevel();
+    std::size_t i = 0;
+#ifdef SH3_MATH_AVX2
+    if(level >= simd_level::AVX2)
+    {
+        i = SinCosAvx2(angles, sines, cosines, count);
+    }
+#endif
+#ifdef SH3_MATH_SSE2
+    for(; level >= simd_level::SSE2 && i + width <= count; i += width)
+    {
+        __m128 s, c;
+        SinCos4(_mm_loadu_ps(angles + i), s, c);
+        _mm_storeu_ps(sines + i, s);
+        _mm_storeu_ps(cosines + i, c);
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        SinCos(angles[i], sines[i], cosines[i]);
+    }
+}
+
+void sh3::math::Sin(const float* angles, float* sines, std::size_t count)
+{
+    const simd_level level = GetSimdLevel();
+    std::size_t i = 0;
+#ifdef SH3_MATH_AVX2
+    if(level >= simd_level::AVX2)
+    {
+        i = SinCosAvx2(angles, sines, nullptr, count);
+    }
+#endif
+#ifdef SH3_MATH_SSE2
+    for(; level >= simd_level::SSE2 && i + width <= count; i += width)
+    {
+        __m128 s, c;
+        SinCos4(_mm_loadu_ps(angles + i), s, c);
+        _mm_storeu_ps(sines + i, s);
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        sines[i] = Sin(angles[i]);
+    }
+}
+
+void sh3::math::Cos(const float* angles, float* cosines, std::size_t count)
+{
+    const simd_level level = GetSimdLevel();
+    std::size_t i = 0;
+#ifdef SH3_MATH_AVX2
+    if(level >= simd_level::AVX2)
+    {
+        i = SinCosAvx2(angles, nullptr, cosines, count);
+    }
+#endif
+#ifdef SH3_MATH_SSE2
+    for(; level >= simd_level::SSE2 && i + width <= count; i += width)
+    {
+        __m128 s, c;
+        SinCos4(_mm_loadu_ps(angles + i), s, c);
+        _mm_storeu_ps(cosines + i, c);
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        cosines[i] = Cos(angles[i]);
+    }
+}
+
+void sh3::math::Atan2(const float* y, const float* x, float* angles, std::size_t count)
+{
+    const simd_level level = GetSimdLevel();
+    std::size_t i = 0;
+#ifdef SH3_MATH_AVX2
+    if(level >= simd_level::AVX2)
+    {
+        i = Atan2Avx2(y, x, angles, count);
+    }
+#endif
+#ifdef SH3_MATH_SSE2
+    for(; level >= simd_level::SSE2 && i + width <= count; i += width)
+    {
+        _mm_storeu_ps(angles + i, Atan24(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        angles[i] = Atan2(y[i], x[i]);
+    }
+}
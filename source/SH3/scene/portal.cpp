@@ -0,0 +1,457 @@
+/** @file
+ *  Implementation of portal.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/scene/portal.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "SH3/camera/camera.hpp"
+#include "SH3/system/assert.hpp"
+
+using namespace sh3::scene;
+using sh3::camera::frustum;
+
+constexpr portal_graph::cell_index portal_graph::noCell;
+constexpr portal_graph::portal_index portal_graph::noPortal;
+
+namespace {
+    /** Portal chains longer than this are not followed. */
+    constexpr std::size_t maxPortalDepth = 32;
+
+    /** If the viewer is closer than this to a portal, it is considered to be standing in it. */
+    constexpr float portalEpsilon = 1e-3f;
+
+    using polygon_buffer = boost::container::small_vector<glm::vec3, 16>;
+    using plane_buffer = boost::container::small_vector<glm::vec4, 32>;
+    using cell_path = boost::container::small_vector<portal_graph::cell_index, 16>; // portal_graph::cell_path is private
+
+    /**
+     *  Clip a convex polygon against a plane (Sutherland-Hodgman).
+     *
+     *  @param in    The polygon to clip.
+     *  @param plane The plane; the part on the inside is kept.
+     *  @param[out] out The clipped polygon.
+     */
+    void ClipPolygon(const polygon_buffer& in, const glm::vec4& plane, polygon_buffer& out)
+    {
+        out.clear();
+        for(std::size_t i = 0; i < in.size(); ++i)
+        {
+            const glm::vec3& a = in[i];
+            const glm::vec3& b = in[(i + 1) % in.size()];
+            const float da = frustum::Distance(plane, a);
+            const float db = frustum::Distance(plane, b);
+
+            if(da >= 0.0f)
+            {
+                out.push_back(a);
+            }
+            if((da >= 0.0f) != (db >= 0.0f))
+            {
+                out.push_back(a + (b - a) * (da / (da - db)));
+            }
+        }
+    }
+
+    /**
+     *  Compute the plane of a polygon with Newell's method.
+     */
+    glm::vec4 PolygonPlane(const std::vector<glm::vec3>& polygon)
+    {
+        glm::vec3 normal(0.0f);
+        glm::vec3 centroid(0.0f);
+        for(std::size_t i = 0; i < polygon.size(); ++i)
+        {
+            const glm::vec3& a = polygon[i];
+            const glm::vec3& b = polygon[(i + 1) % polygon.size()];
+            normal.x += (a.y - b.y) * (a.z + b.z);
+            normal.y += (a.z - b.z) * (a.x + b.x);
+            normal.z += (a.x - b.x) * (a.y + b.y);
+            centroid += a;
+        }
+        normal = glm::normalize(normal);
+        centroid /= static_cast<float>(polygon.size());
+        return glm::vec4(normal, -glm::dot(normal, centroid));
+    }
+
+    /**
+     *  Get the plane of a portal, facing into one of its cells.
+     */
+    glm::vec4 PlaneInto(const portal_graph::portal& through, portal_graph::cell_index cell)
+    {
+        return through.cells[1] == cell ? through.plane : -through.plane;
+    }
+
+    /**
+     *  Check whether a cell was already seen through a portal with a frustum containing the visible part of it.
+     *
+     *  @param visible The cells found so far.
+     *  @param cell    The cell behind the portal.
+     *  @param portal  The portal.
+     *  @param clipped The part of @p portal that is visible now.
+     */
+    bool IsCovered(const portal_graph::visible_set& visible, portal_graph::cell_index cell, portal_graph::portal_index portal, const polygon_buffer& clipped)
+    {
+        for(const portal_graph::visible_cell& entry : visible.entries)
+        {
+            if(entry.cell != cell || entry.portal != portal)
+            {
+                continue;
+            }
+
+            const bool inside = std::all_of(clipped.begin(), clipped.end(), [&entry](const glm::vec3& point)
+            {
+                return std::all_of(entry.view.planes.begin(), entry.view.planes.end(), [&point](const glm::vec4& plane) { return frustum::Distance(plane, point) >= -portalEpsilon; });
+            });
+            if(inside)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     *  Check whether a plane has one polygon on its inside and another on its outside.
+     */
+    bool Separates(const glm::vec4& plane, const polygon_buffer& from, const polygon_buffer& to)
+    {
+        return std::all_of(from.begin(), from.end(), [&plane](const glm::vec3& point) { return frustum::Distance(plane, point) <= portalEpsilon; })
+            && std::all_of(to.begin(), to.end(), [&plane](const glm::vec3& point) { return frustum::Distance(plane, point) >= -portalEpsilon; });
+    }
+
+    /**
+     *  Add the planes through an edge of one polygon and a point of another that separate two polygons.
+     *
+     *  @param edges  The polygon to take the edges from.
+     *  @param points The polygon to take the points from.
+     *  @param from   The polygon that has to be on the outside.
+     *  @param to     The polygon that has to be on the inside.
+     *  @param[out] planes The separating planes.
+     */
+    void AddSeparatingPlanes(const polygon_buffer& edges, const polygon_buffer& points, const polygon_buffer& from, const polygon_buffer& to, plane_buffer& planes)
+    {
+        for(std::size_t i = 0; i < edges.size(); ++i)
+        {
+            const glm::vec3& a = edges[i];
+            const glm::vec3& b = edges[(i + 1) % edges.size()];
+            for(const glm::vec3& c : points)
+            {
+                const glm::vec3 normal = glm::cross(b - a, c - a);
+                const float length = glm::length(normal);
+                if(length <= portalEpsilon * portalEpsilon)
+                {
+                    continue;
+                }
+
+                const glm::vec4 plane(normal / length, -glm::dot(normal / length, a));
+                if(Separates(plane, from, to))
+                {
+                    planes.push_back(plane);
+                }
+                else if(Separates(-plane, from, to))
+                {
+                    planes.push_back(-plane);
+                }
+            }
+        }
+    }
+
+    /**
+     *  Clip a polygon by a number of planes, keeping a little of what is outside.
+     *
+     *  @param[in,out] polygon The polygon to clip.
+     *  @param planes  The planes.
+     *  @param scratch Space to clip into.
+     *
+     *  @returns Whether some of @p polygon is left.
+     */
+    bool ClipConservative(polygon_buffer& polygon, const plane_buffer& planes, polygon_buffer& scratch)
+    {
+        for(glm::vec4 plane : planes)
+        {
+            plane.w += portalEpsilon;
+            ClipPolygon(polygon, plane, scratch);
+            polygon.assign(scratch.begin(), scratch.end());
+            if(polygon.size() < 3)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     *  Recursively find the cells that lines leaving a cell through a portal can reach.
+     *
+     *  All lines through @p source and @p pass stay on the inside of the planes separating the two once they have
+     *  passed @p pass, and in front of both, so each portal further along is clipped to these planes.
+     *
+     *  @param graph   The cells and portals.
+     *  @param source  The portal the lines leave the cell through.
+     *  @param sourcePlane The plane of @p source, facing away from the cell.
+     *  @param pass    The part of the last portal of the chain the lines may pass through.
+     *  @param passPlane The plane of @p pass, facing into @p current.
+     *  @param current The cell behind @p pass.
+     *  @param path    The cells that led to @p current; a portal back into one of them is not followed.
+     *  @param[out] visible The cells reached.
+     */
+    void FlowPVS(const portal_graph& graph, const polygon_buffer& source, const glm::vec4& sourcePlane, const polygon_buffer& pass, const glm::vec4& passPlane,
+                 portal_graph::cell_index current, cell_path& path, boost::dynamic_bitset<>& visible)
+    {
+        visible.set(current);
+        if(path.size() >= maxPortalDepth)
+        {
+            return;
+        }
+        path.push_back(current);
+
+        // Lines leaving the cell pass through source and pass, but directly behind source the two are the same.
+        plane_buffer planes;
+        planes.push_back(sourcePlane);
+        planes.push_back(passPlane);
+        if(path.size() > 2)
+        {
+            AddSeparatingPlanes(source, pass, source, pass, planes);
+            AddSeparatingPlanes(pass, source, source, pass, planes);
+        }
+
+        polygon_buffer target, scratch;
+        for(const portal_graph::portal_index portalIndex : graph.GetCell(current).portals)
+        {
+            const portal_graph::portal& through = graph.GetPortal(portalIndex);
+            const portal_graph::cell_index next = through.cells[0] == current ? through.cells[1] : through.cells[0];
+            if(std::find(path.begin(), path.end(), next) != path.end())
+            {
+                continue;
+            }
+
+            target.assign(through.polygon.begin(), through.polygon.end());
+            if(ClipConservative(target, planes, scratch))
+            {
+                FlowPVS(graph, source, sourcePlane, target, PlaneInto(through, next), next, path, visible);
+            }
+        }
+        path.pop_back();
+    }
+}
+bool portal_graph::visible_set::IsVisible(cell_index index, const aabb& box) const
+{
+    if(!IsVisible(index))
+    {
+        return false;
+    }
+
+    for(const visible_cell& entry : entries)
+    {
+        if(entry.cell == index && entry.view.Intersects(box))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+portal_graph::cell_index portal_graph::AddCell(const aabb& bounds)
+{
+    ASSERT(cells.size() < noCell);
+    cells.push_back(cell{bounds, {}});
+    pvs.clear();
+    return static_cast<cell_index>(cells.size() - 1);
+}
+
+portal_graph::portal_index portal_graph::AddPortal(cell_index from, cell_index to, std::vector<glm::vec3> polygon)
+{
+    ASSERT(from < cells.size() && to < cells.size() && from != to);
+    ASSERT_MSG(polygon.size() >= 3, "A portal needs at least 3 points");
+    ASSERT(portals.size() < std::numeric_limits<portal_index>::max());
+
+    portal newPortal;
+    newPortal.cells = {{from, to}};
+    newPortal.plane = PolygonPlane(polygon);
+    for(const glm::vec3& point : polygon)
+    {
+        newPortal.bounds.Extend(point);
+    }
+    newPortal.polygon = std::move(polygon);
+
+    // make the plane face into the destination cell
+    if(frustum::Distance(newPortal.plane, cells[to].bounds.Center()) < frustum::Distance(newPortal.plane, cells[from].bounds.Center()))
+    {
+        newPortal.plane = -newPortal.plane;
+    }
+
+    const auto index = static_cast<portal_index>(portals.size());
+    portals.push_back(std::move(newPortal));
+    cells[from].portals.push_back(index);
+    cells[to].portals.push_back(index);
+    pvs.clear();
+    return index;
+}
+
+portal_graph::cell_index portal_graph::FindCell(const glm::vec3& position) const
+{
+    cell_index found = noCell;
+    float foundVolume = 0.0f;
+    for(std::size_t i = 0; i < cells.size(); ++i)
+    {
+        const aabb& bounds = cells[i].bounds;
+        if(!bounds.Contains(position))
+        {
+            continue;
+        }
+
+        const glm::vec3 size = bounds.max - bounds.min;
+        const float volume = size.x * size.y * size.z;
+        if(found == noCell || volume < foundVolume)
+        {
+            found = static_cast<cell_index>(i);
+            foundVolume = volume;
+        }
+    }
+    return found;
+}
+
+void portal_graph::Traverse(const glm::vec3& eye, const frustum& view, visible_set& result) const
+{
+    result.Clear(cells.size());
+
+    const cell_index root = FindCell(eye);
+    if(root == noCell)
+    {
+        return;
+    }
+
+    const glm::vec4* farPlane = view.planes.size() > frustum::PLANE_FAR ? &view.planes[frustum::PLANE_FAR] : nullptr;
+    cell_path path;
+    TraverseCell(eye, root, noPortal, view, farPlane, path, root, result);
+}
+
+void portal_graph::Traverse(const camera::Camera& cam, visible_set& result) const
+{
+    Traverse(glm::vec3(cam.GetX(), cam.GetY(), cam.GetZ()), frustum::FromMatrix(cam.GetViewProjectionMatrix()), result);
+}
+
+void portal_graph::TraverseCell(const glm::vec3& eye, cell_index current, portal_index entry, const frustum& view, const glm::vec4* farPlane, cell_path& path, cell_index root, visible_set& result) const
+{
+    result.entries.push_back(visible_cell{current, entry, view});
+    result.cells.set(current);
+
+    if(path.size() >= maxPortalDepth)
+    {
+        return;
+    }
+
+    path.push_back(current);
+    polygon_buffer clipped, scratch;
+    for(const portal_index portalIndex : cells[current].portals)
+    {
+        const portal& through = portals[portalIndex];
+        const cell_index next = through.cells[0] == current ? through.cells[1] : through.cells[0];
+        // A cell further up the path is seen through a narrower frustum than it already was, so looking back
+        // into it adds nothing; in cyclic graphs it would multiply the paths instead.
+        if(std::find(path.begin(), path.end(), next) != path.end())
+        {
+            continue;
+        }
+        if(!IsPotentiallyVisible(root, next) || !view.Intersects(through.bounds))
+        {
+            continue;
+        }
+
+        // orient the portal plane so that everything behind the portal (as seen from the eye) is inside
+        glm::vec4 portalPlane = through.plane;
+        float eyeDistance = frustum::Distance(portalPlane, eye);
+        if(eyeDistance > 0.0f)
+        {
+            portalPlane = -portalPlane;
+            eyeDistance = -eyeDistance;
+        }
+
+        // Standing right in the opening; the portal would degenerate to a line, so just look through it.
+        if(-eyeDistance < portalEpsilon)
+        {
+            TraverseCell(eye, next, portalIndex, view, farPlane, path, root, result);
+            continue;
+        }
+
+        clipped.assign(through.polygon.begin(), through.polygon.end());
+        for(const glm::vec4& plane : view.planes)
+        {
+            ClipPolygon(clipped, plane, scratch);
+            std::swap(clipped, scratch);
+            if(clipped.size() < 3)
+            {
+                break;
+            }
+        }
+        // In a densely connected graph the same cells are reached along many paths; once a cell was seen through
+        // a portal with a wider frustum, looking through it again finds nothing new.
+        if(clipped.size() < 3 || IsCovered(result, next, portalIndex, clipped))
+        {
+            continue;
+        }
+
+        glm::vec3 centroid(0.0f);
+        for(const glm::vec3& point : clipped)
+        {
+            centroid += point;
+        }
+        centroid /= static_cast<float>(clipped.size());
+
+        // One plane through the eye for each edge of the visible part of the portal.
+        frustum narrowed;
+        for(std::size_t i = 0; i < clipped.size(); ++i)
+        {
+            const glm::vec3 normal = glm::cross(clipped[i] - eye, clipped[(i + 1) % clipped.size()] - eye);
+            const float length = glm::length(normal);
+            if(length <= portalEpsilon * portalEpsilon)
+            {
+                continue;
+            }
+            glm::vec4 plane(normal / length, 0.0f);
+            plane.w = -glm::dot(glm::vec3(plane.x, plane.y, plane.z), eye);
+            if(frustum::Distance(plane, centroid) < 0.0f)
+            {
+                plane = -plane;
+            }
+            narrowed.planes.push_back(plane);
+        }
+        narrowed.planes.push_back(portalPlane);
+        if(farPlane)
+        {
+            narrowed.planes.push_back(*farPlane);
+        }
+
+        TraverseCell(eye, next, portalIndex, narrowed, farPlane, path, root, result);
+    }
+    path.pop_back();
+}
+
+void portal_graph::ComputePVS()
+{
+    std::vector<boost::dynamic_bitset<>> computed(cells.size(), boost::dynamic_bitset<>(cells.size()));
+    cell_path path;
+    polygon_buffer source;
+
+    for(std::size_t i = 0; i < cells.size(); ++i)
+    {
+        const auto index = static_cast<cell_index>(i);
+        computed[i].set(i);
+        for(const portal_index portalIndex : cells[i].portals)
+        {
+            const portal& through = portals[portalIndex];
+            const cell_index next = through.cells[0] == index ? through.cells[1] : through.cells[0];
+            const glm::vec4 plane = PlaneInto(through, next);
+            source.assign(through.polygon.begin(), through.polygon.end());
+            path.assign(1, index);
+            FlowPVS(*this, source, plane, source, plane, next, path, computed[i]);
+        }
+    }
+
+    pvs = std::move(computed);
+}
@@ -0,0 +1,94 @@
+/** @file
+ *  Implementation of stream_schedule.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/scene/stream_schedule.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "SH3/system/assert.hpp"
+
+using namespace sh3::scene;
+
+namespace {
+    /**
+     *  Get the distance of a point to a box, 0 if it is inside.
+     */
+    float Distance(const aabb &box, const glm::vec3 &point)
+    {
+        return glm::distance(glm::clamp(point, box.min, box.max), point);
+    }
+}
+
+void stream_schedule::SetArea(const std::vector<aabb> &bounds)
+{
+    ASSERT_MSG(bounds.size() <= static_cast<std::size_t>(std::numeric_limits<cell_index>::max()) + 1, "Too many cells in the area");
+    cells.clear();
+    cells.reserve(bounds.size());
+    for(const aabb &box : bounds)
+    {
+        cells.push_back(cell_slot{box, cell_state::UNLOADED, 0.0f});
+    }
+    order.clear();
+    hasLastPosition = false;
+}
+
+void stream_schedule::Update(const glm::vec3 &position, const settings &limits, std::vector<cell_index> &loaded, std::vector<cell_index> &unloaded)
+{
+    // also look where the camera is heading, so that cells are there by the time it arrives
+    const glm::vec3 velocity = hasLastPosition ? position - lastPosition : glm::vec3(0.0f);
+    const glm::vec3 ahead = position + velocity * static_cast<float>(limits.lookaheadFrames);
+    lastPosition = position;
+    hasLastPosition = true;
+
+    loaded.clear();
+    unloaded.clear();
+    order.clear();
+    const float unloadRadius = std::max(limits.unloadRadius, limits.loadRadius);
+    for(std::size_t i = 0; i < cells.size(); ++i)
+    {
+        cell_slot &slot = cells[i];
+        const cell_index index = static_cast<cell_index>(i);
+        slot.distance = std::min(Distance(slot.bounds, position), Distance(slot.bounds, ahead));
+
+        if(slot.state == cell_state::UNLOADED)
+        {
+            if(slot.distance <= limits.loadRadius)
+            {
+                slot.state = cell_state::LOADING;
+                loaded.push_back(index);
+            }
+        }
+        else if(slot.distance > unloadRadius)
+        {
+            slot.state = cell_state::UNLOADED;
+            unloaded.push_back(index);
+        }
+
+        if(slot.state == cell_state::LOADING)
+        {
+            order.push_back(index);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](const cell_index a, const cell_index b) { return cells[a].distance < cells[b].distance; });
+}
+
+void stream_schedule::SetResident(const cell_index index)
+{
+    ASSERT(cells[index].state == cell_state::LOADING);
+    cells[index].state = cell_state::RESIDENT;
+}
+
+bool stream_schedule::IsStalled(const glm::vec3 &position) const
+{
+    for(const cell_slot &slot : cells)
+    {
+        if(slot.state != cell_state::RESIDENT && slot.bounds.Contains(position))
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,218 @@
+/** @file
+ *  Implementation of streaming.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/scene/streaming.hpp"
+
+#include <chrono>
+#include <utility>
+
+#include "SH3/camera/camera.hpp"
+#include "SH3/system/assert.hpp"
+#include "SH3/system/config.hpp"
+#include "SH3/system/log.hpp"
+#include "SH3/system/perf_clock.hpp"
+
+using namespace sh3::scene;
+using sh3::system::arena_string;
+using sh3::system::arena_vector;
+using sh3::system::config_var;
+
+namespace {
+    float streamLoadRadius = 40.0f;         /**< Distance at which cells are loaded. */
+    float streamUnloadRadius = 60.0f;       /**< Distance at which cells are unloaded. */
+    unsigned streamLookaheadFrames = 30;    /**< Frames the camera movement is extrapolated. */
+    unsigned streamMaxLoads = 4;            /**< Files read or decoded at the same time. */
+    unsigned streamUploadKiB = 2048;        /**< Pixel data uploaded per frame. */
+    float streamUploadMs = 2.0f;            /**< Time spent uploading per frame. */
+
+    config_var<float> streamLoadRadiusVar("stream_load_radius", streamLoadRadius, 0.0f);
+    config_var<float> streamUnloadRadiusVar("stream_unload_radius", streamUnloadRadius, 0.0f);
+    config_var<unsigned> streamLookaheadFramesVar("stream_lookahead_frames", streamLookaheadFrames, 0, 600);
+    config_var<unsigned> streamMaxLoadsVar("stream_max_loads", streamMaxLoads, 1, 256);
+    config_var<unsigned> streamUploadKiBVar("stream_upload_kib", streamUploadKiB, 1);
+    config_var<float> streamUploadMsVar("stream_upload_ms", streamUploadMs, 0.0f);
+}
+
+streaming_manager::streaming_manager(sh3::arc::async_mft &fileSource):
+    files(fileSource), areaMemory("area"), cells(areaMemory), schedule(), loaded(), unloaded(), textures(), stats()
+{
+}
+
+void streaming_manager::SetArea(const std::vector<cell> &area)
+{
+    for(std::size_t i = 0; i < cells.size(); ++i)
+    {
+        if(schedule.GetState(static_cast<cell_index>(i)) != cell_state::UNLOADED)
+        {
+            Release(cells[i]);
+        }
+    }
+
+    // the cells live in the arena, so they have to go first; the textures are keyed by their names, but none is used anymore
+    ASSERT(textures.empty());
+    arena_vector<area_cell>(areaMemory).swap(cells);
+    if(areaMemory.GetUsed() != 0)
+    {
+        areaMemory.Report();
+    }
+    areaMemory.Reset();
+
+    std::vector<aabb> bounds;
+    bounds.reserve(area.size());
+    cells.reserve(area.size());
+    for(const cell &data : area)
+    {
+        bounds.push_back(data.bounds);
+        cells.push_back(area_cell{data.bounds, arena_vector<arena_string>(areaMemory)});
+        arena_vector<arena_string> &names = cells.back().textures;
+        names.reserve(data.textures.size());
+        for(const std::string &filename : data.textures)
+        {
+            names.emplace_back(filename.begin(), filename.end(), areaMemory);
+        }
+    }
+    schedule.SetArea(bounds);
+    stalled = false;
+}
+
+void streaming_manager::Update(const camera::Camera &camera)
+{
+    Update(camera.GetPosition());
+}
+
+void streaming_manager::Update(const glm::vec3 &position)
+{
+    schedule.Update(position, stream_schedule::settings{streamLoadRadius, streamUnloadRadius, streamLookaheadFrames}, loaded, unloaded);
+    // acquire first, so textures shared with a cell being unloaded are kept
+    for(const cell_index index : loaded)
+    {
+        Acquire(cells[index]);
+    }
+    for(const cell_index index : unloaded)
+    {
+        Release(cells[index]);
+    }
+
+    Load();
+
+    const bool stalling = schedule.IsStalled(position);
+    if(stalling)
+    {
+        ++stats.stallFrames;
+        if(!stalled)
+        {
+            Log(LogLevel::WARN, "streaming_manager: The camera is in a cell that is not loaded yet; consider raising stream_load_radius or the upload budget.");
+        }
+    }
+    stalled = stalling;
+}
+
+void streaming_manager::Acquire(const area_cell &data)
+{
+    for(const arena_string &filename : data.textures)
+    {
+        ++textures[boost::string_view(filename.data(), filename.size())].users;
+    }
+}
+
+void streaming_manager::Release(const area_cell &data)
+{
+    for(const arena_string &filename : data.textures)
+    {
+        const auto entry = textures.find(boost::string_view(filename.data(), filename.size()));
+        ASSERT(entry != textures.end());
+        if(--entry->second.users == 0)
+        {
+            // a load still in flight finishes in the background and is dropped
+            textures.erase(entry);
+        }
+    }
+}
+
+void streaming_manager::Load()
+{
+    using clock = sh3::system::perf_clock;
+    const clock::time_point uploadDeadline = clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float, std::milli>(streamUploadMs));
+    upload_budget budget(static_cast<std::size_t>(streamUploadKiB) * 1024, uploadDeadline);
+
+    std::size_t loads = 0;
+    for(const auto &entry : textures)
+    {
+        if(entry.second.decoded && !entry.second.decoded->IsReady())
+        {
+            ++loads;
+        }
+    }
+
+    stats.uploads = 0;
+    for(const cell_index index : schedule.GetLoadOrder())
+    {
+        bool complete = true;
+        for(const arena_string &filename : cells[index].textures)
+        {
+            texture_entry &entry = textures[boost::string_view(filename.data(), filename.size())];
+            if(entry.texture)
+            {
+                continue;
+            }
+            complete = false;
+
+            if(!entry.decoded)
+            {
+                if(loads < streamMaxLoads)
+                {
+                    entry.decoded = sh3_graphics::DecodeTextureAsync(files, std::string(filename.begin(), filename.end()));
+                    ++loads;
+                }
+                continue;
+            }
+
+            if(!entry.decoded->IsReady())
+            {
+                continue;
+            }
+
+            if(!budget.IsLeft())
+            {
+                ++stats.uploads;
+                continue;
+            }
+
+            const std::shared_ptr<sh3_graphics::texture_image> &image = entry.decoded->Get();
+            entry.texture = std::make_shared<sh3_graphics::sh3_texture>();
+            std::size_t bytes = 0;
+            if(image)
+            {
+                entry.texture->Upload(*image);
+                bytes = image->pixels.size();
+            }
+            entry.decoded = boost::none;
+            budget.Spend(bytes, clock::now());
+        }
+
+        if(complete)
+        {
+            schedule.SetResident(index);
+        }
+    }
+    stats.uploadedBytes = budget.GetSpent();
+
+    stats.residentCells = 0;
+    stats.loadingCells = 0;
+    for(std::size_t i = 0; i < schedule.GetCellCount(); ++i)
+    {
+        const cell_state state = schedule.GetState(static_cast<cell_index>(i));
+        stats.residentCells += state == cell_state::RESIDENT;
+        stats.loadingCells += state == cell_state::LOADING;
+    }
+    stats.textures = textures.size();
+    stats.loads = loads;
+}
+
+std::shared_ptr<sh3_graphics::sh3_texture> streaming_manager::GetTexture(const std::string &filename) const
+{
+    const auto entry = textures.find(boost::string_view(filename));
+    return entry != textures.end() ? entry->second.texture : nullptr;
+}
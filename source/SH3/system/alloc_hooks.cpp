@@ -0,0 +1,224 @@
+/** @file
+ *  Implementation of alloc_hooks.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/alloc_hooks.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#define SH3_CAPTURE_STACKS
+#endif
+
+#include "SH3/system/config.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+namespace {
+    unsigned warmupFrames = 0; /**< Frames allowed to allocate before the check starts; 0 disables it. */
+
+    config_var<unsigned> warmupFramesVar("alloc_check_warmup", warmupFrames);
+
+    // plain thread_locals without constructors, so that operator new can use them at any time without allocating
+    thread_local std::uint64_t allocationCount = 0;             /**< Allocations of this thread so far. */
+    thread_local bool capturing = false;                        /**< Whether to capture the stacks of this thread. */
+
+#ifdef SH3_CAPTURE_STACKS
+    constexpr std::size_t maxStacks = 4;        /**< Allocations per frame to capture the stack of. */
+    constexpr int maxStackDepth = 24;           /**< Frames captured per stack. */
+
+    /**
+     *  The stack of an allocation.
+     */
+    struct captured_stack final
+    {
+        std::array<void*, maxStackDepth> frames;    /**< Return addresses. */
+        int depth;                                  /**< Number of @ref frames. */
+        std::size_t size;                           /**< Bytes allocated. */
+    };
+
+    // only the frame thread captures, so these need no synchronisation
+    std::size_t capturedStacks = 0;                             /**< Stacks captured since capturing started. */
+    std::array<captured_stack, maxStacks> stacks{};             /**< The captured stacks. */
+#endif
+
+#ifdef SH3_TRACK_ALLOCATIONS
+    /**
+     *  Count an allocation, capturing the stack if asked to.
+     */
+    void CountAllocation(const std::size_t size)
+    {
+        ++allocationCount;
+
+#ifdef SH3_CAPTURE_STACKS
+        if(capturing && capturedStacks < maxStacks)
+        {
+            captured_stack &stack = stacks[capturedStacks++];
+            stack.size = size;
+            stack.depth = backtrace(stack.frames.data(), maxStackDepth);
+        }
+#else
+        static_cast<void>(size);
+#endif
+    }
+#endif
+
+    /**
+     *  Start capturing the stacks of allocations.
+     */
+    void StartCapture()
+    {
+#ifdef SH3_CAPTURE_STACKS
+        // the first backtrace loads the unwinder, which allocates; get that out of the way
+        static bool unwinderLoaded = false;
+        if(!unwinderLoaded)
+        {
+            std::array<void*, 1> frames;
+            backtrace(frames.data(), static_cast<int>(frames.size()));
+            unwinderLoaded = true;
+        }
+
+        capturedStacks = 0;
+        capturing = true;
+#endif
+    }
+
+    /**
+     *  Stop capturing and log the stacks captured.
+     */
+    void StopCapture()
+    {
+        capturing = false;
+
+#ifdef SH3_CAPTURE_STACKS
+        for(std::size_t i = 0; i < capturedStacks; ++i)
+        {
+            const captured_stack &stack = stacks[i];
+            Log(LogLevel::WARN, "  allocation of %zu bytes:", stack.size);
+            char **symbols = backtrace_symbols(stack.frames.data(), stack.depth);
+            for(int frame = 1; frame < stack.depth; ++frame) // skip CountAllocation
+            {
+                Log(LogLevel::WARN, "    %s", symbols ? symbols[frame] : "?");
+            }
+            std::free(symbols);
+        }
+#endif
+    }
+}
+
+std::uint64_t sh3::system::GetAllocationCount()
+{
+    return allocationCount;
+}
+
+frame_allocation_check::frame_allocation_check():
+    warmup(allocationHooks ? warmupFrames : 0)
+{
+    if(warmup != 0)
+    {
+        Log(LogLevel::INFO, "Checking that frames don't allocate after %u frames of warm-up.", warmup);
+    }
+}
+
+void frame_allocation_check::EndFrame()
+{
+    if(warmup == 0)
+    {
+        return;
+    }
+
+    const std::uint64_t count = GetAllocationCount() - lastCount;
+    ++frame;
+    if(frame > warmup && count != 0)
+    {
+        ++failedFrames;
+        Log(LogLevel::ERROR, "Frame %u allocated %llu times after warming up!", frame, static_cast<unsigned long long>(count));
+        StopCapture();
+    }
+
+    if(frame >= warmup)
+    {
+        StartCapture();
+    }
+
+    // logging the failure above allocates too; that belongs to neither frame
+    lastCount = GetAllocationCount();
+}
+
+#ifdef SH3_TRACK_ALLOCATIONS
+void* operator new(std::size_t size)
+{
+    CountAllocation(size);
+    for(;;)
+    {
+        if(void *memory = std::malloc(size != 0 ? size : 1))
+        {
+            return memory;
+        }
+
+        const std::new_handler handler = std::get_new_handler();
+        if(!handler)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return operator new(size);
+    }
+    catch(const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+#endif
@@ -0,0 +1,134 @@
+/** @file
+ *  Implementation of arena.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+constexpr std::size_t arena::defaultBlockSize;
+
+/**
+ *  A chunk of memory allocations are taken from.
+ */
+struct arena::block final
+{
+    explicit block(const std::size_t blockSize): size(blockSize), memory(new char[blockSize]) {}
+
+    std::size_t size;                   /**< The size of @ref memory. */
+    std::unique_ptr<char[]> memory;     /**< The memory. */
+};
+
+arena::arena(const char *arenaName, const std::size_t newBlockSize):
+    name(arenaName), blockSize(newBlockSize), mutex(), blocks()
+{
+    ASSERT_MSG(blockSize > 0, "An arena needs a block size");
+}
+
+arena::~arena()
+{
+    Reset();
+}
+
+void* arena::AllocateFromBlock(const std::size_t size, const std::size_t alignment)
+{
+    if(blocks.empty())
+    {
+        return nullptr;
+    }
+
+    block &current = *blocks.back();
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(current.memory.get());
+    const std::uintptr_t aligned = (base + offset + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    const std::size_t start = static_cast<std::size_t>(aligned - base);
+    if(start > current.size || current.size - start < size)
+    {
+        return nullptr;
+    }
+
+    used += start + size - offset;
+    offset = start + size;
+    return current.memory.get() + start;
+}
+
+void* arena::Allocate(const std::size_t size, const std::size_t alignment)
+{
+    ASSERT_MSG(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++allocations;
+
+    void *memory = AllocateFromBlock(size, alignment);
+    if(!memory)
+    {
+        // the rest of the current block is lost; with large enough blocks that's little
+        const std::size_t newSize = std::max(blockSize, size + alignment - 1);
+        blocks.emplace_back(new block(newSize));
+        offset = 0;
+        reserved += newSize;
+        reservedHighWater = std::max(reservedHighWater, reserved);
+
+        memory = AllocateFromBlock(size, alignment);
+        ASSERT(memory);
+    }
+
+    highWater = std::max(highWater, used);
+    return memory;
+}
+
+void arena::AddFinalizer(void *object, void (*destroy)(void*))
+{
+    finalizer *added = static_cast<finalizer*>(Allocate(sizeof(finalizer), alignof(finalizer)));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    *added = finalizer{destroy, object, finalizers};
+    finalizers = added;
+}
+
+void arena::Reset()
+{
+    // destructors may still allocate, e.g. by logging, but not from this arena
+    for(finalizer *current = finalizers; current; current = current->next)
+    {
+        current->destroy(current->object);
+    }
+    finalizers = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(blocks.size() > 1)
+    {
+        // keep the first block, an arena is usually filled again right away
+        blocks.erase(blocks.begin() + 1, blocks.end());
+    }
+    reserved = blocks.empty() ? 0 : blocks.front()->size;
+    offset = 0;
+    used = 0;
+    allocations = 0;
+    ++resets;
+}
+
+std::size_t arena::GetUsed() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+std::size_t arena::GetHighWater() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return highWater;
+}
+
+void arena::Report() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Log(LogLevel::INFO, "arena %s: %zu KiB in %zu allocations, %zu KiB reserved in %zu blocks; high-water %zu KiB used, %zu KiB reserved, over %zu resets.",
+        name, used / 1024, allocations, reserved / 1024, blocks.size(), highWater / 1024, reservedHighWater / 1024, resets);
+}
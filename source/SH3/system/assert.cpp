@@ -3,10 +3,10 @@
  *  
  *  @copyright 2017  Palm Studios
  */
-#ifndef ASSERT_OFF
-
 #include "SH3/system/assert.hpp"
 
+#if ASSERT_LEVEL > ASSERT_LEVEL_NONE
+
 #include <iostream>
 #include <locale>
 #include <limits>
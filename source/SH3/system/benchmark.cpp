@@ -0,0 +1,369 @@
+/** @file
+ *  Implementation of benchmark.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/log.hpp"
+#include "SH3/system/memory_tags.hpp"
+
+using namespace sh3::system;
+
+constexpr std::size_t benchmark_run::maxPendingQueries;
+
+namespace {
+    /**
+     *  Convert a duration to milliseconds.
+     */
+    double Milliseconds(const perf_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    /**
+     *  Get a percentile of sorted values, by nearest rank.
+     */
+    double Percentile(const std::vector<double> &sorted, const double percent)
+    {
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[std::min(std::max(rank, std::size_t(1)), sorted.size()) - 1];
+    }
+
+    /**
+     *  Write the mean and the percentiles of some values as a JSON object.
+     */
+    void WriteDistribution(std::ostream &file, std::vector<double> values)
+    {
+        if(values.empty())
+        {
+            file << "{}";
+            return;
+        }
+        std::sort(values.begin(), values.end());
+        const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        file << "{\"mean\": " << mean;
+        for(const double percent : {50.0, 90.0, 95.0, 99.0})
+        {
+            file << ", \"p" << percent << "\": " << Percentile(values, percent);
+        }
+        file << ", \"max\": " << values.back() << "}";
+    }
+
+    /**
+     *  Quote a string for JSON. Names are ours, so only quotes and backslashes need escaping.
+     */
+    std::string Quote(const char *text)
+    {
+        std::string quoted = "\"";
+        for(; *text != '\0'; ++text)
+        {
+            if(*text == '"' || *text == '\\')
+            {
+                quoted += '\\';
+            }
+            quoted += *text;
+        }
+        return quoted + "\"";
+    }
+}
+
+bool sh3::system::ParseBenchmarkArguments(const int argc, char **argv, benchmark_settings &settings)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        const bool flag = std::strcmp(arg, "--headless") == 0;
+        if(!flag && value == nullptr)
+        {
+            Log(LogLevel::ERROR, "Unknown argument %s, or it needs a value.", arg);
+            return false;
+        }
+
+        if(flag)
+        {
+            settings.headless = true;
+            continue;
+        }
+        else if(std::strcmp(arg, "--benchmark") == 0)
+        {
+            settings.name = value;
+        }
+        else if(std::strcmp(arg, "--replay") == 0)
+        {
+            settings.replay = value;
+        }
+        else if(std::strcmp(arg, "--frames") == 0)
+        {
+            const long frames = std::strtol(value, nullptr, 10);
+            if(frames <= 0)
+            {
+                Log(LogLevel::ERROR, "--frames needs a positive number, not %s.", value);
+                return false;
+            }
+            settings.frames = static_cast<std::uint32_t>(frames);
+        }
+        else if(std::strcmp(arg, "--timestep") == 0)
+        {
+            const double milliseconds = std::strtod(value, nullptr);
+            if(milliseconds <= 0.0)
+            {
+                Log(LogLevel::ERROR, "--timestep needs a positive number of milliseconds, not %s.", value);
+                return false;
+            }
+            settings.timestep = std::chrono::duration_cast<perf_clock::duration>(std::chrono::duration<double, std::milli>(milliseconds));
+        }
+        else if(std::strcmp(arg, "--output") == 0)
+        {
+            settings.output = value;
+        }
+        else
+        {
+            Log(LogLevel::ERROR, "Unknown argument %s.", arg);
+            return false;
+        }
+        ++i;
+    }
+
+    if(settings.name.empty() && (settings.headless || !settings.replay.empty()))
+    {
+        Log(LogLevel::ERROR, "The benchmark options need --benchmark NAME.");
+        return false;
+    }
+    return true;
+}
+
+benchmark_run::benchmark_run(const benchmark_settings &runSettings, const startup_graph &startup):
+    settings(runSettings), loadTimes(startup.GetTimings()), loadTime(startup.GetDuration()), gameTime(perf_clock::now()), frameStart(gameTime), passStart()
+{
+    if(!settings.replay.empty())
+    {
+        input_replay::load_error err;
+        replay.reset(new input_replay(settings.replay, err));
+        if(err)
+        {
+            Log(LogLevel::ERROR, "Unable to replay %s: %s", settings.replay.c_str(), err.message().c_str());
+            good = false;
+        }
+    }
+
+    timerQueries = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if(!timerQueries)
+    {
+        Log(LogLevel::WARN, "No timer queries, the benchmark won't report GPU times.");
+    }
+    frameTimes.reserve(settings.frames);
+    freeQueries.reserve(maxPendingQueries);
+}
+
+benchmark_run::~benchmark_run()
+{
+    for(; pendingHead != pendingTail; ++pendingHead)
+    {
+        freeQueries.push_back(pending[pendingHead % maxPendingQueries].query);
+    }
+    if(!freeQueries.empty())
+    {
+        glDeleteQueries(static_cast<GLsizei>(freeQueries.size()), freeQueries.data());
+    }
+}
+
+bool benchmark_run::PollEvent(SDL_Event &event)
+{
+    while(SDL_PollEvent(&event) != 0)
+    {
+        if(event.type == SDL_QUIT)
+        {
+            return true;
+        }
+    }
+
+    if(!replay || replay->IsFinished())
+    {
+        return false;
+    }
+    perf_clock::time_point recorded;
+    return replay->PollEvent(event, recorded);
+}
+
+void benchmark_run::BeginPass(const char *name)
+{
+    ASSERT_MSG(!inPass, "Render passes can't nest");
+
+    const auto found = std::find_if(passes.begin(), passes.end(), [name](const pass &candidate) { return std::strcmp(candidate.name, name) == 0; });
+    currentPass = static_cast<std::size_t>(found - passes.begin());
+    if(found == passes.end())
+    {
+        passes.push_back(pass{name});
+        passes.back().cpu.reserve(settings.frames);
+        passes.back().gpu.reserve(settings.frames);
+    }
+    inPass = true;
+
+    if(timerQueries)
+    {
+        if(pendingTail - pendingHead == maxPendingQueries)
+        {
+            // the GPU is far behind; rather wait for it than lose the timing
+            CollectOldestQuery(true);
+        }
+        if(freeQueries.empty())
+        {
+            freeQueries.push_back(0);
+            glGenQueries(1, &freeQueries.back());
+        }
+        const GLuint query = freeQueries.back();
+        freeQueries.pop_back();
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        pending[pendingTail++ % maxPendingQueries] = pending_query{query, currentPass};
+    }
+    passStart = perf_clock::now();
+}
+
+void benchmark_run::EndPass()
+{
+    ASSERT_MSG(inPass, "EndPass without BeginPass");
+
+    passes[currentPass].cpu.push_back(Milliseconds(perf_clock::now() - passStart));
+    if(timerQueries)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+    inPass = false;
+}
+
+bool benchmark_run::EndFrame()
+{
+    const perf_clock::time_point now = perf_clock::now();
+    frameTimes.push_back(Milliseconds(now - frameStart));
+    frameStart = now;
+
+    // results arrive a frame or two late; reading them without waiting keeps the run from stalling on the GPU
+    CollectQueries(false);
+
+    if(replay && !replay->IsFinished())
+    {
+        replay->EndFrame();
+    }
+    gameTime += settings.timestep;
+    return ++frame < settings.frames;
+}
+
+bool benchmark_run::CollectOldestQuery(const bool wait)
+{
+    const pending_query &oldest = pending[pendingHead % maxPendingQueries];
+    if(!wait)
+    {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(oldest.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE)
+        {
+            return false;
+        }
+    }
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(oldest.query, GL_QUERY_RESULT, &nanoseconds);
+    passes[oldest.pass].gpu.push_back(static_cast<double>(nanoseconds) / 1e6);
+    freeQueries.push_back(oldest.query);
+    ++pendingHead;
+    return true;
+}
+
+void benchmark_run::CollectQueries(const bool wait)
+{
+    // queries finish in order, so once one isn't done the younger ones aren't either
+    while(pendingHead != pendingTail)
+    {
+        if(!CollectOldestQuery(wait))
+        {
+            return;
+        }
+    }
+}
+
+bool benchmark_run::Finish(const latency_tracker &latency)
+{
+    CollectQueries(true);
+    if(!Write(latency))
+    {
+        Log(LogLevel::ERROR, "Unable to write the benchmark report to %s.", settings.output.c_str());
+        return false;
+    }
+    Log(LogLevel::INFO, "Wrote the benchmark report of %u frames to %s.", frame, settings.output.c_str());
+    return true;
+}
+
+bool benchmark_run::Write(const latency_tracker &latency) const
+{
+    std::ofstream file(settings.output);
+    file << "{\n\t\"name\": " << Quote(settings.name.c_str()) << ",\n";
+    file << "\t\"frames\": " << frameTimes.size() << ",\n";
+    file << "\t\"timestep_ms\": " << Milliseconds(settings.timestep) << ",\n";
+
+    file << "\t\"load_ms\": {\"total\": " << Milliseconds(loadTime);
+    for(const startup_graph::step_timing &step : loadTimes)
+    {
+        file << ", " << Quote(step.name) << ": " << Milliseconds(step.duration);
+    }
+    file << "},\n";
+
+    file << "\t\"frame_ms\": ";
+    WriteDistribution(file, frameTimes);
+    file << ",\n";
+
+    file << "\t\"memory_peak_bytes\": {";
+    const char *separator = "";
+    for(std::size_t tag = 0; tag < static_cast<std::size_t>(memory_tag::MAX); ++tag)
+    {
+        const memory_tag current = static_cast<memory_tag>(tag);
+        file << separator << Quote(GetMemoryTagName(current)) << ": " << GetMemoryStats(current).peak;
+        separator = ", ";
+    }
+    file << "},\n";
+
+    file << "\t\"passes\": {";
+    separator = "\n";
+    for(const pass &current : passes)
+    {
+        file << separator << "\t\t" << Quote(current.name) << ": {\"cpu_ms\": ";
+        WriteDistribution(file, current.cpu);
+        if(timerQueries)
+        {
+            file << ", \"gpu_ms\": ";
+            WriteDistribution(file, current.gpu);
+        }
+        file << "}";
+        separator = ",\n";
+    }
+    file << "\n\t},\n";
+
+    file << "\t\"latency_ms\": {";
+    separator = "";
+    for(std::size_t stage = 0; stage < latency_tracker::STAGE_COUNT; ++stage)
+    {
+        const auto which = static_cast<latency_tracker::stage>(stage);
+        const latency_tracker::distribution latencies = latency.GetDistribution(which);
+        file << separator << Quote(latency_tracker::GetStageName(which)) << ": {\"count\": " << latencies.count;
+        if(latencies.count > 0)
+        {
+            file << ", \"mean\": " << Milliseconds(latencies.mean) << ", \"p50\": " << Milliseconds(latencies.median)
+                 << ", \"p95\": " << Milliseconds(latencies.p95) << ", \"p99\": " << Milliseconds(latencies.p99)
+                 << ", \"max\": " << Milliseconds(latencies.max);
+        }
+        file << "}";
+        separator = ", ";
+    }
+    file << "}\n}\n";
+    return static_cast<bool>(file);
+}
@@ -17,80 +17,408 @@ Notes:
 
 Revision History:
         27-12-2016: File Created                                                    [jbuhagiar]
+                    Typed config variables, checked parsing, reloading on change
 
 --*/
 #include "SH3/system/config.hpp"
 #include "SH3/system/log.hpp"
 
-#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <fstream>
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <utility>
-#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace sh3::system;
+
+constexpr const char *sh3_config::defaultPath;
+
+namespace
+{
+    /**
+     *  All registered variables and the values loaded for them.
+     *
+     *  Function-local, so variables can register during static initialization.
+     */
+    struct config_registry final
+    {
+        std::unordered_map<std::string, config_var_base*> vars{};   /**< Registered variables by name. */
+        std::unordered_map<std::string, std::string> values{};      /**< Values of the last loaded file by name. */
+    };
+
+    config_registry& Registry()
+    {
+        static config_registry registry;
+        return registry;
+    }
+
+    /**
+     *  Get @p text without surrounding whitespace.
+     */
+    std::string Trim(const std::string &text)
+    {
+        const auto isSpace = [](const char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        auto first = text.begin();
+        auto last = text.end();
+        while(first != last && isSpace(*first))
+        {
+            ++first;
+        }
+        while(last != first && isSpace(*(last - 1)))
+        {
+            --last;
+        }
+        return std::string(first, last);
+    }
+
+    /**
+     *  Parse a signed integer and check that it fits into @p T.
+     */
+    template<typename T>
+    bool ParseSigned(const std::string &text, T &value)
+    {
+        const std::string trimmed = Trim(text);
+        if(trimmed.empty())
+        {
+            return false;
+        }
+        char *end;
+        errno = 0;
+        const long long parsed = std::strtoll(trimmed.c_str(), &end, 0);
+        if(errno != 0 || *end != '\0' || parsed < std::numeric_limits<T>::min() || parsed > std::numeric_limits<T>::max())
+        {
+            return false;
+        }
+        value = static_cast<T>(parsed);
+        return true;
+    }
+
+    /**
+     *  Parse an unsigned integer and check that it fits into @p T.
+     */
+    template<typename T>
+    bool ParseUnsigned(const std::string &text, T &value)
+    {
+        const std::string trimmed = Trim(text);
+        // strtoull happily negates
+        if(trimmed.empty() || trimmed.front() == '-')
+        {
+            return false;
+        }
+        char *end;
+        errno = 0;
+        const unsigned long long parsed = std::strtoull(trimmed.c_str(), &end, 0);
+        if(errno != 0 || *end != '\0' || parsed > std::numeric_limits<T>::max())
+        {
+            return false;
+        }
+        value = static_cast<T>(parsed);
+        return true;
+    }
+
+    /**
+     *  Parse a floating point number.
+     */
+    template<typename T>
+    bool ParseFloat(const std::string &text, T &value)
+    {
+        const std::string trimmed = Trim(text);
+        if(trimmed.empty())
+        {
+            return false;
+        }
+        char *end;
+        errno = 0;
+        const double parsed = std::strtod(trimmed.c_str(), &end);
+        if(errno != 0 || *end != '\0' || !(parsed >= std::numeric_limits<T>::lowest() && parsed <= std::numeric_limits<T>::max()))
+        {
+            return false;
+        }
+        value = static_cast<T>(parsed);
+        return true;
+    }
+
+    /**
+     *  Assign a loaded value to a variable, logging what happens.
+     */
+    void Apply(config_var_base &var, const std::string &text)
+    {
+        const std::string old = var.Get();
+        if(!var.Set(text))
+        {
+            Log(LogLevel::WARN, "sh3_config: Invalid value \"%s\" for %s, keeping %s.", text.c_str(), var.GetName(), old.c_str());
+            return;
+        }
+        const std::string current = var.Get();
+        if(current != old)
+        {
+            Log(LogLevel::INFO, "sh3_config: %s = %s (was %s)", var.GetName(), current.c_str(), old.c_str());
+        }
+    }
+}
+
+namespace sh3 { namespace system {
+    bool ParseConfigValue(const std::string &text, bool &value)
+    {
+        const std::string trimmed = Trim(text);
+        if(trimmed == "1" || trimmed == "true" || trimmed == "yes" || trimmed == "on")
+        {
+            value = true;
+            return true;
+        }
+        if(trimmed == "0" || trimmed == "false" || trimmed == "no" || trimmed == "off")
+        {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParseConfigValue(const std::string &text, int &value) { return ParseSigned(text, value); }
+    bool ParseConfigValue(const std::string &text, long &value) { return ParseSigned(text, value); }
+    bool ParseConfigValue(const std::string &text, long long &value) { return ParseSigned(text, value); }
+    bool ParseConfigValue(const std::string &text, unsigned &value) { return ParseUnsigned(text, value); }
+    bool ParseConfigValue(const std::string &text, unsigned long &value) { return ParseUnsigned(text, value); }
+    bool ParseConfigValue(const std::string &text, unsigned long long &value) { return ParseUnsigned(text, value); }
+    bool ParseConfigValue(const std::string &text, float &value) { return ParseFloat(text, value); }
+    bool ParseConfigValue(const std::string &text, double &value) { return ParseFloat(text, value); }
+
+    bool ParseConfigValue(const std::string &text, std::string &value)
+    {
+        value = Trim(text);
+        return true;
+    }
+} }
+
+config_var_base::config_var_base(const char *optionName)
+    : name(optionName)
+{
+    const bool inserted = Registry().vars.emplace(name, this).second;
+    if(!inserted)
+    {
+        Log(LogLevel::ERROR, "config_var: %s is registered twice, only the first one is set!", name);
+    }
+}
+
+config_var_base::~config_var_base()
+{
+    auto &vars = Registry().vars;
+    const auto iter = vars.find(name);
+    if(iter != vars.end() && iter->second == this)
+    {
+        vars.erase(iter);
+    }
+}
+
+void config_var_base::Resolve()
+{
+    const auto &values = Registry().values;
+    const auto iter = values.find(name);
+    if(iter != values.end())
+    {
+        Apply(*this, iter->second);
+    }
+}
+
+sh3_config::~sh3_config()
+{
+    #ifdef __linux__
+    if(watchFd >= 0)
+    {
+        close(watchFd);
+    }
+    #endif
+}
 
 /*++
 
 Routine Description:
-        Load all options and map them to their values in our map
+        Load all options, keep their values and assign them to the registered variables
 
 Arguments:
         None
 
 Return Type:
-        int - Number of Strings read in from the file
+        int - Number of options read in from the file, -1 if it could not be opened
 
 --*/
 int sh3_config::Load()
 {
-    static const char* CFGPATH = "sh3r.cfg";
-
-    std::fstream cfgfile(CFGPATH);
+    std::ifstream cfgfile(path);
     if(!cfgfile)
     {
-        Log(LogLevel::ERROR, "Unable to find %s! Reverting to default values...", CFGPATH);
+        Log(LogLevel::ERROR, "Unable to find %s! Reverting to default values...", path.c_str());
         return -1;
     }
 
+    std::unordered_map<std::string, std::string> values;
     int         nStrs = 0;
+    int         lineNumber = 0;
     std::string command;
 
     while(getline(cfgfile, command))
     {
+        ++lineNumber;
+        command = Trim(command);
+
         static const std::string COMMENT = { '#', '$' };
         if(command.empty() || COMMENT.find(command.front()) != std::string::npos)
         {
             continue;
         }
 
-        // Now, split the command up and store its' value in our map (that we can use later!! :] )
-        const auto commandEnd = find(begin(command), end(command), ' ');
-        std::string key(begin(command), commandEnd),
-                    value(commandEnd, end(command));
-        values[std::move(key)] = std::stoi(std::move(value)); // <- THIS IS VERY DANGEROUS!!!!!!!!
+        // Now, split the command up into key and value; the value is checked when it is assigned to its variable
+        std::size_t keyEnd = 0;
+        while(keyEnd < command.size() && !std::isspace(static_cast<unsigned char>(command[keyEnd])))
+        {
+            ++keyEnd;
+        }
+        std::string key = command.substr(0, keyEnd),
+                    value = Trim(command.substr(keyEnd));
+        if(value.empty())
+        {
+            Log(LogLevel::WARN, "%s:%d: No value for %s, ignoring.", path.c_str(), lineNumber, key.c_str());
+            continue;
+        }
+        values[std::move(key)] = std::move(value);
 
         nStrs++;
     }
 
+    config_registry &registry = Registry();
+    registry.values = std::move(values);
+    for(const auto &var : registry.vars)
+    {
+        const auto iter = registry.values.find(var.first);
+        if(iter != registry.values.end())
+        {
+            Apply(*var.second, iter->second);
+        }
+    }
+
     return nStrs;
 }
 
 /*++
 
 Routine Description:
-
+        Get the value of an option as a number
 
 Arguments:
-
+        option - The name of the option
 
 Return Type:
-
+        int - The value, -1 if the option is not set or not a number
 
 --*/
-int sh3_config::GetOptionValue(const std::string& option)
+int sh3_config::GetOptionValue(const std::string& option) const
 {
+    const auto &values = Registry().values;
     auto iter = values.find(option);
-    if(iter == end(values))
+    int value;
+    if(iter == end(values) || !ParseConfigValue(iter->second, value))
         return -1;
 
-    return iter->second;
+    return value;
+}
+
+/*++
+
+Routine Description:
+        Start watching the directory of the configuration file with inotify.
+        Editors tend to replace files instead of writing them, so we can't watch the file itself.
+
+Arguments:
+        None
+
+Return Type:
+        bool - Whether the file is being watched
+
+--*/
+bool sh3_config::Watch()
+{
+    #ifdef __linux__
+    if(watchFd >= 0)
+    {
+        return true;
+    }
+
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(watchFd < 0)
+    {
+        Log(LogLevel::WARN, "sh3_config: Unable to create an inotify instance, changes to %s will not be picked up.", path.c_str());
+        return false;
+    }
+
+    const auto slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    if(inotify_add_watch(watchFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        Log(LogLevel::WARN, "sh3_config: Unable to watch %s, changes to %s will not be picked up.", directory.c_str(), path.c_str());
+        close(watchFd);
+        watchFd = -1;
+        return false;
+    }
+    return true;
+    #else
+    Log(LogLevel::INFO, "sh3_config: Watching for changes is not supported on this platform.");
+    return false;
+    #endif
+}
+
+/*++
+
+Routine Description:
+        Drain the pending inotify events and reload if one of them concerns our file
+
+Arguments:
+        None
+
+Return Type:
+        bool - Whether the file was reloaded
+
+--*/
+bool sh3_config::Poll()
+{
+    #ifdef __linux__
+    if(watchFd < 0)
+    {
+        return false;
+    }
+
+    const auto slash = path.find_last_of('/');
+    const std::string filename = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    for(ssize_t length; (length = read(watchFd, buffer, sizeof(buffer))) > 0;)
+    {
+        for(char *next = buffer; next < buffer + length;)
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event*>(next);
+            if(event->len > 0 && filename == event->name)
+            {
+                changed = true;
+            }
+            next += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    if(!changed)
+    {
+        return false;
+    }
+    Log(LogLevel::INFO, "sh3_config: %s changed, reloading.", path.c_str());
+    return Load() >= 0;
+    #else
+    return false;
+    #endif
 }
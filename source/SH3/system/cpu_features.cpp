@@ -0,0 +1,183 @@
+/** @file
+ *  Implementation of cpu_features.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/cpu_features.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(SH3_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(SH3_X86)
+#include <cpuid.h>
+#endif
+
+#include "SH3/system/config.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+namespace {
+    std::string simdOverride = "auto"; /**< The highest level to use, or "auto" for the best supported one. */
+
+    config_var<std::string> simdOverrideVar("cpu_simd", simdOverride);
+
+    constexpr int unresolved = -1;
+    std::atomic<int> currentLevel(unresolved); /**< The @ref simd_level in use, or @ref unresolved before it is first set or queried. */
+
+#ifdef SH3_X86
+    /**
+     *  The registers returned by @c cpuid.
+     */
+    struct cpuid_result final
+    {
+        std::uint32_t eax, ebx, ecx, edx;
+    };
+
+    /**
+     *  Run @c cpuid, returning zeroes for unsupported leaves.
+     */
+    cpuid_result CpuId(const std::uint32_t leaf, const std::uint32_t subleaf = 0)
+    {
+#ifdef _MSC_VER
+        int regs[4];
+        __cpuid(regs, 0);
+        if(static_cast<std::uint32_t>(regs[0]) < leaf)
+        {
+            return cpuid_result{0, 0, 0, 0};
+        }
+        __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+        return cpuid_result{static_cast<std::uint32_t>(regs[0]), static_cast<std::uint32_t>(regs[1]), static_cast<std::uint32_t>(regs[2]), static_cast<std::uint32_t>(regs[3])};
+#else
+        if(__get_cpuid_max(0, nullptr) < leaf)
+        {
+            return cpuid_result{0, 0, 0, 0};
+        }
+        cpuid_result result;
+        __cpuid_count(leaf, subleaf, result.eax, result.ebx, result.ecx, result.edx);
+        return result;
+#endif
+    }
+
+    /**
+     *  Get the register state the operating system saves on context switches (XCR0).
+     */
+    std::uint64_t GetSavedState()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        std::uint32_t low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return static_cast<std::uint64_t>(high) << 32 | low;
+#endif
+    }
+#endif
+
+    /**
+     *  Parse the config option @c cpu_simd.
+     *
+     *  @returns @c false if it names no level.
+     */
+    bool ParseLevel(const std::string &name, simd_level &level)
+    {
+        for(simd_level candidate : {simd_level::SCALAR, simd_level::SSE2, simd_level::SSE41, simd_level::AVX2, simd_level::AVX512})
+        {
+            if(name == GetSimdLevelName(candidate))
+            {
+                level = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+const char* sh3::system::GetSimdLevelName(const simd_level level)
+{
+    switch(level)
+    {
+    case simd_level::SCALAR:    return "scalar";
+    case simd_level::SSE2:      return "sse2";
+    case simd_level::SSE41:     return "sse4.1";
+    case simd_level::AVX2:      return "avx2";
+    case simd_level::AVX512:    return "avx512";
+    }
+    return "invalid";
+}
+
+simd_level sh3::system::DetectSimdLevel()
+{
+#ifdef SH3_X86
+    const cpuid_result basic = CpuId(1);
+    const cpuid_result extended = CpuId(7);
+
+    const bool sse2 = basic.edx & (1u << 26);
+    const bool sse41 = basic.ecx & (1u << 19);
+    const bool osxsave = basic.ecx & (1u << 27);
+    const bool avx = basic.ecx & (1u << 28);
+    const bool avx2 = extended.ebx & (1u << 5);
+    const bool avx512 = extended.ebx & (1u << 16);
+
+    // the wider registers are only usable if the operating system saves them
+    const std::uint64_t state = osxsave ? GetSavedState() : 0;
+    const bool ymmSaved = (state & 0x06) == 0x06;
+    const bool zmmSaved = (state & 0xE6) == 0xE6;
+
+    if(avx && avx2 && avx512 && zmmSaved)
+    {
+        return simd_level::AVX512;
+    }
+    if(avx && avx2 && ymmSaved)
+    {
+        return simd_level::AVX2;
+    }
+    if(sse41)
+    {
+        return simd_level::SSE41;
+    }
+    if(sse2)
+    {
+        return simd_level::SSE2;
+    }
+#endif
+    return simd_level::SCALAR;
+}
+
+simd_level sh3::system::ResolveSimdLevel()
+{
+    const simd_level detected = DetectSimdLevel();
+    simd_level requested = detected;
+    if(simdOverride != "auto" && !ParseLevel(simdOverride, requested))
+    {
+        Log(LogLevel::WARN, "Unknown cpu_simd \"%s\", using the best supported level.", simdOverride.c_str());
+        requested = detected;
+    }
+
+    const simd_level used = SetSimdLevel(requested);
+    Log(LogLevel::INFO, "CPU supports %s, kernels use %s.", GetSimdLevelName(detected), GetSimdLevelName(used));
+    return used;
+}
+
+simd_level sh3::system::GetSimdLevel()
+{
+    const int level = currentLevel.load(std::memory_order_relaxed);
+    if(level != unresolved)
+    {
+        return static_cast<simd_level>(level);
+    }
+
+    // not resolved (e.g. in tests); the best level then, without touching the config from what may be a worker
+    return SetSimdLevel(DetectSimdLevel());
+}
+
+simd_level sh3::system::SetSimdLevel(const simd_level level)
+{
+    const simd_level used = std::min(level, DetectSimdLevel());
+    currentLevel.store(static_cast<int>(used), std::memory_order_relaxed);
+    return used;
+}
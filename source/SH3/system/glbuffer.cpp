@@ -9,6 +9,7 @@
  *  @author Jesse Buhagiar
  */
 #include "SH3/system/glbuffer.hpp"
+#include "SH3/system/glcontext.hpp"
 #include "SH3/system/log.hpp"
 
 constexpr GLuint GL_VBO_UNBOUND = 0;
@@ -17,12 +18,18 @@ using namespace sh3_gl;
 
 void buffer_object::Create()
 {
-    glGenBuffers(1, &id);
+    // direct state access needs the object to exist, not just the name
+    if(HasDirectStateAccess())
+        glCreateBuffers(1, &id);
+    else
+        glGenBuffers(1, &id);
 }
 
 void buffer_object::Release()
 {
     glDeleteBuffers(1, &id);
+    charge.Set(0);
+    size = 0;
 }
 
 void buffer_object::Bind() const
@@ -37,16 +44,31 @@ void buffer_object::Unbind()
 
 void buffer_object::BufferData(void* data, GLsizei dataSize, GLenum usage)
 {
-    Bind();
-    glBufferData(static_cast<GLenum>(buffType), dataSize, data, usage);
+    if(HasDirectStateAccess())
+    {
+        glNamedBufferData(id, dataSize, data, usage);
+    }
+    else
+    {
+        Bind();
+        glBufferData(static_cast<GLenum>(buffType), dataSize, data, usage);
+    }
+    charge.Set(static_cast<std::size_t>(dataSize));
     size = dataSize;
 }
 
 void buffer_object::BufferSubData(void* data, GLsizei dataSize)
 {
     //ASSERT(dataSize <= size);
-    Bind();
-    glBufferSubData(static_cast<GLenum>(buffType), 0, dataSize, data);
+    if(HasDirectStateAccess())
+    {
+        glNamedBufferSubData(id, 0, dataSize, data);
+    }
+    else
+    {
+        Bind();
+        glBufferSubData(static_cast<GLenum>(buffType), 0, dataSize, data);
+    }
 }
 
 GLsizei buffer_object::GetNumberElements() const
@@ -9,9 +9,11 @@
  *
  *  @author Jesse Buhagiar
  */
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 
 #include "SH3/system/glcontext.hpp"
@@ -24,6 +26,11 @@
 
 using namespace sh3_gl;
 
+namespace
+{
+    bool directStateAccess = false; /**< Whether the context supports direct state access. */
+}
+
 context::context(sh3_window& hwnd)
 {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
@@ -45,6 +52,10 @@ context::context(sh3_window& hwnd)
     SDL_GL_SetAttribute(SDL_GL_BUFFER_SIZE, 32);
 
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+
+    GetExtensions();
+    directStateAccess = GLEW_VERSION_4_5 || HasExtension("GL_ARB_direct_state_access");
+    Log(LogLevel::INFO, "Direct state access: %s", directStateAccess ? "yes" : "no, binding objects to edit them");
 }
 
 const char* context::GetVendor() const
@@ -79,6 +90,11 @@ void context::GetExtensions()
     }
 }
 
+bool context::HasExtension(const char* name) const
+{
+    return std::any_of(extensions.begin(), extensions.end(), [name](const char* extension) { return std::strcmp(extension, name) == 0; });
+}
+
 void context::PrintInfo() const
 {
     Log(LogLevel::INFO, "GL_VENDOR:\t %s", GetVendor());
@@ -95,6 +111,11 @@ const char* context::GlGetString(GLenum name)
     return reinterpret_cast<const char*>(glGetString(name));
 }
 
+bool sh3_gl::HasDirectStateAccess()
+{
+    return directStateAccess;
+}
+
 glm::mat4 context::GetProjectionMatrix(float fov, int width, int height, float near, float far)
 {
     return glm::perspective(fov, static_cast<float>(width) / static_cast<float>(height), near, far);
@@ -52,7 +52,53 @@ std::string program::load_error::message() const
     return error;
 }
 
+namespace
+{
+/**
+ *  Read a shader source file.
+ *
+ *  @param fname The path of the file.
+ *
+ *  @returns The source, empty if the file couldn't be opened.
+ */
+std::string ReadShaderFile(const std::string& fname)
+{
+    std::ifstream       source;     // Handle to the shader program source
+    std::string         ssource;    // Temporary source string to read into
+    std::string         line;
+
+    source.open(fname);
+
+    if(!source.is_open())
+    {
+        //TODO: default shader fallback.
+        Log(LogLevel::ERROR, "program::ReadSource( ): Unable to open a handle to %s!", fname.c_str());
+        return ssource;
+    }
+
+    while(!source.eof())
+    {
+        std::getline(source, line);
+        ssource += line + "\n";
+    }
+
+    return ssource;
+}
+}
+
+program::source program::ReadSource(const std::string& shader)
+{
+    source src{ReadShaderFile("data/shaders/" + shader + ".vert"), ReadShaderFile("data/shaders/" + shader + ".frag")};
+    src.charge.Set(src.vertex.capacity() + src.fragment.capacity());
+    return src;
+}
+
 void program::Load(const std::string& shader, load_error& err, const std::vector<std::string>& attribs)
+{
+    Load(shader, ReadSource(shader), err, attribs);
+}
+
+void program::Load(const std::string& shader, const source& src, load_error& err, const std::vector<std::string>& attribs)
 {
     GLenum status = 0;
 
@@ -60,8 +106,8 @@ void program::Load(const std::string& shader, load_error& err, const std::vector
     programID = glCreateProgram();
 
     // Generate our vertex and fragment shader
-    vertShader = Compile(GL_VERTEX_SHADER);
-    fragShader = Compile(GL_FRAGMENT_SHADER);
+    vertShader = Compile(GL_VERTEX_SHADER, src.vertex);
+    fragShader = Compile(GL_FRAGMENT_SHADER, src.fragment);
 
     glAttachShader(programID, vertShader);
     glAttachShader(programID, fragShader);
@@ -130,25 +176,20 @@ void program::Unbind()
 }
 
 // TODO: Unfuck this function! It looks like a pile of shit (and acts like one too)..
-GLuint program::Compile(GLenum type)
+GLuint program::Compile(GLenum type, const std::string& text)
 {
     GLint   status; // Used to check compilation status
     GLuint  id;     // ID of this shader
 
-    std::ifstream       source;     // Handle to the shader program source
-    std::string         ssource;    // Temporary source string to read into
-    std::string         fname;      // Name of the file we want to open
-    std::string         line;
+    std::string         fname;      // Name of the file the source came from
     std::vector<GLchar> errorLog;   // Error log
 
     if(type == GL_VERTEX_SHADER)
     {
-        id = glCreateShader(GL_VERTEX_SHADER); // Generate a shader ID
         fname = "data/shaders/" + programName + ".vert";
     }
     else if(type == GL_FRAGMENT_SHADER)
     {
-        id = glCreateShader(GL_FRAGMENT_SHADER); // Generate a shader ID
         fname = "data/shaders/" + programName + ".frag";
     }
     else
@@ -156,22 +197,15 @@ GLuint program::Compile(GLenum type)
         die("glprogram::Compile( ): Only GL_VERTEX and GL_FRAGMENT shader programs are supported!");
     }
 
-    source.open(fname);
-
-    if(!source.is_open())
+    if(text.empty())
     {
         //TODO: default shader fallback.
-        Log(LogLevel::ERROR, "program::Compile( ): Unable to open a handle to %s!", fname.c_str());
         return BAD_SHADER; // 0 is the 'bad shader' or rather one that is unbound.
     }
 
-    while(!source.eof())
-    {
-        std::getline(source, line);
-        ssource += line + "\n";
-    }
+    id = glCreateShader(type); // Generate a shader ID
 
-    const GLchar* csource = ssource.c_str();
+    const GLchar* csource = text.c_str();
     glShaderSource(id, 1, &csource, nullptr);
     glCompileShader(id);
 
@@ -9,6 +9,7 @@
  *  @author Jesse Buhagiar
  */
 #include "SH3/system/glvertarray.hpp"
+#include "SH3/system/glcontext.hpp"
 #include "SH3/system/log.hpp"
 
 constexpr int   GL_VAO_UNBIND = 0;
@@ -17,7 +18,49 @@ using namespace sh3_gl;
 
 void finalvao::Create()
 {
-    glGenVertexArrays(1, &id);
+    if(HasDirectStateAccess())
+        glCreateVertexArrays(1, &id);
+    else
+        glGenVertexArrays(1, &id);
+}
+
+void finalvao::SetAttribute(GLuint slot, const buffer_object& buffer, GLenum type, GLint size, GLsizei stride, GLint offset)
+{
+    if(HasDirectStateAccess())
+    {
+        // unlike glVertexAttribPointer, a binding doesn't work out the stride of tightly packed attributes itself
+        if(stride == 0)
+            stride = size * TypeSize(type);
+
+        glEnableVertexArrayAttrib(id, slot);
+        glVertexArrayVertexBuffer(id, slot, buffer.GetID(), offset, stride);
+        glVertexArrayAttribFormat(id, slot, size, type, GL_FALSE, 0);
+        glVertexArrayAttribBinding(id, slot, slot);
+        return;
+    }
+
+    Bind();
+    glEnableVertexAttribArray(slot);
+    buffer.Bind();
+    glVertexAttribPointer(slot, size, type, GL_FALSE, stride, static_cast<char*>(nullptr) + offset);
+}
+
+GLsizei finalvao::TypeSize(GLenum type)
+{
+    switch(type)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+        return 2;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return 4;
+    }
+    die("finalvao::TypeSize( ): Unknown attribute type %u", type);
 }
 
 void finalvao::Release()
@@ -1,6 +1,7 @@
 #include "SH3/system/input.hpp"
 
 #include <cstdint>
+#include <limits>
 #include <string>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -14,6 +15,37 @@
 
 using namespace sh3::system;
 
+constexpr input_system::action_id input_system::noAction;
+
+input_system::action_id input_system::Intern(const action &name)
+{
+    const action_hash hash = ActionHash(name.c_str());
+    const auto iter = actionIds.find(hash);
+    if(iter != actionIds.end())
+    {
+        if(actionNames[iter->second] != name)
+        {
+            // release builds would otherwise silently merge the two actions
+            Log(LogLevel::ERROR, "The actions \"%s\" and \"%s\" have the same hash; rename one of them.", actionNames[iter->second].c_str(), name.c_str());
+            return noAction;
+        }
+        return iter->second;
+    }
+
+    ASSERT(actionStates.size() < noAction);
+    const auto id = static_cast<action_id>(actionStates.size());
+    actionStates.emplace_back();
+    actionNames.push_back(name);
+    actionIds.emplace(hash, id);
+    return id;
+}
+
+input_system::action_id input_system::Find(const action_hash hash) const
+{
+    const auto iter = actionIds.find(hash);
+    return iter != actionIds.end() ? iter->second : noAction;
+}
+
 void input_system::action_state::StartUpdate()
 {
     #ifdef INPUT_PROVIDE_TIMING
@@ -31,14 +63,7 @@ void input_system::action_state::EndUpdate(const timestamp stamp)
     #ifndef INPUT_PROVIDE_TIMING
         static_cast<void>(stamp);
     #else
-        if(Is(state::PRESSED))
-        {
-            timing.absolute.pressedTime = stamp - lastTimestamp;
-        }
-        else
-        {
-            timing.absolute.releasedTime = stamp - lastTimestamp;
-        }
+        AddTime(stamp);
 
         const time_delta deltaTime = timing.absolute.pressedTime + timing.absolute.releasedTime;
         if(deltaTime == time_delta::zero())
@@ -51,11 +76,10 @@ void input_system::action_state::EndUpdate(const timestamp stamp)
             //note: we have to cache these locally, because they are in an union
             const auto pressedTime  = timing.absolute.pressedTime.count();
             const auto releasedTime = timing.absolute.releasedTime.count();
-            timing.relative.pressedTimeRatio  = static_cast<float>(pressedTime  / deltaTime.count());
-            timing.relative.releasedTimeRatio = static_cast<float>(releasedTime / deltaTime.count());
+            const auto totalTime    = static_cast<float>(deltaTime.count());
+            timing.relative.pressedTimeRatio  = static_cast<float>(pressedTime)  / totalTime;
+            timing.relative.releasedTimeRatio = static_cast<float>(releasedTime) / totalTime;
         }
-
-        lastTimestamp = stamp;
     #endif
 
     #ifdef INPUT_PROVIDE_COUNT
@@ -68,8 +92,7 @@ void input_system::action_state::Set(const timestamp stamp, const state::simple
     #ifndef INPUT_PROVIDE_TIMING
         static_cast<void>(stamp);
     #else
-        timing.absolute.releasedTime += stamp - lastTimestamp;
-        lastTimestamp = stamp;
+        AddTime(stamp);
     #endif
     #ifdef INPUT_PROVIDE_COUNT
         ++count.numChanges;
@@ -78,17 +101,39 @@ void input_system::action_state::Set(const timestamp stamp, const state::simple
     value.Set(new_state);
 }
 
+#ifdef INPUT_PROVIDE_TIMING
+void input_system::action_state::AddTime(const timestamp stamp)
+{
+    // the time before the first sample isn't spent in any state; don't count it all the way from the epoch
+    if(lastTimestamp == timestamp())
+    {
+        lastTimestamp = stamp;
+        return;
+    }
+
+    // events from a previous frame may arrive late; don't count time twice
+    if(stamp > lastTimestamp)
+    {
+        (Is(state::PRESSED) ? timing.absolute.pressedTime : timing.absolute.releasedTime) += stamp - lastTimestamp;
+        lastTimestamp = stamp;
+    }
+}
+#endif
+
 input_system::raw::raw(const std::string &name)
 {
-    constexpr auto mouseButtonString = "Mouse Button ";
+    static constexpr char mouseButtonString[] = "Mouse Button ";
     if(boost::algorithm::starts_with(name, mouseButtonString))
     {
         try
         {
-            std::size_t button = std::stoul(name.substr(boost::extent<decltype(mouseButtonString)>::value));
-            rawType = type::MOUSE_BUTTON;
-            mouseButton = static_cast<decltype(mouseButton)>(SDL_BUTTON(button));
-            return;
+            std::size_t button = std::stoul(name.substr(boost::extent<decltype(mouseButtonString)>::value - 1));
+            if(button > 0 && button <= std::numeric_limits<decltype(mouseButton)>::max())
+            {
+                rawType = type::MOUSE_BUTTON;
+                mouseButton = static_cast<decltype(mouseButton)>(button);
+                return;
+            }
         }
         catch(std::logic_error&)
         {
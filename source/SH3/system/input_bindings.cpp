@@ -0,0 +1,124 @@
+/** @file
+ *  Implementation of input_bindings.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/input_bindings.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "SH3/system/assert.hpp"
+
+using namespace sh3::system;
+
+constexpr std::size_t input_bindings::maxMouseButtons;
+constexpr std::size_t input_bindings::keySlots;
+constexpr std::size_t input_bindings::slotCount;
+constexpr input_bindings::slot input_bindings::noSlot;
+
+input_bindings::input_bindings()
+    : bindings(), offsets(), actions()
+{
+    offsets.fill(0);
+}
+
+input_bindings::slot input_bindings::SlotOf(const input_system::raw &input)
+{
+    if(input.IsKeyboardKey())
+    {
+        return KeySlot(input.GetScancode());
+    }
+    if(input.IsMouseButton())
+    {
+        return MouseButtonSlot(input.GetMouseButton());
+    }
+    return noSlot;
+}
+
+bool input_bindings::Bind(const input_system::raw &input, const action_id id)
+{
+    const slot index = SlotOf(input);
+    if(index == noSlot || id == input_system::noAction)
+    {
+        return false;
+    }
+
+    const auto binding = std::make_pair(index, id);
+    const auto pos = std::lower_bound(bindings.begin(), bindings.end(), binding);
+    if(pos == bindings.end() || *pos != binding)
+    {
+        bindings.insert(pos, binding);
+        Rebuild();
+    }
+    return true;
+}
+
+void input_bindings::Unbind(const input_system::raw &input, const action_id id)
+{
+    const auto binding = std::make_pair(SlotOf(input), id);
+    const auto pos = std::lower_bound(bindings.begin(), bindings.end(), binding);
+    if(pos != bindings.end() && *pos == binding)
+    {
+        bindings.erase(pos);
+        Rebuild();
+    }
+}
+
+void input_bindings::Clear()
+{
+    bindings.clear();
+    Rebuild();
+}
+
+void input_bindings::Rebuild()
+{
+    ASSERT(bindings.size() < std::numeric_limits<std::uint16_t>::max());
+
+    actions.clear();
+    actions.reserve(bindings.size());
+
+    // bindings are sorted by slot, so the actions of each slot end up contiguous
+    auto binding = bindings.cbegin();
+    for(std::size_t index = 0; index < slotCount; ++index)
+    {
+        offsets[index] = static_cast<std::uint16_t>(actions.size());
+        for(; binding != bindings.cend() && binding->first == index; ++binding)
+        {
+            actions.push_back(binding->second);
+        }
+    }
+    offsets[noSlot] = static_cast<std::uint16_t>(actions.size());
+}
+
+bool input_bindings::Dispatch(const SDL_Event &event, input_system &input, const input_system::timestamp stamp) const
+{
+    action_range bound;
+    input_system::state newState;
+
+    switch(event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        if(event.key.repeat)
+        {
+            return true;
+        }
+        bound = Lookup(event.key.keysym.scancode);
+        newState = event.type == SDL_KEYDOWN ? input_system::state::PRESSED : input_system::state::RELEASED;
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        bound = LookupMouseButton(event.button.button);
+        newState = event.type == SDL_MOUSEBUTTONDOWN ? input_system::state::PRESSED : input_system::state::RELEASED;
+        break;
+    default:
+        return false;
+    }
+
+    for(const action_id id : bound)
+    {
+        input.SetAction(id, newState, stamp);
+    }
+    return true;
+}
@@ -0,0 +1,220 @@
+/** @file
+ *  Implementation of input_record.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/input_record.hpp"
+
+#include <cstring>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+namespace {
+    constexpr char magic[4] = {'S', 'H', '3', 'I'};
+    constexpr std::uint16_t version = 2;
+
+    /** Event type of the end-of-frame records. SDL never sends events of this type. */
+    constexpr Uint32 endOfFrame = SDL_FIRSTEVENT;
+
+    /**
+     *  Get the number of bytes of an @c SDL_Event that need to be stored.
+     */
+    std::uint8_t EventSize(const SDL_Event &event)
+    {
+        static_assert(sizeof(SDL_Event) <= 255, "length must fit into a byte");
+
+        std::size_t size;
+        switch(event.type)
+        {
+        case endOfFrame:
+        case SDL_QUIT:
+            size = sizeof(SDL_CommonEvent);
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            size = sizeof(SDL_KeyboardEvent);
+            break;
+        case SDL_MOUSEMOTION:
+            size = sizeof(SDL_MouseMotionEvent);
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            size = sizeof(SDL_MouseButtonEvent);
+            break;
+        case SDL_MOUSEWHEEL:
+            size = sizeof(SDL_MouseWheelEvent);
+            break;
+        default:
+            size = sizeof(SDL_Event);
+            break;
+        }
+        return static_cast<std::uint8_t>(size);
+    }
+
+    template<typename T>
+    void WriteValue(std::ofstream &file, const T &value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    bool ReadValue(std::ifstream &file, T &value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+}
+
+input_recorder::input_recorder(const std::string &path)
+    : file(path, std::ios::binary | std::ios::trunc)
+{
+    if(!file)
+    {
+        Log(LogLevel::ERROR, "input_recorder: Unable to open %s for writing!", path.c_str());
+        return;
+    }
+
+    file.write(magic, sizeof(magic));
+    WriteValue(file, version);
+    WriteValue(file, static_cast<std::uint16_t>(sizeof(SDL_Event)));
+}
+
+void input_recorder::Write(const SDL_Event &event, const input_system::timestamp stamp)
+{
+    const std::uint8_t length = EventSize(event);
+    WriteValue(file, frame);
+    WriteValue(file, static_cast<std::int64_t>(stamp.time_since_epoch().count()));
+    WriteValue(file, length);
+    file.write(reinterpret_cast<const char*>(&event), length);
+}
+
+void input_recorder::Record(const SDL_Event &event, const input_system::timestamp stamp)
+{
+    ASSERT(event.type != endOfFrame);
+    Write(event, stamp);
+}
+
+void input_recorder::EndFrame(const input_system::timestamp stamp)
+{
+    SDL_Event marker;
+    std::memset(&marker, 0, sizeof(marker));
+    marker.type = endOfFrame;
+    Write(marker, stamp);
+
+    ++frame;
+}
+
+std::string input_replay::load_error::message() const
+{
+    std::string error;
+    switch(result)
+    {
+    case load_result::SUCCESS:
+        error = "Success";
+        break;
+    case load_result::FILE_NOT_FOUND:
+        error = "File not found";
+        break;
+    case load_result::BAD_HEADER:
+        error = "Bad header";
+        break;
+    case load_result::TRUNCATED:
+        error = "Truncated file";
+        break;
+    }
+    return error;
+}
+
+input_replay::input_replay(const std::string &path, load_error &err)
+    : file(path, std::ios::binary), next(), nextStamp()
+{
+    if(!file)
+    {
+        Log(LogLevel::ERROR, "input_replay: Unable to open %s!", path.c_str());
+        err.set_error(load_result::FILE_NOT_FOUND);
+        finished = true;
+        return;
+    }
+
+    char fileMagic[sizeof(magic)];
+    std::uint16_t fileVersion, eventSize;
+    if(!file.read(fileMagic, sizeof(fileMagic)) || !ReadValue(file, fileVersion) || !ReadValue(file, eventSize))
+    {
+        err.set_error(load_result::TRUNCATED);
+        finished = true;
+        return;
+    }
+    if(std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || fileVersion != version || eventSize != sizeof(SDL_Event))
+    {
+        Log(LogLevel::ERROR, "input_replay: %s is not a recording of this build (version %u, event size %u)!", path.c_str(), fileVersion, eventSize);
+        err.set_error(load_result::BAD_HEADER);
+        finished = true;
+        return;
+    }
+
+    ReadNext();
+}
+
+void input_replay::ReadNext()
+{
+    if(!ReadValue(file, nextFrame))
+    {
+        if(file.gcount() != 0)
+        {
+            Log(LogLevel::WARN, "input_replay: Truncated record after frame %u.", frame);
+        }
+        finished = true;
+        return;
+    }
+
+    std::int64_t stamp;
+    std::uint8_t length;
+    if(!ReadValue(file, stamp) || !ReadValue(file, length))
+    {
+        Log(LogLevel::WARN, "input_replay: Truncated record in frame %u.", nextFrame);
+        finished = true;
+        return;
+    }
+
+    std::memset(&next, 0, sizeof(next));
+    if(length > sizeof(next) || !file.read(reinterpret_cast<char*>(&next), length))
+    {
+        Log(LogLevel::WARN, "input_replay: Bad record in frame %u.", nextFrame);
+        finished = true;
+    }
+    nextStamp = input_system::timestamp(input_system::action_state::time_delta(stamp));
+}
+
+bool input_replay::PollEvent(SDL_Event &event, input_system::timestamp &stamp)
+{
+    if(finished || nextFrame != frame || next.type == endOfFrame)
+    {
+        return false;
+    }
+
+    event = next;
+    stamp = nextStamp;
+    ReadNext();
+    return true;
+}
+
+input_system::timestamp input_replay::EndFrame()
+{
+    SDL_Event skipped;
+    input_system::timestamp skippedStamp;
+    while(PollEvent(skipped, skippedStamp))
+    {
+    }
+
+    input_system::timestamp stamp;
+    if(!finished && nextFrame == frame && next.type == endOfFrame)
+    {
+        stamp = nextStamp;
+        ReadNext();
+    }
+
+    ++frame;
+    return stamp;
+}
@@ -0,0 +1,57 @@
+/** @file
+ *  Implementation of input_sampler.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/input_sampler.hpp"
+
+#include <chrono>
+
+#include <SDL_timer.h>
+
+using namespace sh3::system;
+
+constexpr std::size_t input_sampler::queueSize;
+
+std::size_t input_sampler::Pump()
+{
+    SDL_PumpEvents();
+    const input_system::timestamp stamp = perf_clock::now();
+
+    std::size_t count = 0;
+    sample next;
+    next.stamp = stamp;
+    while(!samples.IsFull())
+    {
+        if(SDL_PeepEvents(&next.event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) <= 0)
+        {
+            return count;
+        }
+        samples.Push(next);
+        ++count;
+    }
+
+    if(SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT))
+    {
+        ++deferred;
+    }
+    return count;
+}
+
+void input_sampler::PumpUntil(const input_system::timestamp deadline, const perf_clock::duration interval)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    for(auto now = perf_clock::now(); now < deadline; now = perf_clock::now())
+    {
+        Pump();
+
+        const perf_clock::duration left = deadline - perf_clock::now();
+        const auto sleep = duration_cast<milliseconds>(left < interval ? left : interval).count();
+        if(sleep > 0)
+        {
+            SDL_Delay(static_cast<Uint32>(sleep));
+        }
+    }
+}
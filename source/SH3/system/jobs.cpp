@@ -0,0 +1,387 @@
+/** @file
+ *  Implementation of jobs.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/jobs.hpp"
+
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/config.hpp"
+#include "SH3/system/linear_allocator.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+constexpr std::size_t job_system::dequeCapacity;
+constexpr std::size_t job_system::chunksPerWorker;
+
+namespace {
+    unsigned jobThreads = 0;        /**< Number of workers, 0 for one per core. */
+    bool jobPinThreads = true;      /**< Whether to pin the workers to a core each. */
+
+    config_var<unsigned> jobThreadsVar("job_threads", jobThreads, 0, 256);
+    config_var<bool> jobPinThreadsVar("job_pin_threads", jobPinThreads);
+
+    constexpr unsigned spinsBeforeSleep = 64; /**< Failed attempts to find a job before a worker goes to sleep. */
+    constexpr unsigned noOwner = ~0u;         /**< Owner of jobs allocated outside the pool. */
+
+    /**
+     *  Pin a thread to a core.
+     */
+    void PinThread(std::thread &thread, const unsigned core)
+    {
+        #ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        if(pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus) != 0)
+        {
+            Log(LogLevel::WARN, "job_system: Unable to pin a worker to core %u.", core);
+        }
+        #else
+        static_cast<void>(thread);
+        static_cast<void>(core);
+        #endif
+    }
+}
+
+/**
+ *  A scheduled piece of work.
+ */
+struct job_counter::job final
+{
+    job_system::job_function function;  /**< The work. */
+    job_counter *counter;               /**< Finished after @ref function ran, if any. */
+    job *next;                          /**< The next released job of the owner. */
+    unsigned owner;                     /**< Index of the worker that allocated this, or @ref noOwner. */
+};
+
+/**
+ *  A thread of the pool.
+ */
+struct job_system::worker final
+{
+    job_system *system;                                 /**< The pool this belongs to. */
+    unsigned index;                                     /**< Position in @ref job_system::workers. */
+    unsigned victim;                                    /**< Where to start looking for jobs to steal. */
+    work_stealing_deque<job*, dequeCapacity> jobs;      /**< Jobs run from this worker. */
+    std::thread thread;                                 /**< The thread; not joinable for the constructing thread. */
+    job *freeJobs;                                      /**< Released jobs allocated by this worker; only touched by itself. */
+    std::atomic<job*> returnedJobs;                     /**< Jobs of this worker released by other threads, taken over when @ref freeJobs runs out. */
+};
+
+namespace {
+    /** The worker the calling thread is, if any. */
+    thread_local void *currentWorker = nullptr;
+}
+
+job_system::job_system(const unsigned threadCount)
+{
+    unsigned count = threadCount != 0 ? threadCount : jobThreads;
+    if(count == 0)
+    {
+        count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    workers.reserve(count);
+    for(unsigned i = 0; i < count; ++i)
+    {
+        workers.emplace_back(new worker{this, i, i + 1, {}, {}, nullptr, {nullptr}});
+    }
+
+    ASSERT_MSG(currentWorker == nullptr, "The thread constructing a job_system must not be a worker already");
+    currentWorker = workers.front().get();
+
+    for(unsigned i = 1; i < count; ++i)
+    {
+        worker &self = *workers[i];
+        self.thread = std::thread([this, &self]() { currentWorker = &self; WorkerLoop(self); });
+        if(jobPinThreads)
+        {
+            PinThread(self.thread, i % std::max(std::thread::hardware_concurrency(), 1u));
+        }
+    }
+}
+
+job_system::~job_system()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stop = true;
+    }
+    wake.notify_all();
+
+    for(auto &self : workers)
+    {
+        if(self->thread.joinable())
+        {
+            self->thread.join();
+        }
+    }
+    currentWorker = nullptr;
+
+    if(queued != 0)
+    {
+        Log(LogLevel::WARN, "job_system: %zu jobs were never run.", queued.load());
+    }
+    for(auto &self : workers)
+    {
+        while(job *work = self->jobs.Pop())
+        {
+            delete work;
+        }
+    }
+    for(job *work : injected)
+    {
+        delete work;
+    }
+    for(auto &self : workers)
+    {
+        for(job *work : {self->freeJobs, self->returnedJobs.load()})
+        {
+            while(work)
+            {
+                job *next = work->next;
+                delete work;
+                work = next;
+            }
+        }
+    }
+}
+
+auto job_system::CurrentWorker() const -> worker*
+{
+    worker *self = static_cast<worker*>(currentWorker);
+    return self && self->system == this ? self : nullptr;
+}
+
+auto job_system::AllocateJob() -> job*
+{
+    worker *self = CurrentWorker();
+    if(!self)
+    {
+        return new job{nullptr, nullptr, nullptr, noOwner};
+    }
+
+    if(!self->freeJobs)
+    {
+        self->freeJobs = self->returnedJobs.exchange(nullptr, std::memory_order_acquire);
+    }
+    job *work = self->freeJobs;
+    if(!work)
+    {
+        return new job{nullptr, nullptr, nullptr, self->index};
+    }
+    self->freeJobs = work->next;
+    return work;
+}
+
+void job_system::ReleaseJob(job *work)
+{
+    if(work->owner == noOwner)
+    {
+        delete work;
+        return;
+    }
+
+    worker &owner = *workers[work->owner];
+    if(&owner == CurrentWorker())
+    {
+        work->next = owner.freeJobs;
+        owner.freeJobs = work;
+        return;
+    }
+
+    // The owner only ever takes the whole list, so pushing can't run into ABA.
+    work->next = owner.returnedJobs.load(std::memory_order_relaxed);
+    while(!owner.returnedJobs.compare_exchange_weak(work->next, work, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+void job_system::Run(job_function function, job_counter *counter, job_counter *after)
+{
+    job *work = AllocateJob();
+    work->function = std::move(function);
+    work->counter = counter;
+
+    if(counter)
+    {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if(after)
+    {
+        // checked under the lock, so that it cannot finish between the check and adding the job
+        std::lock_guard<std::mutex> lock(after->mutex);
+        if(after->pending.load(std::memory_order_acquire) != 0)
+        {
+            after->waiting.push_back(work);
+            return;
+        }
+    }
+
+    Submit(work);
+}
+
+void job_system::Submit(job *work)
+{
+    // count the job before publishing it, or a thief's decrement could wrap the counter
+    ++queued;
+
+    worker *self = CurrentWorker();
+    if(self)
+    {
+        if(!self->jobs.Push(work))
+        {
+            // too much queued already; running it right away is the best we can do
+            --queued;
+            Execute(work);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        injected.push_back(work);
+        ++injectedCount;
+    }
+
+    if(sleeping != 0)
+    {
+        // lock so the notification can't slip in between a worker checking for jobs and sleeping
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+auto job_system::FindJob(worker *self) -> job*
+{
+    job *work = self ? self->jobs.Pop() : nullptr;
+
+    if(!work && injectedCount != 0)
+    {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        if(!injected.empty())
+        {
+            work = injected.front();
+            injected.pop_front();
+            --injectedCount;
+        }
+    }
+
+    if(!work)
+    {
+        const std::size_t count = workers.size();
+        const std::size_t start = self ? self->victim : 0;
+        for(std::size_t i = 0; i < count && !work; ++i)
+        {
+            worker &victim = *workers[(start + i) % count];
+            if(&victim != self)
+            {
+                work = victim.jobs.Steal();
+                if(work && self)
+                {
+                    // come back to the same victim first, it probably has more
+                    self->victim = victim.index;
+                }
+            }
+        }
+    }
+
+    if(work)
+    {
+        --queued;
+    }
+    return work;
+}
+
+void job_system::Execute(job *work)
+{
+    {
+        // temporaries of a job die with it
+        transient_scope scope;
+        work->function();
+    }
+    work->function = nullptr;
+
+    job_counter *counter = work->counter;
+    ReleaseJob(work);
+
+    if(counter)
+    {
+        // decrement under the lock: once the counter reads as done, a waiter may destroy it right after taking the lock itself
+        std::vector<job*> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+            if(counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                ready.swap(counter->waiting);
+            }
+        }
+        for(job *next : ready)
+        {
+            Submit(next);
+        }
+    }
+}
+
+void job_system::WorkerLoop(worker &self)
+{
+    unsigned spins = 0;
+    while(!stop)
+    {
+        if(job *work = FindJob(&self))
+        {
+            Execute(work);
+            spins = 0;
+            continue;
+        }
+
+        if(++spins < spinsBeforeSleep)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        ++sleeping;
+        wake.wait(lock, [this]() { return stop || queued != 0; });
+        --sleeping;
+        spins = 0;
+    }
+}
+
+void job_system::Wait(const job_counter &counter)
+{
+    worker *self = CurrentWorker();
+    while(!counter.IsDone())
+    {
+        if(job *work = FindJob(self))
+        {
+            Execute(work);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool job_system::RunPending()
+{
+    job *work = FindJob(CurrentWorker());
+    if(!work)
+    {
+        return false;
+    }
+    Execute(work);
+    return true;
+}
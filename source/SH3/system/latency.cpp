@@ -0,0 +1,208 @@
+/** @file
+ *  Implementation of latency.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/latency.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+constexpr std::size_t latency_tracker::defaultHistory;
+constexpr std::size_t latency_tracker::maxPendingFrames;
+
+namespace {
+    /**
+     *  Get the @p percent percentile of sorted samples (nearest rank).
+     */
+    latency_tracker::duration Percentile(const std::vector<latency_tracker::duration> &sorted, const std::size_t percent)
+    {
+        const std::size_t rank = (sorted.size() * percent + 99) / 100;
+        return sorted[rank > 0 ? rank - 1 : 0];
+    }
+
+    double Milliseconds(const latency_tracker::duration time)
+    {
+        return std::chrono::duration<double, std::milli>(time).count();
+    }
+}
+
+latency_tracker::latency_tracker(const std::size_t historySize)
+    : history(historySize), samples(), next(), pending(), useFences(GLEW_VERSION_3_2 || GLEW_ARB_sync), tag()
+{
+    for(auto &stageSamples : samples)
+    {
+        stageSamples.reserve(history);
+    }
+    if(!useFences)
+    {
+        Log(LogLevel::INFO, "latency_tracker: No fence support, GPU completion will not be measured.");
+    }
+}
+
+latency_tracker::~latency_tracker()
+{
+    Reset();
+}
+
+void latency_tracker::Input(const timestamp stamp)
+{
+    if(!tagged || stamp < tag)
+    {
+        tag = stamp;
+        tagged = true;
+    }
+}
+
+void latency_tracker::Submit()
+{
+    if(!tagged)
+    {
+        return;
+    }
+
+    Record(SUBMIT, tag, perf_clock::now());
+    if(useFences && !submitFence)
+    {
+        submitFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void latency_tracker::Swap()
+{
+    if(!tagged)
+    {
+        return;
+    }
+
+    Record(SWAP, tag, perf_clock::now());
+    if(submitFence)
+    {
+        if(pendingCount == maxPendingFrames)
+        {
+            // the GPU is hopelessly behind or the fence got lost; drop the oldest
+            glDeleteSync(pending[pendingFirst].fence);
+            pendingFirst = (pendingFirst + 1) % maxPendingFrames;
+            --pendingCount;
+        }
+        pending[(pendingFirst + pendingCount) % maxPendingFrames] = pending_frame{tag, submitFence};
+        ++pendingCount;
+        submitFence = nullptr;
+    }
+    tagged = false;
+}
+
+void latency_tracker::Poll()
+{
+    while(pendingCount > 0)
+    {
+        const pending_frame &frame = pending[pendingFirst];
+        const GLenum status = glClientWaitSync(frame.fence, 0, 0);
+        if(status == GL_TIMEOUT_EXPIRED)
+        {
+            // frames complete in order, so the later ones are not done either
+            return;
+        }
+        if(status != GL_WAIT_FAILED)
+        {
+            Record(GPU, frame.input, perf_clock::now());
+        }
+        glDeleteSync(frame.fence);
+        pendingFirst = (pendingFirst + 1) % maxPendingFrames;
+        --pendingCount;
+    }
+}
+
+void latency_tracker::Record(const stage which, const timestamp input, const timestamp now)
+{
+    std::vector<duration> &stageSamples = samples[which];
+    const duration latency = now - input;
+    if(stageSamples.size() < history)
+    {
+        stageSamples.push_back(latency);
+    }
+    else
+    {
+        stageSamples[next[which]] = latency;
+    }
+    next[which] = (next[which] + 1) % history;
+}
+
+latency_tracker::distribution latency_tracker::GetDistribution(const stage which) const
+{
+    distribution result;
+    std::vector<duration> sorted = samples[which];
+    if(sorted.empty())
+    {
+        return result;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    duration total = duration::zero();
+    for(const duration latency : sorted)
+    {
+        total += latency;
+    }
+
+    result.count = sorted.size();
+    result.min = sorted.front();
+    result.mean = total / static_cast<duration::rep>(sorted.size());
+    result.median = Percentile(sorted, 50);
+    result.p95 = Percentile(sorted, 95);
+    result.p99 = Percentile(sorted, 99);
+    result.max = sorted.back();
+    return result;
+}
+
+const char* latency_tracker::GetStageName(const stage which)
+{
+    switch(which)
+    {
+    case SUBMIT:        return "submit";
+    case SWAP:          return "swap";
+    case GPU:           return "gpu";
+    case STAGE_COUNT:   break;
+    }
+    return "invalid";
+}
+
+void latency_tracker::Report() const
+{
+    for(std::size_t i = 0; i < STAGE_COUNT; ++i)
+    {
+        const char *name = GetStageName(static_cast<stage>(i));
+        const distribution dist = GetDistribution(static_cast<stage>(i));
+        if(dist.count == 0)
+        {
+            Log(LogLevel::INFO, "latency input->%s: no samples", name);
+            continue;
+        }
+        Log(LogLevel::INFO, "latency input->%s: %zu frames, min %.2f, mean %.2f, median %.2f, p95 %.2f, p99 %.2f, max %.2f ms",
+            name, dist.count, Milliseconds(dist.min), Milliseconds(dist.mean), Milliseconds(dist.median),
+            Milliseconds(dist.p95), Milliseconds(dist.p99), Milliseconds(dist.max));
+    }
+}
+
+void latency_tracker::Reset()
+{
+    for(auto &stageSamples : samples)
+    {
+        stageSamples.clear();
+    }
+    next.fill(0);
+    for(; pendingCount > 0; --pendingCount)
+    {
+        glDeleteSync(pending[pendingFirst].fence);
+        pendingFirst = (pendingFirst + 1) % maxPendingFrames;
+    }
+    if(submitFence)
+    {
+        glDeleteSync(submitFence);
+        submitFence = nullptr;
+    }
+    tagged = false;
+}
@@ -0,0 +1,84 @@
+/** @file
+ *  Implementation of linear_allocator.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/linear_allocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/config.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+namespace {
+    unsigned transientKiB = 4096; /**< Size of each thread's buffer. */
+
+    config_var<unsigned> transientKiBVar("transient_kib", transientKiB, 64);
+
+    /**
+     *  Round @p address up to a multiple of @p alignment.
+     */
+    std::uintptr_t Align(const std::uintptr_t address, const std::size_t alignment)
+    {
+        return (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    }
+}
+
+linear_allocator::linear_allocator(const std::size_t bufferCapacity):
+    capacity(bufferCapacity), buffer(), overflow()
+{
+}
+
+void* linear_allocator::Allocate(const std::size_t size, const std::size_t alignment)
+{
+    ASSERT_MSG(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+    if(!buffer)
+    {
+        buffer.reset(new char[capacity]);
+    }
+
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(buffer.get());
+    const std::size_t start = static_cast<std::size_t>(Align(base + offset, alignment) - base);
+    if(overflow.empty() && start <= capacity && capacity - start >= size)
+    {
+        offset = start + size;
+        highWater = std::max(highWater, offset);
+        return buffer.get() + start;
+    }
+
+    // keep going on the heap; once overflowing, stay there until rewound, so that the buffer remains a stack
+    if(!warned)
+    {
+        Log(LogLevel::WARN, "linear_allocator: Out of transient memory (%zu KiB), falling back to the heap. Consider raising transient_kib.", capacity / 1024);
+        warned = true;
+    }
+    overflow.emplace_back(new char[size + alignment - 1]);
+    return reinterpret_cast<void*>(Align(reinterpret_cast<std::uintptr_t>(overflow.back().get()), alignment));
+}
+
+void linear_allocator::Deallocate(void *memory, const std::size_t size)
+{
+    char *const bytes = static_cast<char*>(memory);
+    if(buffer && overflow.empty() && bytes >= buffer.get() && bytes + size == buffer.get() + offset)
+    {
+        offset = static_cast<std::size_t>(bytes - buffer.get());
+    }
+}
+
+void linear_allocator::Rewind(const marker position)
+{
+    // the latest allocation may have been given back early already, so this may be behind the marker
+    offset = std::min(offset, position.offset);
+    overflow.resize(std::min(overflow.size(), position.overflows));
+}
+
+linear_allocator& linear_allocator::ForThread()
+{
+    thread_local linear_allocator allocator(static_cast<std::size_t>(transientKiB) * 1024);
+    return allocator;
+}
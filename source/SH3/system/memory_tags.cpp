@@ -0,0 +1,189 @@
+/** @file
+ *  Implementation of memory_tags.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/memory_tags.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+namespace {
+    constexpr std::size_t tagCount = static_cast<std::size_t>(memory_tag::MAX);
+
+    /**
+     *  The counters of one thread. Only written by their thread, read by @ref SampleMemory.
+     */
+    struct thread_counters final
+    {
+        std::array<std::atomic<std::uint64_t>, tagCount> allocated{};   /**< Bytes allocated per tag. */
+        std::array<std::atomic<std::uint64_t>, tagCount> freed{};       /**< Bytes freed per tag. */
+        std::array<std::atomic<std::uint64_t>, tagCount> allocations{}; /**< Allocations per tag. */
+    };
+
+    /**
+     *  All counters.
+     */
+    struct counter_registry final
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::mutex mutex{};                                     /**< Guards everything below. */
+        std::vector<thread_counters*> threads{};                /**< The counters of running threads. */
+        std::array<std::uint64_t, tagCount> retiredAllocated{}; /**< Bytes allocated by threads that have exited. */
+        std::array<std::uint64_t, tagCount> retiredFreed{};     /**< Bytes freed by threads that have exited. */
+        std::array<std::uint64_t, tagCount> retiredAllocations{}; /**< Allocations by threads that have exited. */
+        std::array<memory_stats, tagCount> stats{};             /**< As of the last sample. */
+        std::array<std::uint64_t, tagCount> lastAllocated{};    /**< Bytes allocated as of the last sample. */
+        clock::time_point lastSample = clock::now();            /**< When the last sample was taken. */
+    };
+
+    counter_registry& Registry()
+    {
+        // never destroyed, threads may exit after static destruction began
+        static counter_registry *registry = new counter_registry;
+        return *registry;
+    }
+
+    /**
+     *  Registers the counters of a thread while it runs.
+     */
+    struct thread_registration final
+    {
+        thread_registration() : counters()
+        {
+            counter_registry &registry = Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.threads.push_back(&counters);
+        }
+
+        ~thread_registration()
+        {
+            counter_registry &registry = Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for(std::size_t i = 0; i < tagCount; ++i)
+            {
+                registry.retiredAllocated[i] += counters.allocated[i].load(std::memory_order_relaxed);
+                registry.retiredFreed[i] += counters.freed[i].load(std::memory_order_relaxed);
+                registry.retiredAllocations[i] += counters.allocations[i].load(std::memory_order_relaxed);
+            }
+            registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &counters));
+        }
+
+        thread_registration(const thread_registration&) = delete;
+        thread_registration& operator=(const thread_registration&) = delete;
+
+        thread_counters counters; /**< The counters of the thread. */
+    };
+
+    thread_counters& Counters()
+    {
+        thread_local thread_registration registration;
+        return registration.counters;
+    }
+
+    /**
+     *  Add to a counter only the own thread writes.
+     */
+    void Add(std::atomic<std::uint64_t> &counter, const std::uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::size_t Index(const memory_tag tag)
+    {
+        const std::size_t index = static_cast<std::size_t>(tag);
+        ASSERT_CHEAP_MSG(index < tagCount, "Invalid memory tag");
+        return index;
+    }
+}
+
+const char* sh3::system::GetMemoryTagName(const memory_tag tag)
+{
+    switch(tag)
+    {
+    case memory_tag::ARC:           return "arc";
+    case memory_tag::TEXTURE:       return "texture";
+    case memory_tag::MESH:          return "mesh";
+    case memory_tag::AUDIO:         return "audio";
+    case memory_tag::SHADER:        return "shader";
+    case memory_tag::GPU_TEXTURE:   return "gpu texture";
+    case memory_tag::GPU_BUFFER:    return "gpu buffer";
+    case memory_tag::MAX:           break;
+    }
+    return "invalid";
+}
+
+void sh3::system::TrackAllocation(const memory_tag tag, const std::size_t bytes)
+{
+    thread_counters &counters = Counters();
+    const std::size_t index = Index(tag);
+    Add(counters.allocated[index], bytes);
+    Add(counters.allocations[index], 1);
+}
+
+void sh3::system::TrackFree(const memory_tag tag, const std::size_t bytes)
+{
+    Add(Counters().freed[Index(tag)], bytes);
+}
+
+void sh3::system::SampleMemory()
+{
+    counter_registry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    const counter_registry::clock::time_point now = counter_registry::clock::now();
+    const double seconds = std::chrono::duration<double>(now - registry.lastSample).count();
+    registry.lastSample = now;
+
+    for(std::size_t i = 0; i < tagCount; ++i)
+    {
+        std::uint64_t allocated = registry.retiredAllocated[i];
+        std::uint64_t freed = registry.retiredFreed[i];
+        std::uint64_t allocations = registry.retiredAllocations[i];
+        for(const thread_counters *counters : registry.threads)
+        {
+            allocated += counters->allocated[i].load(std::memory_order_relaxed);
+            freed += counters->freed[i].load(std::memory_order_relaxed);
+            allocations += counters->allocations[i].load(std::memory_order_relaxed);
+        }
+
+        memory_stats &stats = registry.stats[i];
+        stats.current = static_cast<std::int64_t>(allocated - freed);
+        stats.peak = std::max(stats.peak, stats.current);
+        stats.allocations = allocations;
+        stats.rate = seconds > 0.0 ? static_cast<double>(allocated - registry.lastAllocated[i]) / seconds : 0.0;
+        registry.lastAllocated[i] = allocated;
+    }
+}
+
+memory_stats sh3::system::GetMemoryStats(const memory_tag tag)
+{
+    counter_registry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.stats[Index(tag)];
+}
+
+void sh3::system::DumpMemoryStats()
+{
+    SampleMemory();
+
+    Log(LogLevel::INFO, "Memory by subsystem:");
+    Log(LogLevel::INFO, "  %-12s %12s %12s %12s %12s", "tag", "current KiB", "peak KiB", "allocations", "KiB/s");
+    for(std::size_t i = 0; i < tagCount; ++i)
+    {
+        const memory_tag tag = static_cast<memory_tag>(i);
+        const memory_stats stats = GetMemoryStats(tag);
+        Log(LogLevel::INFO, "  %-12s %12lld %12lld %12llu %12.1f", GetMemoryTagName(tag), static_cast<long long>(stats.current / 1024),
+            static_cast<long long>(stats.peak / 1024), static_cast<unsigned long long>(stats.allocations), stats.rate / 1024.0);
+    }
+}
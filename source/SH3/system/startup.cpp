@@ -0,0 +1,195 @@
+/** @file
+ *  Implementation of startup.hpp
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#include "SH3/system/startup.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#include "SH3/system/assert.hpp"
+#include "SH3/system/log.hpp"
+
+using namespace sh3::system;
+
+/**
+ *  A step of startup.
+ */
+struct startup_graph::step final
+{
+    const char *name;                               /**< Shown by @ref Report. */
+    std::function<void()> function;                 /**< The work. */
+    std::vector<step_index> dependencies;           /**< Steps that must be done first. */
+    affinity where;                                 /**< Where it may run. */
+    std::vector<step*> dependents;                  /**< Steps waiting for this one. */
+    std::atomic<std::size_t> remaining;             /**< Dependencies not done yet. */
+    bool onMain;                                    /**< Whether it ran on the main thread. */
+    perf_clock::time_point start;                   /**< When it started. */
+    perf_clock::time_point end;                     /**< When it finished. */
+};
+
+namespace {
+    /**
+     *  Convert a point in time to milliseconds since @p origin.
+     */
+    double Milliseconds(const perf_clock::time_point origin, const perf_clock::time_point time)
+    {
+        return std::chrono::duration<double, std::milli>(time - origin).count();
+    }
+}
+
+startup_graph::startup_graph() = default;
+startup_graph::~startup_graph() = default;
+
+auto startup_graph::Add(const char *name, std::function<void()> function, std::vector<step_index> dependencies, const affinity where) -> step_index
+{
+    for(const step_index dependency : dependencies)
+    {
+        // only earlier steps, which keeps the graph free of cycles
+        ASSERT_MSG(dependency < steps.size(), "A startup step can only depend on steps added before it");
+        static_cast<void>(dependency);
+    }
+
+    steps.emplace_back(new step{name, std::move(function), std::move(dependencies), where, {}, {0}, false, {}, {}});
+    return steps.size() - 1;
+}
+
+void startup_graph::Run(job_system &jobs)
+{
+    runJobs = &jobs;
+    finished = 0;
+    for(auto &current : steps)
+    {
+        current->dependents.clear();
+    }
+    for(auto &current : steps)
+    {
+        current->remaining = current->dependencies.size();
+        for(const step_index dependency : current->dependencies)
+        {
+            steps[dependency]->dependents.push_back(current.get());
+        }
+    }
+
+    startTime = perf_clock::now();
+    for(auto &current : steps)
+    {
+        if(current->dependencies.empty())
+        {
+            Schedule(*current);
+        }
+    }
+
+    // keep the main thread free for the steps that need it, unless nobody else would run the others
+    const bool help = jobs.GetWorkerCount() == 1;
+    while(finished != steps.size())
+    {
+        if(mainQueue.RunAll() == 0 && !(help && jobs.RunPending()))
+        {
+            std::this_thread::yield();
+        }
+    }
+    endTime = perf_clock::now();
+    runJobs = nullptr;
+}
+
+void startup_graph::Schedule(step &ready)
+{
+    if(ready.where == affinity::MAIN)
+    {
+        mainQueue.Run([this, &ready]() { ready.onMain = true; Execute(ready); });
+    }
+    else
+    {
+        runJobs->Run([this, &ready]() { Execute(ready); });
+    }
+}
+
+void startup_graph::Execute(step &current)
+{
+    current.start = perf_clock::now();
+    current.function();
+    current.end = perf_clock::now();
+
+    for(step *dependent : current.dependents)
+    {
+        if(--dependent->remaining == 0)
+        {
+            Schedule(*dependent);
+        }
+    }
+    ++finished;
+}
+
+void startup_graph::Report() const
+{
+    if(steps.empty())
+    {
+        return;
+    }
+
+    std::vector<bool> critical(steps.size(), false);
+    for(const step_index index : GetCriticalPath())
+    {
+        critical[index] = true;
+    }
+
+    double sequential = 0.0;
+    double criticalTotal = 0.0;
+    Log(LogLevel::INFO, "Startup timeline (ms, * = critical path):");
+    Log(LogLevel::INFO, "  %-24s %9s %9s %9s  %s", "step", "start", "end", "duration", "thread");
+    for(std::size_t i = 0; i < steps.size(); ++i)
+    {
+        const step &current = *steps[i];
+        const double duration = Milliseconds(current.start, current.end);
+        sequential += duration;
+        if(critical[i])
+        {
+            criticalTotal += duration;
+        }
+        Log(LogLevel::INFO, "%c %-24s %9.2f %9.2f %9.2f  %s", critical[i] ? '*' : ' ', current.name,
+            Milliseconds(startTime, current.start), Milliseconds(startTime, current.end), duration, current.onMain ? "main" : "worker");
+    }
+    Log(LogLevel::INFO, "Startup took %.2f ms, the critical path %.2f ms; run one after another the steps take %.2f ms.",
+        Milliseconds(startTime, endTime), criticalTotal, sequential);
+}
+
+auto startup_graph::GetCriticalPath() const -> std::vector<step_index>
+{
+    std::vector<step_index> path;
+    if(steps.empty())
+    {
+        return path;
+    }
+
+    // walk back from the step that finished last, always through the dependency that finished last
+    const auto last = std::max_element(steps.begin(), steps.end(), [](const std::unique_ptr<step> &a, const std::unique_ptr<step> &b) { return a->end < b->end; });
+    step_index current = static_cast<step_index>(last - steps.begin());
+    for(;;)
+    {
+        path.push_back(current);
+
+        const std::vector<step_index> &dependencies = steps[current]->dependencies;
+        if(dependencies.empty())
+        {
+            break;
+        }
+        current = *std::max_element(dependencies.begin(), dependencies.end(), [this](const step_index a, const step_index b) { return steps[a]->end < steps[b]->end; });
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+auto startup_graph::GetTimings() const -> std::vector<step_timing>
+{
+    std::vector<step_timing> timings;
+    timings.reserve(steps.size());
+    for(const auto &current : steps)
+    {
+        timings.push_back(step_timing{current->name, current->end - current->start});
+    }
+    return timings;
+}
@@ -23,8 +23,8 @@ Revision History:
 #include "SH3/system/glcontext.hpp"
 #include "SH3/system/window.hpp"
 
-sh3_window::sh3_window(int width, int height, const std::string& title)
-    : hwnd(SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_UNDEFINED,SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL))
+sh3_window::sh3_window(int width, int height, const std::string& title, Uint32 flags)
+    : hwnd(SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_UNDEFINED,SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL | flags))
     , context(*this)
 {
     context.PrintInfo();
@@ -7,7 +7,11 @@
  */
 
 #include "SH3/arc/mft.hpp"
+#include "SH3/camera/camera.hpp"
+#include "SH3/system/alloc_hooks.hpp"
+#include "SH3/system/benchmark.hpp"
 #include "SH3/system/config.hpp"
+#include "SH3/system/cpu_features.hpp"
 #include "SH3/system/exit_code.hpp"
 #include "SH3/system/log.hpp"
 #include "SH3/system/window.hpp"
@@ -16,9 +20,20 @@
 #include "SH3/graphics/texture.hpp"
 #include "SH3/system/glbuffer.hpp"
 #include "SH3/system/glvertarray.hpp"
+#include "SH3/system/input.hpp"
+#include "SH3/system/input_bindings.hpp"
+#include "SH3/system/input_sampler.hpp"
+#include "SH3/system/jobs.hpp"
+#include "SH3/system/latency.hpp"
+#include "SH3/system/linear_allocator.hpp"
+#include "SH3/system/memory_tags.hpp"
+#include "SH3/system/startup.hpp"
 #include "SH3/types/vertex.hpp"
 #include <SDL.h>
+#include <array>
+#include <chrono>
 #include <cstdio>
+#include <memory>
 
 static GLfloat g_vertex_buffer_data[] = {
    -1.0f, -1.0f, 0.0f,
@@ -58,10 +73,14 @@ public:
 };
 constexpr sh3_gl::vao_target_array<TriangleAttributes::Slot> TriangleAttributes::Targets;
 
+static constexpr float moveSpeed = 4.0f;    /**< Units per second the camera moves while an action is held. */
+static constexpr float turnSpeed = 90.0f;   /**< Degrees per second the camera turns while an action is held. */
+static constexpr float lookSpeed = 0.3f;    /**< Degrees the camera turns per pixel of mouse movement. */
+
 /**
  *  Entry point to the program.
  *
- *  @note Requires @c argc and @c argv to make it compatible with SDL2.
+ *  Without arguments the game runs normally; see benchmark.hpp for running a benchmark instead.
  *
  *  @param argc Number of arguments.
  *  @param argv Argument vector.
@@ -70,23 +89,61 @@ constexpr sh3_gl::vao_target_array<TriangleAttributes::Slot> TriangleAttributes:
  */
 int main(int argc, char** argv)
 {
-    static_cast<void>(argc);
-    static_cast<void>(argv);
-
-//    sh3::arc:: mft;
-
     Log(LogLevel::INFO, "===SILENT HILL 3 REDUX===");
     Log(LogLevel::INFO, "Copyright 2016-2017 Palm Studios\n");
 
-    sh3_window window(640, 480, "sh3redux");
+    sh3::system::benchmark_settings benchmarkSettings;
+    if(!sh3::system::ParseBenchmarkArguments(argc, argv, benchmarkSettings))
+    {
+        return static_cast<int>(exit_code::DEATH);
+    }
+    const Uint32 windowFlags = benchmarkSettings.headless ? SDL_WINDOW_HIDDEN : 0;
+
+    using Triangle = sh3_gl::vao<TriangleAttributes>;
+    using affinity = sh3::system::startup_graph::affinity;
 
-    bool quit = false;
-    SDL_Event e;
+    // before anything reads an option, the job system sizing its pool included
+    sh3_config config;
+    config.Load();
+    sh3::system::ResolveSimdLevel();
 
+    sh3::system::job_system jobs;
+    std::unique_ptr<sh3_window> window;
+    sh3_gl::program::source testSource;
     sh3_gl::program::load_error err;
-    sh3_gl::program test("test", err);
+    std::unique_ptr<sh3_gl::program> test;
 
-    using Triangle = sh3_gl::vao<TriangleAttributes>;
+    // everything that doesn't need the GL context runs on the workers while the window comes up
+    sh3::system::startup_graph startup;
+    const auto shaderSources = startup.Add("shader sources", [&testSource]() { testSource = sh3_gl::program::ReadSource("test"); });
+    const auto windowCreate = startup.Add("window and context", [&window, windowFlags]() { window.reset(new sh3_window(640, 480, "sh3redux", windowFlags)); }, {}, affinity::MAIN);
+    startup.Add("shader compile", [&]() { test.reset(new sh3_gl::program("test", testSource, err)); }, {windowCreate, shaderSources}, affinity::MAIN);
+    startup.Run(jobs);
+    startup.Report();
+
+    if(err)
+    {
+        Log(LogLevel::ERROR, "Unable to load shader test: %s", err.message().c_str());
+        return static_cast<int>(exit_code::DEATH);
+    }
+
+    config.Watch();
+
+    std::unique_ptr<sh3::system::benchmark_run> benchmark;
+    if(!benchmarkSettings.name.empty())
+    {
+        benchmark.reset(new sh3::system::benchmark_run(benchmarkSettings, startup));
+        if(!benchmark->IsGood())
+        {
+            return static_cast<int>(exit_code::DEATH);
+        }
+        if(benchmarkSettings.headless)
+        {
+            SDL_GL_SetSwapInterval(0);
+        }
+    }
+
+    bool quit = false;
 
     Triangle triVao;
 
@@ -102,19 +159,131 @@ int main(int argc, char** argv)
 
     triVao.Unbind();
 
+    using state = sh3::system::input_system::state;
+    enum { FORWARD, BACK, TURN_LEFT, TURN_RIGHT, DUMP_MEMORY, ACTION_COUNT };
+    sh3::system::input_system input;
+    const std::array<sh3::system::input_system::action_id, ACTION_COUNT> actions =
+    {{
+        input.Intern("Forward"),
+        input.Intern("Back"),
+        input.Intern("Turn Left"),
+        input.Intern("Turn Right"),
+        input.Intern("Dump Memory Stats"),
+    }};
+    sh3::system::input_bindings bindings;
+    bindings.Bind(SDL_SCANCODE_W, actions[FORWARD]);
+    bindings.Bind(SDL_SCANCODE_UP, actions[FORWARD]);
+    bindings.Bind(SDL_SCANCODE_S, actions[BACK]);
+    bindings.Bind(SDL_SCANCODE_DOWN, actions[BACK]);
+    bindings.Bind(SDL_SCANCODE_A, actions[TURN_LEFT]);
+    bindings.Bind(SDL_SCANCODE_LEFT, actions[TURN_LEFT]);
+    bindings.Bind(SDL_SCANCODE_D, actions[TURN_RIGHT]);
+    bindings.Bind(SDL_SCANCODE_RIGHT, actions[TURN_RIGHT]);
+    bindings.Bind(SDL_SCANCODE_F9, actions[DUMP_MEMORY]);
+    // whole frames only; the fraction of a frame an action was held depends on the wall clock, which a replay must not
+    const auto held = [&input](const sh3::system::input_system::action_id id)
+    {
+        return id != sh3::system::input_system::noAction && input[id].Is(state::PRESSED) ? 1.0f : 0.0f;
+    };
+    sh3::system::input_sampler sampler; // pumped and polled on this thread, for its stamps
+    sh3::system::input_sampler::sample sample;
+
+    sh3::camera::Camera cam(glm::vec3(0.0f), angle<float>::FromDegrees(60.0f), 640.0f / 480.0f, 0.001f, 100.0f);
+    cam.SetPosition(glm::vec3(3.0f, 4.0f, 3.0f));
+    cam.LookAt(glm::vec3(0.0f));
+    cam.SetMode(sh3::camera::MODE::FIRST_PERSON);
+    const GLint mvpLocation = glGetUniformLocation(test->GetProgramID(), "mvp");
+
+    // a benchmark advances by its fixed timestep, so a replay moves the camera the same way on every run
+    sh3::system::perf_clock::time_point lastTime = benchmark ? benchmark->GetTime() : sh3::system::perf_clock::now();
+
+    sh3::system::frame_allocation_check allocationCheck;
+    sh3::system::latency_tracker latency;
+
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     while(!quit)
     {
-        while(SDL_PollEvent(&e) != 0)
+        sh3::system::linear_allocator::ForThread().Reset(); // last frame's temporaries are dead
+        config.Poll();
+        sh3::system::SampleMemory();
+        latency.Poll();
+
+        // a benchmark drains the devices itself, so the sampler only runs without one
+        const sh3::system::perf_clock::time_point frameStart = sh3::system::perf_clock::now();
+        if(!benchmark)
+            sampler.Pump();
+
+        int mouseX = 0, mouseY = 0;
+        int wheelX = 0, wheelY = 0;
+        input.StartUpdateActions();
+        while(benchmark ? benchmark->PollEvent(sample.event) : sampler.Poll(sample))
         {
-            if(e.type == SDL_QUIT)
+            const SDL_Event &e = sample.event;
+            if(benchmark)
+                sample.stamp = frameStart; // replayed input counts as arriving at the start of the frame
+            if(e.type == SDL_KEYDOWN || e.type == SDL_KEYUP || e.type == SDL_MOUSEMOTION || e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP)
+                latency.Input(sample.stamp);
+
+            switch(e.type)
+            {
+            case SDL_QUIT:
                 quit = true;
+                break;
+            case SDL_MOUSEMOTION:
+                mouseX += e.motion.xrel;
+                mouseY += e.motion.yrel;
+                break;
+            case SDL_MOUSEWHEEL:
+                wheelX += e.wheel.x;
+                wheelY += e.wheel.y;
+                break;
+            default:
+                bindings.Dispatch(e, input, sample.stamp);
+                break;
+            }
         }
+        input.SetMovementDelta(vector2{static_cast<double>(mouseX), static_cast<double>(mouseY)}, vector2{static_cast<double>(wheelX), static_cast<double>(wheelY)});
+        input.EndUpdateActions(sh3::system::perf_clock::now());
+
+        if(actions[DUMP_MEMORY] != sh3::system::input_system::noAction && input[actions[DUMP_MEMORY]].Became(state::PRESSED))
+            sh3::system::DumpMemoryStats();
+
+        const sh3::system::perf_clock::time_point time = benchmark ? benchmark->GetTime() : frameStart;
+        const float delta = std::chrono::duration<float>(time - lastTime).count();
+        lastTime = time;
+        cam.Translate((held(actions[FORWARD]) - held(actions[BACK])) * moveSpeed * delta);
+        cam.AddYaw(angle<float>::FromDegrees((held(actions[TURN_RIGHT]) - held(actions[TURN_LEFT])) * turnSpeed * delta + static_cast<float>(mouseX) * lookSpeed));
+        cam.AddPitch(angle<float>::FromDegrees(static_cast<float>(-mouseY) * lookSpeed));
 
+        if(benchmark)
+            benchmark->BeginPass("scene");
         glClear(GL_COLOR_BUFFER_BIT);
-        test.Bind();
+        test->Bind();
+        const glm::mat4 mvp = cam.GetViewProjectionMatrix();
+        glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, &mvp[0][0]);
         triVao.Draw();
-        SDL_GL_SwapWindow(window.hwnd.get());
+        if(benchmark)
+            benchmark->EndPass();
+        latency.Submit();
+        SDL_GL_SwapWindow(window->hwnd.get());
+        latency.Swap();
+        allocationCheck.EndFrame();
+
+        if(benchmark && !benchmark->EndFrame())
+            quit = true;
+    }
+
+    latency.Report();
+    if(benchmark && !benchmark->Finish(latency))
+    {
+        return static_cast<int>(exit_code::DEATH);
+    }
+
+    // the frames that allocated have been logged; only a benchmark fails on them
+    if(benchmark && !allocationCheck.Passed())
+    {
+        Log(LogLevel::ERROR, "%u frames allocated after warming up.", allocationCheck.GetFailedFrames());
+        return static_cast<int>(exit_code::BENCHMARK_FAILED);
     }
 
     return static_cast<int>(exit_code::SUCCESS);
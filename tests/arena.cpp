@@ -0,0 +1,167 @@
+/** @file
+ *  Test of the @ref sh3::system::arena.
+ *
+ *  Checks alignment, allocations that don't fit into a block, that @ref sh3::system::arena::Reset destroys objects
+ *  in reverse order and reuses the first block, containers using an @ref sh3::system::arena_allocator, and
+ *  allocating from several threads.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/system/arena.hpp"
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::system::arena;
+    using sh3::system::arena_allocator;
+    using sh3::system::arena_string;
+    using sh3::system::arena_vector;
+
+    constexpr std::size_t blockSize = 4096;
+
+    bool IsAligned(const void *memory, const std::size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(memory) % alignment == 0;
+    }
+
+    /**
+     *  Notes the order it is destroyed in.
+     */
+    struct tracked final
+    {
+        tracked(std::vector<int> &destroyedOrder, const int trackedId): order(destroyedOrder), id(trackedId) {}
+        ~tracked() { order.push_back(id); }
+
+        tracked(const tracked&) = delete;
+        tracked& operator=(const tracked&) = delete;
+
+        std::vector<int> &order;    /**< Where to note the destruction. */
+        int id;                     /**< What to note. */
+    };
+
+    struct alignas(64) overaligned final
+    {
+        char data[64];
+    };
+
+    bool TestAlignment()
+    {
+        bool ok = true;
+        arena memory("test", blockSize);
+
+        bool aligned = true;
+        for(const std::size_t alignment : {1u, 2u, 8u, 16u, 64u, 256u})
+        {
+            aligned &= IsAligned(memory.Allocate(3, alignment), alignment);
+        }
+        ok &= Check(aligned, "allocations have the alignment asked for");
+        ok &= Check(IsAligned(memory.New<overaligned>(), alignof(overaligned)), "objects have their alignment");
+        ok &= Check(memory.GetUsed() >= 6 * 3 + sizeof(overaligned), "padding counts as used");
+
+        return ok;
+    }
+
+    bool TestOverflow()
+    {
+        bool ok = true;
+        arena memory("test", blockSize);
+
+        char *small = static_cast<char*>(memory.Allocate(blockSize - 16, 1));
+        char *next = static_cast<char*>(memory.Allocate(64, 1));
+        ok &= Check(next < small || next >= small + blockSize - 16, "a full block continues in a new one");
+
+        char *large = static_cast<char*>(memory.Allocate(blockSize * 4, 64));
+        std::memset(large, 0xAB, blockSize * 4);
+        ok &= Check(IsAligned(large, 64) && large[blockSize * 4 - 1] == static_cast<char>(0xAB), "allocations larger than a block fit");
+
+        arena_vector<int> values{arena_allocator<int>(memory)};
+        for(int i = 0; i < 10000; ++i)
+        {
+            values.push_back(i);
+        }
+        const arena_string text("longer than any small string buffer", arena_allocator<char>(memory));
+        ok &= Check(values[9999] == 9999 && text.size() == 35, "containers grow beyond a block");
+
+        return ok;
+    }
+
+    bool TestReset()
+    {
+        bool ok = true;
+        std::vector<int> order;
+        arena memory("test", blockSize);
+
+        void *first = memory.Allocate(16);
+        memory.New<tracked>(order, 0);
+        memory.New<tracked>(order, 1);
+        memory.Allocate(blockSize * 2);
+        memory.New<tracked>(order, 2);
+        const std::size_t highWater = memory.GetHighWater();
+
+        memory.Reset();
+        ok &= Check(order == std::vector<int>{2, 1, 0}, "reset destroys objects in reverse order");
+        ok &= Check(memory.GetUsed() == 0 && memory.GetHighWater() == highWater, "reset frees everything, keeps the high-water");
+        ok &= Check(memory.Allocate(16) == first, "the first block is reused");
+
+        memory.Reset();
+        ok &= Check(order.size() == 3, "objects are only destroyed once");
+
+        return ok;
+    }
+
+    bool TestThreads()
+    {
+        constexpr int allocations = 10000;
+        constexpr std::size_t size = 16;
+        arena memory("test", blockSize);
+
+        std::vector<char*> found[2];
+        std::thread workers[2];
+        for(int t = 0; t < 2; ++t)
+        {
+            workers[t] = std::thread([&memory, &found, t]()
+            {
+                for(int i = 0; i < allocations; ++i)
+                {
+                    char *bytes = static_cast<char*>(memory.Allocate(size, size));
+                    std::memset(bytes, t, size);
+                    found[t].push_back(bytes);
+                }
+            });
+        }
+        for(std::thread &worker : workers)
+        {
+            worker.join();
+        }
+
+        bool intact = true;
+        for(int t = 0; t < 2; ++t)
+        {
+            for(const char *bytes : found[t])
+            {
+                intact &= bytes[0] == t && bytes[size - 1] == t;
+            }
+        }
+        return Check(intact && memory.GetUsed() == 2 * allocations * size, "threads allocate without overlapping");
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestAlignment();
+    ok &= TestOverflow();
+    ok &= TestReset();
+    ok &= TestThreads();
+
+    return sh3::test::ExitCode(ok);
+}
@@ -0,0 +1,157 @@
+/** @file
+ *  Test of the ray queries of the collision @ref sh3::collision::bvh.
+ *
+ *  Casts rays at a tiled ramp: rays into empty space (including the space inside the bounding boxes) and rays grazing
+ *  the ramp must miss, also when they are unbounded, and random rays must find the same triangle as testing every
+ *  triangle.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/collision/bvh.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::collision::bvh;
+    using sh3::collision::hit;
+    using sh3::collision::ray;
+    using sh3::collision::triangle;
+
+    constexpr float unbounded = std::numeric_limits<float>::infinity();
+    constexpr int tiles = 8;
+    constexpr float slope = 0.25f;
+
+    /**
+     *  Height of the ramp.
+     */
+    float Height(const float x)
+    {
+        return x * slope;
+    }
+
+    /**
+     *  A ramp from (0, 0) to (@ref tiles, @ref tiles) rising along x, two triangles per tile.
+     *
+     *  It is sloped so the bounding boxes have some volume a ray can pass through without hitting anything.
+     */
+    std::vector<triangle> Ramp()
+    {
+        std::vector<triangle> ramp;
+        for(int z = 0; z < tiles; ++z)
+        {
+            for(int x = 0; x < tiles; ++x)
+            {
+                const glm::vec3 corner(static_cast<float>(x), Height(static_cast<float>(x)), static_cast<float>(z));
+                ramp.push_back(triangle{corner, corner + glm::vec3(1.0f, slope, 0.0f), corner + glm::vec3(1.0f, slope, 1.0f)});
+                ramp.push_back(triangle{corner, corner + glm::vec3(1.0f, slope, 1.0f), corner + glm::vec3(0.0f, 0.0f, 1.0f)});
+            }
+        }
+        return ramp;
+    }
+
+    /**
+     *  Find the closest hit by testing every triangle.
+     */
+    hit BruteForce(const std::vector<triangle> &triangles, const ray &query)
+    {
+        hit best;
+        best.distance = query.maxDistance;
+        for(std::size_t i = 0; i < triangles.size(); ++i)
+        {
+            const triangle &tri = triangles[i];
+            const glm::vec3 e1 = tri.v1 - tri.v0, e2 = tri.v2 - tri.v0;
+            const glm::vec3 p = glm::cross(query.direction, e2);
+            const float det = glm::dot(e1, p);
+            if(std::fabs(det) < 1e-7f)
+            {
+                continue;
+            }
+            const glm::vec3 s = query.origin - tri.v0;
+            const float u = glm::dot(s, p) / det;
+            const glm::vec3 q = glm::cross(s, e1);
+            const float v = glm::dot(query.direction, q) / det;
+            const float t = glm::dot(e2, q) / det;
+            if(u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t <= best.distance)
+            {
+                best.distance = t;
+                best.triangle = static_cast<std::uint32_t>(i);
+            }
+        }
+        return best;
+    }
+
+    bool TestEdgeCases(const bvh &hierarchy)
+    {
+        bool ok = true;
+        const glm::vec3 along(1.0f, slope, 0.0f);
+
+        const ray up{glm::vec3(4.0f, 5.0f, 4.0f), glm::vec3(0.0f, 1.0f, 0.0f), unbounded};
+        ok &= Check(!hierarchy.Raycast(up) && !hierarchy.RaycastAny(up), "unbounded ray into empty space misses");
+
+        const ray boxes{glm::vec3(4.5f, Height(4.5f) + 0.05f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f), unbounded};
+        ok &= Check(!hierarchy.Raycast(boxes) && !hierarchy.RaycastAny(boxes), "unbounded ray through the boxes misses");
+
+        const ray inPlane{glm::vec3(4.5f, Height(4.5f), -1.0f), glm::vec3(0.0f, 0.0f, 1.0f), unbounded};
+        ok &= Check(!hierarchy.Raycast(inPlane) && !hierarchy.RaycastAny(inPlane), "ray grazing along the ramp misses");
+
+        const ray above{glm::vec3(-1.0f, Height(-1.0f) + 1e-3f, 4.5f), along, unbounded};
+        ok &= Check(!hierarchy.Raycast(above) && !hierarchy.RaycastAny(above), "ray parallel above the ramp misses");
+
+        const ray shallow{glm::vec3(-1.0f, Height(-1.0f) + 1e-3f, 4.5f), along - glm::vec3(0.0f, 2e-4f, 0.0f), unbounded};
+        const hit skim = hierarchy.Raycast(shallow);
+        ok &= Check(skim && std::fabs(skim.distance - 5.0f) < 1e-2f && std::fabs(skim.point.y - Height(skim.point.x)) < 1e-4f, "shallow ray hits where it reaches the ramp");
+
+        const ray corner{glm::vec3(4.0f, Height(4.0f) + 1.0f, 4.0f), glm::vec3(0.0f, -1.0f, 0.0f), unbounded};
+        const hit down = hierarchy.Raycast(corner);
+        ok &= Check(down && std::fabs(down.distance - 1.0f) < 1e-6f && down.normal.y > 0.0f, "ray through a shared corner hits");
+
+        const ray tooShort{glm::vec3(4.5f, Height(4.5f) + 1.0f, 4.5f), glm::vec3(0.0f, -1.0f, 0.0f), 0.5f};
+        ok &= Check(!hierarchy.Raycast(tooShort) && !hierarchy.RaycastAny(tooShort), "ray ending above the ramp misses");
+
+        return ok;
+    }
+
+    bool TestRandom(const std::vector<triangle> &ramp, const bvh &hierarchy)
+    {
+        std::mt19937 random(76);
+        std::uniform_real_distribution<float> position(-2.0f, tiles + 2.0f), direction(-1.0f, 1.0f);
+
+        unsigned mismatches = 0;
+        for(int i = 0; i < 10000; ++i)
+        {
+            const ray query{glm::vec3(position(random), position(random) - tiles * 0.5f + Height(tiles * 0.5f), position(random)),
+                            glm::vec3(direction(random), direction(random), direction(random)),
+                            i % 2 == 0 ? unbounded : 5.0f};
+            const hit expected = BruteForce(ramp, query);
+            const hit found = hierarchy.Raycast(query);
+            if(static_cast<bool>(found) != static_cast<bool>(expected) || hierarchy.RaycastAny(query) != static_cast<bool>(expected)
+            || (found && std::fabs(found.distance - expected.distance) > 1e-4f))
+            {
+                ++mismatches;
+            }
+        }
+        return Check(mismatches == 0, "random rays match testing every triangle");
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    const std::vector<triangle> ramp = Ramp();
+    const bvh hierarchy(ramp);
+
+    bool ok = TestEdgeCases(hierarchy);
+    ok &= TestRandom(ramp, hierarchy);
+
+    return sh3::test::ExitCode(ok);
+}
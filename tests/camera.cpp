@@ -14,6 +14,7 @@
 #include "SH3/system/glprogram.hpp"
 #include "SH3/system/glbuffer.hpp"
 #include "SH3/system/glvertarray.hpp"
+#include "SH3/system/latency.hpp"
 #include "SDL2/SDL.h"
 #include "SH3/camera/camera.hpp"
 #include <cstdio>
@@ -112,13 +113,19 @@ int main(int argc, char** argv)
     bool forward = false;
     bool backward = false;
 
+    sh3::system::latency_tracker latency;
+
     while(!quit)
     {
+        latency.Poll();
         while(SDL_PollEvent(&e) != 0)
         {
             if(e.type == SDL_QUIT)
                 quit = true;
 
+            if(e.type == SDL_KEYDOWN || e.type == SDL_KEYUP || e.type == SDL_MOUSEMOTION)
+                latency.Input(sh3::system::perf_clock::FromTicks(e.common.timestamp));
+
             if(e.type == SDL_KEYDOWN)
             {
                 if(e.key.keysym.sym == SDLK_w || e.key.keysym.sym == SDLK_UP)
@@ -157,12 +164,16 @@ int main(int argc, char** argv)
 
         glClear(GL_COLOR_BUFFER_BIT);
         test.Bind();
-        glm::mat4 mvp = cam.GetProjectionMatrix() * model;
+        glm::mat4 mvp = cam.GetViewProjectionMatrix() * model;
         glUniformMatrix4fv(mID, 1, GL_FALSE, &mvp[0][0]);
         triVao.Draw();
+        latency.Submit();
         SDL_SetRelativeMouseMode(SDL_TRUE);
         SDL_GL_SwapWindow(window.hwnd.get());
+        latency.Swap();
     }
 
+    latency.Report();
+
     return static_cast<int>(exit_code::SUCCESS);
 }
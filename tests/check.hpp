@@ -0,0 +1,42 @@
+/** @file
+ *  Reporting of the checks done by the tests.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+#ifndef SH3_TESTS_CHECK_HPP_INCLUDED
+#define SH3_TESTS_CHECK_HPP_INCLUDED
+
+#include <cstdio>
+
+#include "SH3/system/exit_code.hpp"
+
+namespace sh3 { namespace test {
+
+    /**
+     *  Print the outcome of a check.
+     *
+     *  @param ok   Whether the check passed.
+     *  @param what What was checked.
+     *
+     *  @returns @p ok.
+     */
+    inline bool Check(const bool ok, const char *what)
+    {
+        std::printf("%-44s %s\n", what, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    /**
+     *  Get the exit status of a test.
+     *
+     *  @param ok Whether all checks passed.
+     *
+     *  @returns @ref exit_code::SUCCESS if @p ok, @ref exit_code::DEATH otherwise.
+     */
+    inline int ExitCode(const bool ok)
+    {
+        return static_cast<int>(ok ? exit_code::SUCCESS : exit_code::DEATH);
+    }
+} }
+
+#endif // SH3_TESTS_CHECK_HPP_INCLUDED
@@ -0,0 +1,125 @@
+/** @file
+ *  Test of the configuration file parser.
+ *
+ *  Loads a file with malformed lines, unknown keys and out-of-range values into @ref sh3::system::config_var%s and
+ *  checks that only the valid options are applied, then reloads a changed file.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/system/config.hpp"
+#include <cmath>
+#include <fstream>
+#include <string>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::system::config_var;
+    using sh3::system::ParseConfigValue;
+
+    constexpr const char *path = "config_test.cfg";
+
+    /**
+     *  Replace the test configuration file.
+     */
+    void WriteFile(const char *contents)
+    {
+        std::ofstream file(path);
+        file << contents;
+    }
+
+    bool TestParse()
+    {
+        bool ok = true;
+        int i = 0;
+        unsigned u = 0;
+        float f = 0.0f;
+        bool b = false;
+        std::string s;
+
+        ok &= Check(ParseConfigValue(" 12 ", i) && i == 12, "integers may be surrounded by whitespace");
+        ok &= Check(ParseConfigValue("0x10", i) && i == 16, "integers may be hexadecimal");
+        ok &= Check(!ParseConfigValue("12abc", i) && !ParseConfigValue("1e3", i) && !ParseConfigValue("", i), "trailing garbage is rejected");
+        ok &= Check(!ParseConfigValue("99999999999", i), "integers must fit into the type");
+        ok &= Check(!ParseConfigValue("-1", u) && !ParseConfigValue(" -0", u), "unsigned integers must not be negative");
+        ok &= Check(ParseConfigValue("-2.5", f) && std::fabs(f + 2.5f) < 1e-6f, "floats are parsed");
+        ok &= Check(!ParseConfigValue("nan", f) && !ParseConfigValue("inf", f) && !ParseConfigValue("1e39", f), "floats must be finite and fit");
+        ok &= Check(ParseConfigValue("on", b) && b && ParseConfigValue("0", b) && !b && !ParseConfigValue("maybe", b), "booleans take the documented words");
+        ok &= Check(ParseConfigValue("  two words ", s) && s == "two words", "strings are trimmed");
+        return ok;
+    }
+
+    bool TestLoad()
+    {
+        bool ok = true;
+
+        int threads = 1, spaced = 0, ranged = 50, big = 0;
+        unsigned negative = 5;
+        float ratio = 1.0f;
+        bool flag = false;
+        std::string name = "default";
+        const config_var<int> threadsVar("test_threads", threads, 1, 64);
+        const config_var<int> spacedVar("test_spaced", spaced);
+        const config_var<int> rangedVar("test_ranged", ranged, 0, 100);
+        const config_var<int> bigVar("test_big", big);
+        const config_var<unsigned> negativeVar("test_negative", negative);
+        const config_var<float> ratioVar("test_ratio", ratio);
+        const config_var<bool> flagVar("test_flag", flag);
+        const config_var<std::string> nameVar("test_name", name);
+
+        WriteFile("# comment\n"
+                  "$ also a comment\n"
+                  "\n"
+                  "test_threads 2\n"
+                  "test_threads 8\n"
+                  "test_no_value\n"
+                  "   test_spaced \t 3   \n"
+                  "test_flag yes\n"
+                  "test_ratio 0.5x\n"
+                  "test_big 99999999999\n"
+                  "test_negative -1\n"
+                  "test_ranged 200\n"
+                  "test_unknown 42\n"
+                  "test_name  hello world  \n");
+
+        sh3_config config(path);
+        const int options = config.Load();
+        ok &= Check(options == 10, "lines without a value are not counted");
+        ok &= Check(threads == 8 && spaced == 3 && flag && name == "hello world", "valid options are applied, the last one wins");
+        ok &= Check(std::fabs(ratio - 1.0f) < 1e-6f && big == 0 && negative == 5u, "malformed values keep the old value");
+        ok &= Check(ranged == 50, "values out of range keep the old value");
+        ok &= Check(config.GetOptionValue("test_no_value") == -1 && config.GetOptionValue("test_missing") == -1, "options without a value are unset");
+
+        ok &= Check(config.GetOptionValue("test_unknown") == 42, "unknown keys are kept");
+        int unknown = 0;
+        {
+            const config_var<int> unknownVar("test_unknown", unknown);
+            ok &= Check(unknown == 42, "variables registered later get their value");
+        }
+
+        WriteFile("test_threads 16\n"
+                  "test_ranged 100\n"
+                  "test_ratio\n");
+        ok &= Check(config.Load() == 2 && threads == 16 && ranged == 100, "reloading applies the new values");
+        ok &= Check(spaced == 3 && std::fabs(ratio - 1.0f) < 1e-6f, "options missing after reloading keep their value");
+
+        ok &= Check(sh3_config("config_test_missing.cfg").Load() == -1, "a missing file is reported");
+
+        std::remove(path);
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestParse();
+    ok &= TestLoad();
+
+    return sh3::test::ExitCode(ok);
+}
@@ -1,56 +1,96 @@
+#include <array>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <utility>
 
-#include <boost/container/flat_map.hpp>
-#include <boost/range/adaptor/map.hpp>
-
 #include <SDL.h>
 
 #include "SH3/system/input.hpp"
+#include "SH3/system/input_bindings.hpp"
+#include "SH3/system/input_record.hpp"
+#include "SH3/system/input_sampler.hpp"
 #include "SH3/system/window.hpp"
 
-using key_bindings = boost::container::flat_map<sh3::system::input_system::raw, sh3::system::input_system::action>;
+using key_bindings = sh3::system::input_bindings;
 
 namespace
 {
-    bool PollEvents(sh3::system::input_system &input, const key_bindings &bindings)
+    using sh3::system::input_system;
+
+    /**
+     *  Where events come from: the @ref sh3::system::input_sampler (optionally recording them), or a recording.
+     */
+    struct event_source
     {
-        using sh3::system::input_system;
+        sh3::system::input_sampler *sampler;
+        sh3::system::input_recorder *recorder;
+        sh3::system::input_replay *replay;
+
+        bool Poll(SDL_Event &sdlEvent, input_system::timestamp &stamp)
+        {
+            if(replay)
+            {
+                return replay->PollEvent(sdlEvent, stamp);
+            }
+            sh3::system::input_sampler::sample sample;
+            if(!sampler->Poll(sample))
+            {
+                return false;
+            }
+            sdlEvent = sample.event;
+            stamp = sample.stamp;
+            if(recorder)
+            {
+                recorder->Record(sdlEvent, stamp);
+            }
+            return true;
+        }
+
+        input_system::timestamp EndFrame()
+        {
+            if(replay)
+            {
+                return replay->EndFrame();
+            }
+            const auto now = sh3::system::perf_clock::now();
+            if(recorder)
+            {
+                recorder->EndFrame(now);
+            }
+            return now;
+        }
+    };
 
-        SDL_PumpEvents();
-        int mouseX, mouseY;
-        SDL_GetRelativeMouseState(&mouseX, &mouseY);
+    bool PollEvents(sh3::system::input_system &input, const key_bindings &bindings, event_source &source)
+    {
+        int mouseX = 0, mouseY = 0;
         int wheelX = 0, wheelY = 0;
 
         input.StartUpdateActions();
 
         SDL_Event sdlEvent;
-        while(SDL_PollEvent(&sdlEvent))
+        input_system::timestamp stamp;
+        while(source.Poll(sdlEvent, stamp))
         {
             switch(sdlEvent.type)
             {
             case SDL_QUIT:
                 return false;
-            //TODO: mouse buttons
+            case SDL_MOUSEMOTION:
+                mouseX += sdlEvent.motion.xrel;
+                mouseY += sdlEvent.motion.yrel;
+                break;
             case SDL_MOUSEWHEEL:
                 wheelX += sdlEvent.wheel.x;
                 wheelY += sdlEvent.wheel.y;
                 break;
             case SDL_KEYDOWN:
             case SDL_KEYUP:
-                if(sdlEvent.key.repeat)
-                {
-                    break;
-                }
-                {
-                    const auto binding = bindings.find(input_system::raw{sdlEvent.key.keysym.scancode});
-                    if(binding == end(bindings))
-                    {
-                        break;
-                    }
-                    const auto state = sdlEvent.type == SDL_KEYDOWN ? input_system::state::PRESSED : sh3::system::input_system::state::RELEASED;
-                    input.SetAction(binding->second, state, input_system::timestamp{sdlEvent.key.timestamp});
-                }
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                bindings.Dispatch(sdlEvent, input, stamp);
                 break;
             default:
                 break;
@@ -59,30 +99,73 @@ namespace
 
         input.SetMovementDelta(vector2{static_cast<double>(mouseX), static_cast<double>(mouseY)}, vector2{static_cast<double>(wheelX), static_cast<double>(wheelY)});
 
-        input.EndUpdateActions(input_system::action_state::sdl_clock::now());
+        input.EndUpdateActions(source.EndFrame());
 
         return true;
     }
 }
 
-int main()
+/**
+ *  Entry point to the program.
+ *
+ *  Usage: @c input [--record FILE | --replay FILE]
+ *
+ *  With @c --record the session is written to @c FILE.
+ *  With @c --replay the session in @c FILE is played back as fast as possible, without opening a window.
+ */
+int main(int argc, char **argv)
 {
-    SDL_Init(SDL_INIT_VIDEO);
-    sh3_window window{800, 600, "input test"};
-    sh3::system::input_system input;
+    std::unique_ptr<sh3::system::input_recorder> recorder;
+    std::unique_ptr<sh3::system::input_replay> replay;
+    if(argc == 3 && std::string(argv[1]) == "--record")
+    {
+        recorder.reset(new sh3::system::input_recorder(argv[2]));
+    }
+    else if(argc == 3 && std::string(argv[1]) == "--replay")
+    {
+        sh3::system::input_replay::load_error err;
+        replay.reset(new sh3::system::input_replay(argv[2], err));
+        if(err)
+        {
+            std::cerr << "Unable to replay " << argv[2] << ": " << err.message() << std::endl;
+            return 1;
+        }
+    }
+    else if(argc != 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--record FILE | --replay FILE]" << std::endl;
+        return 1;
+    }
 
-    key_bindings bindings;
-    bindings.emplace("W", "Forward");
-    bindings.emplace("A", "Left");
-    bindings.emplace("S", "Back");
-    bindings.emplace("D", "Right");
+    std::unique_ptr<sh3_window> window;
+    if(!replay)
+    {
+        SDL_Init(SDL_INIT_VIDEO);
+        window.reset(new sh3_window{800, 600, "input test"});
+    }
+    sh3::system::input_system input;
 
-    const auto actions = bindings | boost::adaptors::map_values;
-    input.Prepare(begin(actions), end(actions));
+    const std::array<sh3::system::input_system::action_id, 5> actions =
+    {{
+        input.Intern("Forward"),
+        input.Intern("Left"),
+        input.Intern("Back"),
+        input.Intern("Right"),
+        input.Intern("Use"),
+    }};
 
-    while(true)
+    key_bindings bindings;
+    bindings.Bind(std::string("W"), actions[0]);
+    bindings.Bind(std::string("A"), actions[1]);
+    bindings.Bind(std::string("S"), actions[2]);
+    bindings.Bind(std::string("D"), actions[3]);
+    bindings.Bind(std::string("Mouse Button 1"), actions[4]);
+
+    sh3::system::input_sampler sampler;
+    event_source source{&sampler, recorder.get(), replay.get()};
+    while(!replay || !replay->IsFinished())
     {
-        if(!PollEvents(input, bindings))
+        if(!PollEvents(input, bindings, source))
         {
             break;
         }
@@ -91,11 +174,15 @@ int main()
             using state = sh3::system::input_system::state;
             if(input[action].Was(state::PRESSED))
             {
-                std::cout << action << " x " << input[action].Times(state::PRESSED) << ": " << input[action].NormalizedTime(state::PRESSED) << "; ";
+                std::cout << input.GetName(action) << " x " << input[action].Times(state::PRESSED) << ": " << input[action].NormalizedTime(state::PRESSED) << "; ";
             }
         }
         std::cout << std::endl;
-        SDL_Delay(500);
+        if(!replay)
+        {
+            // keep sampling while waiting, so the stamps are accurate to about a millisecond
+            sampler.PumpUntil(sh3::system::perf_clock::now() + std::chrono::milliseconds(500));
+        }
     }
 
     return 0;
@@ -0,0 +1,173 @@
+/** @file
+ *  Test and scaling benchmark of the job system.
+ *
+ *  Checks counters, dependencies, jobs from outside the pool and @ref sh3::system::job_system::ParallelFor,
+ *  then measures how a compute-bound @c ParallelFor scales from one worker up to one per core.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/system/alloc_hooks.hpp"
+#include "SH3/system/jobs.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::system::job_counter;
+    using sh3::system::job_system;
+
+    bool TestCorrectness()
+    {
+        bool ok = true;
+        job_system jobs(4);
+
+        {
+            std::atomic<unsigned> ran{0};
+            job_counter counter;
+            for(int i = 0; i < 1000; ++i)
+            {
+                jobs.Run([&ran]() { ++ran; }, &counter);
+            }
+            jobs.Wait(counter);
+            ok &= Check(ran == 1000, "counter waits for all jobs");
+        }
+
+        {
+            // each stage must see all of the previous one
+            std::atomic<unsigned> first{0}, second{0};
+            std::atomic<bool> ordered{true};
+            job_counter firstDone, secondDone;
+            for(int i = 0; i < 100; ++i)
+            {
+                jobs.Run([&first]() { std::this_thread::yield(); ++first; }, &firstDone);
+            }
+            for(int i = 0; i < 100; ++i)
+            {
+                jobs.Run([&]() { if(first != 100) { ordered = false; } ++second; }, &secondDone, &firstDone);
+            }
+            jobs.Wait(secondDone);
+            ok &= Check(ordered && second == 100, "dependent jobs run after their dependency");
+        }
+
+        {
+            std::atomic<unsigned> ran{0};
+            job_counter counter;
+            std::thread outside([&]() {
+                for(int i = 0; i < 100; ++i)
+                {
+                    jobs.Run([&ran]() { ++ran; }, &counter);
+                }
+            });
+            outside.join();
+            jobs.Wait(counter);
+            ok &= Check(ran == 100, "jobs from outside the pool run");
+        }
+
+        {
+            constexpr std::size_t count = 100003;
+            std::vector<unsigned> hits(count, 0);
+            jobs.ParallelFor(count, [&hits](const std::size_t first, const std::size_t last) {
+                for(std::size_t i = first; i < last; ++i)
+                {
+                    ++hits[i];
+                }
+            });
+            ok &= Check(std::all_of(hits.begin(), hits.end(), [](const unsigned hit) { return hit == 1; }), "ParallelFor covers the range once");
+        }
+
+        if(sh3::system::allocationHooks)
+        {
+            // the workers run most of these, but hand them back to this thread
+            job_counter counter;
+            const auto round = [&jobs, &counter]()
+            {
+                for(int i = 0; i < 256; ++i)
+                {
+                    jobs.Run([]() { std::this_thread::yield(); }, &counter);
+                }
+                jobs.Wait(counter);
+            };
+            round();
+            const std::uint64_t before = sh3::system::GetAllocationCount();
+            for(int i = 0; i < 20; ++i)
+            {
+                round();
+            }
+            ok &= Check(sh3::system::GetAllocationCount() == before, "submitting again reuses the jobs");
+        }
+
+        return ok;
+    }
+
+    /**
+     *  Some arithmetic that the compiler can't skip.
+     */
+    double Work(const std::size_t first, const std::size_t last, std::vector<double> &out)
+    {
+        for(std::size_t i = first; i < last; ++i)
+        {
+            double x = static_cast<double>(i);
+            for(int j = 0; j < 64; ++j)
+            {
+                x = std::sqrt(x + 1.0) * 1.0001;
+            }
+            out[i] = x;
+        }
+        return out[first];
+    }
+
+    void BenchmarkScaling()
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr std::size_t count = 1 << 20;
+        constexpr int repetitions = 5;
+        std::vector<double> out(count);
+
+        const unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+        double single = 0.0;
+        std::printf("%8s %12s %8s %11s\n", "workers", "ms", "speedup", "efficiency");
+        for(unsigned workers = 1; workers <= cores; ++workers)
+        {
+            job_system jobs(workers);
+            auto best = clock::duration::max();
+            for(int i = 0; i < repetitions; ++i)
+            {
+                const auto start = clock::now();
+                jobs.ParallelFor(count, [&out](const std::size_t first, const std::size_t last) { Work(first, last, out); }, 1024);
+                best = std::min(best, clock::now() - start);
+            }
+
+            const double ms = std::chrono::duration<double, std::milli>(best).count();
+            if(workers == 1)
+            {
+                single = ms;
+            }
+            std::printf("%8u %12.2f %7.2fx %10.0f%%\n", workers, ms, single / ms, 100.0 * single / ms / workers);
+        }
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    if(!TestCorrectness())
+    {
+        return static_cast<int>(exit_code::DEATH);
+    }
+
+    BenchmarkScaling();
+
+    return static_cast<int>(exit_code::SUCCESS);
+}
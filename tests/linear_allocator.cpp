@@ -0,0 +1,132 @@
+/** @file
+ *  Test of the @ref sh3::system::linear_allocator.
+ *
+ *  Checks alignment, falling back to the heap when the buffer runs out, rewinding and giving back the latest
+ *  allocation, @ref sh3::system::transient_scope%s and that each thread has an allocator of its own.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/system/linear_allocator.hpp"
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::system::linear_allocator;
+    using sh3::system::transient_scope;
+    using sh3::system::transient_vector;
+
+    constexpr std::size_t capacity = 1024;
+
+    bool IsAligned(const void *memory, const std::size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(memory) % alignment == 0;
+    }
+
+    bool TestAlignment()
+    {
+        linear_allocator allocator(capacity);
+
+        bool aligned = true;
+        for(const std::size_t alignment : {1u, 2u, 8u, 16u, 64u, 256u})
+        {
+            aligned &= IsAligned(allocator.Allocate(3, alignment), alignment);
+        }
+        aligned &= IsAligned(allocator.Allocate(3, capacity * 4), capacity * 4);
+        return Check(aligned, "allocations have the alignment asked for");
+    }
+
+    bool TestOverflow()
+    {
+        bool ok = true;
+        linear_allocator allocator(capacity);
+
+        char *first = static_cast<char*>(allocator.Allocate(capacity / 2, 1));
+        const linear_allocator::marker half = allocator.GetMarker();
+        char *large = static_cast<char*>(allocator.Allocate(capacity, 16));
+        std::memset(large, 0xAB, capacity);
+        ok &= Check(IsAligned(large, 16) && allocator.GetMarker().overflows == 1, "running out falls back to the heap");
+
+        char *after = static_cast<char*>(allocator.Allocate(16, 1));
+        ok &= Check(allocator.GetMarker().overflows == 2 && allocator.GetMarker().offset == half.offset && after != first + capacity / 2, "...and stays there until rewound");
+        ok &= Check(allocator.GetHighWater() == capacity / 2, "heap fallbacks don't count to the high-water");
+
+        allocator.Rewind(half);
+        ok &= Check(allocator.GetMarker().overflows == 0 && allocator.Allocate(16, 1) == first + capacity / 2, "rewinding returns to the buffer");
+
+        allocator.Reset();
+        ok &= Check(allocator.Allocate(16, 1) == first && allocator.GetHighWater() == capacity / 2 + 16, "reset starts over, keeps the high-water");
+
+        return ok;
+    }
+
+    bool TestDeallocate()
+    {
+        bool ok = true;
+        linear_allocator allocator(capacity);
+
+        void *a = allocator.Allocate(64, 1);
+        void *b = allocator.Allocate(64, 1);
+        allocator.Deallocate(a, 64);
+        ok &= Check(allocator.GetMarker().offset == 128, "only the latest allocation is given back");
+        allocator.Deallocate(b, 64);
+        ok &= Check(allocator.GetMarker().offset == 64, "the latest allocation is given back");
+
+        const linear_allocator::marker before = allocator.GetMarker();
+        void *c = allocator.Allocate(32, 1);
+        allocator.Deallocate(c, 32);
+        allocator.Rewind(before);
+        ok &= Check(allocator.GetMarker().offset == 64 && allocator.Allocate(8, 1) == c, "rewinding after giving back is harmless");
+
+        return ok;
+    }
+
+    bool TestScopes()
+    {
+        bool ok = true;
+        linear_allocator &allocator = linear_allocator::ForThread();
+        const linear_allocator::marker start = allocator.GetMarker();
+
+        {
+            transient_scope outer;
+            transient_vector<int> values;
+            for(int i = 0; i < 1000; ++i)
+            {
+                values.push_back(i);
+            }
+            const std::size_t used = allocator.GetMarker().offset;
+            {
+                transient_scope inner;
+                transient_vector<char> scratch(4096, 'x');
+                ok &= Check(scratch.back() == 'x' && allocator.GetMarker().offset > used, "nested scopes allocate on top");
+            }
+            ok &= Check(allocator.GetMarker().offset == used && values[999] == 999, "leaving a scope releases only its memory");
+        }
+        ok &= Check(allocator.GetMarker().offset == start.offset && allocator.GetMarker().overflows == start.overflows, "leaving the outer scope releases all");
+
+        const linear_allocator *other = nullptr;
+        std::thread worker([&other]() { other = &linear_allocator::ForThread(); });
+        worker.join();
+        ok &= Check(other != &allocator, "threads have an allocator of their own");
+
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestAlignment();
+    ok &= TestOverflow();
+    ok &= TestDeallocate();
+    ok &= TestScopes();
+
+    return sh3::test::ExitCode(ok);
+}
@@ -0,0 +1,234 @@
+/** @file
+ *  Test of the visibility through a @ref sh3::scene::portal_graph.
+ *
+ *  Builds a few rooms whose visible sets are known, checks what is seen from them and what their PVS holds, that the
+ *  PVS never hides a cell the traversal would find, and that a densely connected graph is walked in bounded time.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/camera/frustum.hpp"
+#include "SH3/scene/portal.hpp"
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::camera::frustum;
+    using sh3::scene::portal_graph;
+    using cell_index = portal_graph::cell_index;
+
+    constexpr float height = 3.0f;
+
+    /**
+     *  An opening in a wall of constant x, from @p z0 to @p z1.
+     */
+    std::vector<glm::vec3> WallX(const float x, const float z0, const float z1)
+    {
+        return {glm::vec3(x, 0.0f, z0), glm::vec3(x, 0.0f, z1), glm::vec3(x, height, z1), glm::vec3(x, height, z0)};
+    }
+
+    /**
+     *  An opening in a wall of constant z, from @p x0 to @p x1.
+     */
+    std::vector<glm::vec3> WallZ(const float z, const float x0, const float x1)
+    {
+        return {glm::vec3(x0, 0.0f, z), glm::vec3(x1, 0.0f, z), glm::vec3(x1, height, z), glm::vec3(x0, height, z)};
+    }
+
+    aabb Room(const float x0, const float z0, const float x1, const float z1)
+    {
+        return aabb(glm::vec3(x0, 0.0f, z0), glm::vec3(x1, height, z1));
+    }
+
+    /**
+     *  Five rooms seen from above, with narrow doors between them:
+     *
+     *      z=20 +----+----+
+     *           | 4  ' 3  |       4-3 at x=10, z 18..20
+     *      z=10 +----+--' +----+  1-3 at z=10, x 18..20
+     *           | 0  ' 1  ' 2  |  0-1 at x=10, 1-2 at x=20, z 4..6
+     *       z=0 +----+----+----+
+     *          x=0  10   20   30
+     *
+     *  No line from anywhere in room 0 gets into room 4, as it would have to turn back in x, nor into room 2 from room 4,
+     *  as the door from 3 into 1 is too far from the one from 1 into 2.
+     */
+    portal_graph Rooms()
+    {
+        portal_graph graph;
+        graph.AddCell(Room(0.0f, 0.0f, 10.0f, 10.0f));
+        graph.AddCell(Room(10.0f, 0.0f, 20.0f, 10.0f));
+        graph.AddCell(Room(20.0f, 0.0f, 30.0f, 10.0f));
+        graph.AddCell(Room(10.0f, 10.0f, 20.0f, 20.0f));
+        graph.AddCell(Room(0.0f, 10.0f, 10.0f, 20.0f));
+        graph.AddPortal(0, 1, WallX(10.0f, 4.0f, 6.0f));
+        graph.AddPortal(1, 2, WallX(20.0f, 4.0f, 6.0f));
+        graph.AddPortal(1, 3, WallZ(10.0f, 18.0f, 20.0f));
+        graph.AddPortal(3, 4, WallX(10.0f, 18.0f, 20.0f));
+        return graph;
+    }
+
+    /**
+     *  A square of @p size by @p size rooms, each open to all of its neighbours.
+     */
+    portal_graph Grid(const int size)
+    {
+        constexpr float roomSize = 10.0f;
+        portal_graph graph;
+        for(int z = 0; z < size; ++z)
+        {
+            for(int x = 0; x < size; ++x)
+            {
+                graph.AddCell(Room(static_cast<float>(x) * roomSize, static_cast<float>(z) * roomSize, static_cast<float>(x + 1) * roomSize, static_cast<float>(z + 1) * roomSize));
+            }
+        }
+        for(int z = 0; z < size; ++z)
+        {
+            for(int x = 0; x < size; ++x)
+            {
+                const auto cell = static_cast<cell_index>(z * size + x);
+                const float x1 = static_cast<float>(x + 1) * roomSize, z1 = static_cast<float>(z + 1) * roomSize;
+                if(x + 1 < size)
+                {
+                    graph.AddPortal(cell, static_cast<cell_index>(cell + 1), WallX(x1, z1 - roomSize, z1));
+                }
+                if(z + 1 < size)
+                {
+                    graph.AddPortal(cell, static_cast<cell_index>(cell + size), WallZ(z1, x1 - roomSize, x1));
+                }
+            }
+        }
+        return graph;
+    }
+
+    /**
+     *  Check that exactly the listed cells were found.
+     */
+    bool Sees(const portal_graph::visible_set& visible, const std::size_t cellCount, std::initializer_list<cell_index> expected)
+    {
+        std::vector<bool> wanted(cellCount, false);
+        for(const cell_index cell : expected)
+        {
+            wanted[cell] = true;
+        }
+        for(std::size_t cell = 0; cell < cellCount; ++cell)
+        {
+            if(visible.IsVisible(static_cast<cell_index>(cell)) != wanted[cell])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     *  Check that exactly the listed cells are in the PVS of a cell.
+     */
+    bool HasPVS(const portal_graph& graph, const cell_index from, std::initializer_list<cell_index> expected)
+    {
+        portal_graph::visible_set set;
+        set.Clear(graph.GetCellCount());
+        for(std::size_t cell = 0; cell < graph.GetCellCount(); ++cell)
+        {
+            if(graph.IsPotentiallyVisible(from, static_cast<cell_index>(cell)))
+            {
+                set.cells.set(cell);
+            }
+        }
+        return Sees(set, graph.GetCellCount(), expected);
+    }
+
+    bool TestRooms()
+    {
+        bool ok = true;
+        portal_graph graph = Rooms();
+        const std::size_t count = graph.GetCellCount();
+        const frustum unbounded;
+        portal_graph::visible_set visible;
+
+        graph.Traverse(glm::vec3(5.0f, 1.5f, 5.0f), unbounded, visible);
+        ok &= Check(Sees(visible, count, {0, 1, 2}), "doors in line are seen through");
+        graph.Traverse(glm::vec3(1.0f, 1.5f, 1.0f), unbounded, visible);
+        ok &= Check(Sees(visible, count, {0, 1, 3}), "doors at an angle are seen through");
+        graph.Traverse(glm::vec3(25.0f, 1.5f, 5.0f), frustum::FromMatrix(glm::perspective(1.0f, 1.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(25.0f, 1.5f, 5.0f), glm::vec3(30.0f, 1.5f, 5.0f), glm::vec3(0.0f, 1.0f, 0.0f))), visible);
+        ok &= Check(Sees(visible, count, {2}), "doors behind the viewer are not");
+        graph.Traverse(glm::vec3(-5.0f, 1.5f, 5.0f), unbounded, visible);
+        ok &= Check(visible.entries.empty(), "nothing is seen from outside");
+
+        graph.ComputePVS();
+        ok &= Check(HasPVS(graph, 0, {0, 1, 2, 3}), "the PVS does not turn back");
+        ok &= Check(HasPVS(graph, 2, {0, 1, 2, 3}), "...from either side");
+        ok &= Check(HasPVS(graph, 4, {1, 3, 4}), "the PVS does not pass doors too far apart");
+        ok &= Check(HasPVS(graph, 1, {0, 1, 2, 3, 4}), "neighbours and their doors are in the PVS");
+
+        return ok;
+    }
+
+    bool TestConservative()
+    {
+        bool ok = true;
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const glm::vec3 up(0.0f, 1.0f, 0.0f);
+        const glm::mat4 projection = glm::perspective(1.2f, 1.5f, 0.1f, 100.0f);
+
+        for(const portal_graph& graph : {Rooms(), Grid(4)})
+        {
+            portal_graph culled = graph;
+            culled.ComputePVS();
+            portal_graph::visible_set with, without;
+            bool same = true;
+            for(int sample = 0; sample < 500 && same; ++sample)
+            {
+                const portal_graph::cell& cell = graph.GetCell(static_cast<cell_index>(static_cast<std::size_t>(sample) % graph.GetCellCount()));
+                const glm::vec3 size = cell.bounds.max - cell.bounds.min;
+                const glm::vec3 eye = cell.bounds.min + glm::vec3(unit(random), unit(random), unit(random)) * size * 0.999f + size * 0.0005f;
+                const float angle = unit(random) * 6.2831853f;
+                const frustum view = sample % 2 == 0 ? frustum() : frustum::FromMatrix(projection * glm::lookAt(eye, eye + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)), up));
+
+                graph.Traverse(eye, view, without);
+                culled.Traverse(eye, view, with);
+                same = with.cells == without.cells;
+            }
+            ok &= Check(same, "the PVS hides no visible cell");
+        }
+
+        return ok;
+    }
+
+    bool TestDense()
+    {
+        bool ok = true;
+        portal_graph graph = Grid(6);
+        portal_graph::visible_set visible;
+
+        graph.Traverse(glm::vec3(25.0f, 1.5f, 25.0f), frustum(), visible);
+        ok &= Check(visible.cells.count() == graph.GetCellCount(), "all cells of an open grid are seen");
+        ok &= Check(visible.entries.size() <= 3 * graph.GetPortalCount(), "...each through few frustums");
+
+        graph.ComputePVS();
+        ok &= Check(HasPVS(graph, 0, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35}), "...and are in each other's PVS");
+
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestRooms();
+    ok &= TestConservative();
+    ok &= TestDense();
+
+    return sh3::test::ExitCode(ok);
+}
@@ -0,0 +1,91 @@
+/** @file
+ *  Test of the @ref sh3::system::startup_graph.
+ *
+ *  Runs a diamond of steps, one slow branch on the workers and one on the main thread, and checks that each step
+ *  starts after its dependencies, that the main thread steps ran on it while the other branch ran, and which steps
+ *  make up the critical path.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/system/jobs.hpp"
+#include "SH3/system/perf_clock.hpp"
+#include "SH3/system/startup.hpp"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::system::job_system;
+    using sh3::system::perf_clock;
+    using sh3::system::startup_graph;
+    using affinity = startup_graph::affinity;
+    using step_index = startup_graph::step_index;
+
+    /**
+     *  What a step saw when it ran.
+     */
+    struct record final
+    {
+        std::thread::id thread{};
+        perf_clock::time_point start{};
+        perf_clock::time_point end{};
+    };
+
+    /**
+     *  Make a step that records itself.
+     */
+    std::function<void()> Recorded(record &into, const std::chrono::milliseconds duration)
+    {
+        return [&into, duration]()
+        {
+            into.thread = std::this_thread::get_id();
+            into.start = perf_clock::now();
+            std::this_thread::sleep_for(duration);
+            into.end = perf_clock::now();
+        };
+    }
+
+    bool TestDiamond()
+    {
+        bool ok = true;
+        job_system jobs(4);
+        const std::thread::id mainThread = std::this_thread::get_id();
+
+        // files -> decode (slow) -----> upload (main)
+        //       -> window (main) ->
+        enum { FILES, DECODE, WINDOW, UPLOAD, COUNT };
+        std::array<record, COUNT> records;
+        startup_graph graph;
+        const step_index files = graph.Add("files", Recorded(records[FILES], std::chrono::milliseconds(5)));
+        const step_index decode = graph.Add("decode", Recorded(records[DECODE], std::chrono::milliseconds(60)), {files});
+        const step_index window = graph.Add("window", Recorded(records[WINDOW], std::chrono::milliseconds(5)), {files}, affinity::MAIN);
+        const step_index upload = graph.Add("upload", Recorded(records[UPLOAD], std::chrono::milliseconds(5)), {decode, window}, affinity::MAIN);
+        graph.Run(jobs);
+
+        ok &= Check(records[FILES].end <= records[DECODE].start && records[FILES].end <= records[WINDOW].start, "steps start after their dependency");
+        ok &= Check(records[DECODE].end <= records[UPLOAD].start && records[WINDOW].end <= records[UPLOAD].start, "...and after all of them");
+        ok &= Check(records[WINDOW].thread == mainThread && records[UPLOAD].thread == mainThread, "main thread steps run on the main thread");
+        ok &= Check(records[DECODE].thread != mainThread && records[WINDOW].end <= records[DECODE].end, "...while the others run on the workers");
+        ok &= Check(graph.GetCriticalPath() == std::vector<step_index>{files, decode, upload}, "the slow branch is the critical path");
+        ok &= Check(graph.GetDuration() >= std::chrono::milliseconds(70) && graph.GetTimings()[decode].duration >= std::chrono::milliseconds(60), "the durations are measured");
+
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestDiamond();
+
+    return sh3::test::ExitCode(ok);
+}
@@ -0,0 +1,173 @@
+/** @file
+ *  Test of the decisions of the @ref sh3::scene::streaming_manager.
+ *
+ *  Moves a camera along a row of cells and checks which cells a @ref sh3::scene::stream_schedule loads and unloads,
+ *  including around the load and unload radii and when looking ahead, in which order they are loaded, and that an
+ *  @ref sh3::scene::upload_budget stops at its size and deadline.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/scene/stream_schedule.hpp"
+#include <chrono>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::scene::stream_schedule;
+    using sh3::scene::upload_budget;
+    using cell_index = stream_schedule::cell_index;
+    using cell_state = stream_schedule::cell_state;
+    using cell_list = std::vector<cell_index>;
+
+    constexpr int cellCount = 10;
+    constexpr float cellSize = 10.0f;
+
+    /**
+     *  A row of @ref cellCount cubes along x, cell @c i starting at <tt>i * cellSize</tt>.
+     */
+    std::vector<aabb> Row()
+    {
+        std::vector<aabb> row;
+        for(int i = 0; i < cellCount; ++i)
+        {
+            const float start = static_cast<float>(i) * cellSize;
+            row.emplace_back(glm::vec3(start, 0.0f, 0.0f), glm::vec3(start + cellSize, cellSize, cellSize));
+        }
+        return row;
+    }
+
+    /**
+     *  A camera position in the middle of the row.
+     */
+    glm::vec3 At(const float x)
+    {
+        return glm::vec3(x, cellSize * 0.5f, cellSize * 0.5f);
+    }
+
+    bool TestHysteresis()
+    {
+        bool ok = true;
+        const stream_schedule::settings limits{5.0f, 15.0f, 0};
+        stream_schedule schedule;
+        cell_list loaded, unloaded;
+        schedule.SetArea(Row());
+
+        schedule.Update(At(5.0f), limits, loaded, unloaded);
+        ok &= Check(loaded == cell_list{0, 1} && unloaded.empty(), "cells within the load radius are loaded");
+        ok &= Check(schedule.GetState(1) == cell_state::LOADING && schedule.GetState(2) == cell_state::UNLOADED, "cells beyond it are not");
+
+        unsigned loads = 0, unloads = 0;
+        for(int frame = 0; frame < 20; ++frame)
+        {
+            schedule.Update(At(frame % 2 == 0 ? 15.1f : 14.9f), limits, loaded, unloaded);
+            loads += static_cast<unsigned>(loaded.size());
+            unloads += static_cast<unsigned>(unloaded.size());
+        }
+        ok &= Check(loads == 1 && unloads == 0 && schedule.GetState(2) == cell_state::LOADING, "jitter at the load radius loads once");
+
+        schedule.Update(At(5.1f), limits, loaded, unloaded);
+        ok &= Check(loaded.empty() && unloaded.empty(), "cells within the unload radius are kept");
+        schedule.Update(At(4.9f), limits, loaded, unloaded);
+        ok &= Check(loaded.empty() && unloaded == cell_list{2}, "cells beyond the unload radius are unloaded");
+
+        const stream_schedule::settings inverted{5.0f, 1.0f, 0};
+        schedule.SetArea(Row());
+        schedule.Update(At(5.0f), inverted, loaded, unloaded);
+        schedule.Update(At(5.0f), inverted, loaded, unloaded);
+        ok &= Check(unloaded.empty(), "a small unload radius is the load radius");
+        schedule.Update(At(4.5f), inverted, loaded, unloaded);
+        ok &= Check(unloaded == cell_list{1}, "...and still unloads beyond it");
+
+        return ok;
+    }
+
+    bool TestLookahead()
+    {
+        bool ok = true;
+        const stream_schedule::settings limits{5.0f, 15.0f, 10};
+        stream_schedule schedule;
+        cell_list loaded, unloaded;
+        schedule.SetArea(Row());
+
+        schedule.Update(At(5.0f), limits, loaded, unloaded);
+        ok &= Check(loaded == cell_list{0, 1}, "a still camera loads around itself");
+        schedule.Update(At(6.0f), limits, loaded, unloaded);
+        ok &= Check(loaded == cell_list{2}, "a moving camera loads where it is heading");
+        ok &= Check(schedule.GetLoadOrder().size() == 3 && schedule.GetLoadOrder().back() == 2, "cells ahead come after the ones reached");
+
+        schedule.Update(At(3.0f), limits, loaded, unloaded);
+        schedule.SetArea(Row());
+        schedule.Update(At(5.0f), limits, loaded, unloaded);
+        ok &= Check(loaded == cell_list{0, 1}, "a new area starts without movement");
+
+        return ok;
+    }
+
+    bool TestOrder()
+    {
+        bool ok = true;
+        const stream_schedule::settings limits{35.0f, 50.0f, 0};
+        stream_schedule schedule;
+        cell_list loaded, unloaded;
+        schedule.SetArea(Row());
+
+        schedule.Update(At(95.0f), limits, loaded, unloaded);
+        ok &= Check(schedule.GetLoadOrder() == cell_list{9, 8, 7, 6, 5}, "cells are loaded nearest first");
+        ok &= Check(schedule.IsStalled(At(95.0f)), "the camera stalls in a loading cell");
+
+        schedule.SetResident(9);
+        schedule.Update(At(95.0f), limits, loaded, unloaded);
+        ok &= Check(schedule.GetLoadOrder() == cell_list{8, 7, 6, 5} && schedule.GetState(9) == cell_state::RESIDENT, "resident cells are not loaded again");
+        ok &= Check(!schedule.IsStalled(At(95.0f)), "...and don't stall");
+
+        schedule.Update(At(5.0f), limits, loaded, unloaded);
+        schedule.Update(At(95.0f), limits, loaded, unloaded);
+        ok &= Check(schedule.GetState(9) == cell_state::LOADING, "unloaded cells have to load again");
+
+        return ok;
+    }
+
+    bool TestBudget()
+    {
+        bool ok = true;
+        using clock = upload_budget::clock;
+        const clock::time_point start{};
+        const clock::time_point deadline = start + std::chrono::milliseconds(2);
+
+        upload_budget empty(0, deadline);
+        ok &= Check(empty.IsLeft(), "the first upload always fits");
+        empty.Spend(1000, start);
+        ok &= Check(!empty.IsLeft(), "...but only the first");
+
+        upload_budget bytes(100, deadline);
+        bytes.Spend(60, start);
+        ok &= Check(bytes.IsLeft(), "uploads within the size fit");
+        bytes.Spend(60, start);
+        ok &= Check(!bytes.IsLeft() && bytes.GetSpent() == 120, "uploads stop at the size");
+
+        upload_budget time(1 << 20, deadline);
+        time.Spend(10, start + std::chrono::milliseconds(1));
+        ok &= Check(time.IsLeft(), "uploads before the deadline fit");
+        time.Spend(10, deadline);
+        ok &= Check(!time.IsLeft(), "uploads stop at the deadline");
+
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestHysteresis();
+    ok &= TestLookahead();
+    ok &= TestOrder();
+    ok &= TestBudget();
+
+    return sh3::test::ExitCode(ok);
+}
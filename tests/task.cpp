@@ -0,0 +1,154 @@
+/** @file
+ *  Test of @ref sh3::system::task, its @ref sh3::system::promise and @ref sh3::system::WhenAll.
+ *
+ *  Checks that continuations run in order and after the value is set, also when attached to a task that is already
+ *  done, that chains unwrap inner tasks and hop between the job system and the @ref sh3::system::main_thread_queue,
+ *  and that @c WhenAll keeps the order of its tasks, including none at all.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/system/jobs.hpp"
+#include "SH3/system/task.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::system::job_system;
+    using sh3::system::main_thread_queue;
+    using sh3::system::promise;
+    using sh3::system::task;
+    using sh3::system::WhenAll;
+
+    bool TestCompletion()
+    {
+        bool ok = true;
+
+        {
+            promise<int> source;
+            const task<int> value = source.GetTask();
+            std::vector<int> order;
+            bool sawValue = true;
+            for(int i = 0; i < 4; ++i)
+            {
+                value.OnReady([&order, &sawValue, value, i]() { sawValue &= value.IsReady(); order.push_back(i); });
+            }
+            ok &= Check(!value.IsReady() && order.empty(), "continuations wait for the value");
+            source.Set(7);
+            ok &= Check(order == std::vector<int>{0, 1, 2, 3} && sawValue, "continuations run in order, after the value");
+            ok &= Check(value.Get() == 7, "the value is kept");
+        }
+
+        {
+            const task<int> done = task<int>::FromValue(3);
+            bool ran = false;
+            done.OnReady([&ran]() { ran = true; });
+            ok &= Check(ran, "continuations on a done task run right away");
+
+            main_thread_queue queue;
+            const task<int> next = done.Then(queue, [](const int &value) { return value * 2; });
+            ok &= Check(!next.IsReady() && queue.RunAll() == 1 && next.IsReady() && next.Get() == 6, "Then on a done task runs on its executor");
+        }
+
+        return ok;
+    }
+
+    bool TestChains(job_system &jobs)
+    {
+        bool ok = true;
+        main_thread_queue queue;
+        const std::thread::id mainThread = std::this_thread::get_id();
+        std::atomic<bool> onMain{false};
+
+        promise<int> source;
+        const task<std::string> chain = source.GetTask()
+            .Then(jobs, [](const int &value) { return value + 1; })
+            .Then(jobs, [&jobs](const int &value)
+            {
+                return task<int>::FromValue(value).Then(jobs, [](const int &inner) { return inner * 2; });
+            })
+            .Then(queue, [&onMain, mainThread](const int &value)
+            {
+                onMain = std::this_thread::get_id() == mainThread;
+                return std::to_string(value);
+            });
+
+        jobs.Run([source]() mutable { source.Set(20); });
+        while(!chain.IsReady())
+        {
+            queue.RunAll();
+            jobs.RunPending();
+        }
+        ok &= Check(chain.Get() == "42", "chains unwrap inner tasks");
+        ok &= Check(onMain, "the main thread queue runs on this thread");
+
+        // attached after the whole chain is done
+        const task<std::size_t> late = chain.Then(jobs, [](const std::string &value) { return value.size(); });
+        ok &= Check(late.Wait(jobs) == 2, "continuations attached late still run");
+
+        return ok;
+    }
+
+    bool TestWhenAll(job_system &jobs)
+    {
+        bool ok = true;
+
+        const task<std::vector<int>> none = WhenAll(std::vector<task<int>>());
+        ok &= Check(none.IsReady() && none.Get().empty(), "WhenAll over no tasks is ready right away");
+
+        {
+            std::vector<promise<int>> sources(3);
+            std::vector<task<int>> parts;
+            for(const promise<int> &source : sources)
+            {
+                parts.push_back(source.GetTask());
+            }
+            const task<std::vector<int>> all = WhenAll(parts);
+            sources[2].Set(2);
+            sources[0].Set(0);
+            ok &= Check(!all.IsReady(), "WhenAll waits for every task");
+            sources[1].Set(1);
+            ok &= Check(all.IsReady() && all.Get() == std::vector<int>{0, 1, 2}, "WhenAll keeps the order of its tasks");
+        }
+
+        {
+            std::vector<task<int>> parts;
+            for(int i = 0; i < 1000; ++i)
+            {
+                promise<int> source;
+                parts.push_back(source.GetTask());
+                jobs.Run([source, i]() mutable { source.Set(i); });
+            }
+            const task<std::vector<int>> all = WhenAll(parts);
+            const std::vector<int> &values = all.Wait(jobs);
+            bool ordered = values.size() == 1000;
+            for(std::size_t i = 0; ordered && i < values.size(); ++i)
+            {
+                ordered = values[i] == static_cast<int>(i);
+            }
+            ok &= Check(ordered, "WhenAll joins tasks set on workers");
+        }
+
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    job_system jobs(4);
+
+    bool ok = TestCompletion();
+    ok &= TestChains(jobs);
+    ok &= TestWhenAll(jobs);
+
+    return sh3::test::ExitCode(ok);
+}
@@ -5,16 +5,20 @@
  *
  *  @author Jesse Buhagiar
  */
+#include "SH3/arc/async_mft.hpp"
 #include "SH3/arc/mft.hpp"
 #include "SH3/system/config.hpp"
 #include "SH3/system/exit_code.hpp"
 #include "SH3/system/log.hpp"
 #include "SH3/system/window.hpp"
 #include "SH3/system/glprogram.hpp"
+#include "SH3/graphics/async_texture.hpp"
 #include "SH3/graphics/msbmp.hpp"
 #include "SH3/graphics/texture.hpp"
 #include "SH3/system/glbuffer.hpp"
 #include "SH3/system/glvertarray.hpp"
+#include "SH3/system/jobs.hpp"
+#include "SH3/system/task.hpp"
 #include "SH3/types/vertex.hpp"
 #include <SDL.h>
 #include <cstdio>
@@ -92,7 +96,11 @@ int main(int argc, char** argv)
 
     quadVao.Unbind();
 
-    sh3_graphics::sh3_texture tex(mft, "data/pic/sy/sys_warning.tex");
+    // load in the background; the upload happens in the loop below
+    sh3::system::job_system jobs;
+    sh3::system::main_thread_queue mainQueue;
+    sh3::arc::async_mft files(mft, jobs);
+    sh3_graphics::texture_task tex = sh3_graphics::LoadTextureAsync(files, mainQueue, "data/pic/sy/sys_warning.tex");
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_WARNING, "info", "You should now see a texture drawn on the screen.", nullptr);
@@ -108,10 +116,15 @@ int main(int argc, char** argv)
                 quit = true;
         }
 
+        mainQueue.RunAll();
+
         glClear(GL_COLOR_BUFFER_BIT);
-        prog.Bind();
-        tex.Bind(GL_TEXTURE1);
-        quadVao.Draw();
+        if(tex.IsReady())
+        {
+            prog.Bind();
+            tex.Get()->Bind(GL_TEXTURE1);
+            quadVao.Draw();
+        }
         SDL_GL_SwapWindow(window.hwnd.get());
     }
 
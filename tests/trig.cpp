@@ -0,0 +1,219 @@
+/** @file
+ *  Accuracy test and microbenchmark of the fast trigonometric functions.
+ *
+ *  Compares @ref sh3::math against @c libm over the documented domain and fails if an error bound
+ *  from trig.hpp is exceeded. The batch versions are checked with the kernels of every SIMD level the CPU
+ *  supports. Afterwards the throughput of both is measured.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "SH3/math/trig.hpp"
+#include "SH3/system/cpu_features.hpp"
+#include "SH3/system/exit_code.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr std::size_t sampleCount = 1 << 20;
+    constexpr float maxArgument = 1e4f;
+    constexpr double sinCosBound = 4e-7;
+    constexpr double atan2Bound = 4e-7;
+
+    /**
+     *  Track the largest error of a function.
+     */
+    struct error_tracker final
+    {
+        const char* name;
+        double bound;
+        double worst = 0.0;
+        double worstInput = 0.0;
+
+        void Add(double value, double reference, double input)
+        {
+            const double err = std::fabs(value - reference);
+            if(!(err <= worst)) // catches NaN as well
+            {
+                worst = err;
+                worstInput = input;
+            }
+        }
+
+        bool Report() const
+        {
+            const bool ok = worst <= bound;
+            std::printf("%-14s max error %.3g (at %.9g), bound %.3g %s\n", name, worst, worstInput, bound, ok ? "ok" : "EXCEEDED");
+            return ok;
+        }
+    };
+
+    /**
+     *  Run a function over all samples a few times and report the time per call.
+     */
+    template<typename function>
+    void Measure(const char* name, function&& run)
+    {
+        constexpr int repetitions = 10;
+        using clock = std::chrono::steady_clock;
+
+        run(); // warm up
+        auto best = clock::duration::max();
+        for(int i = 0; i < repetitions; ++i)
+        {
+            const auto start = clock::now();
+            run();
+            best = std::min(best, clock::now() - start);
+        }
+        const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(best).count());
+        std::printf("%-20s %6.2f ns/value\n", name, ns / static_cast<double>(sampleCount));
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all error bounds hold, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> angles(-maxArgument, maxArgument);
+    std::uniform_real_distribution<float> coordinates(-100.0f, 100.0f);
+
+    std::vector<float> x(sampleCount), y(sampleCount);
+    for(std::size_t i = 0; i < sampleCount; ++i)
+    {
+        // mix in small values to cover the region around 0 and edge cases along the axes
+        x[i] = i % 4 == 0 ? angles(rng) * 1e-3f : angles(rng);
+        y[i] = i % 8 == 0 ? 0.0f : coordinates(rng);
+    }
+    x[0] = 0.0f;
+    x[1] = -0.0f;
+
+    std::vector<float> sines(sampleCount), cosines(sampleCount), atans(sampleCount);
+
+    error_tracker sinError{"Sin", sinCosBound}, cosError{"Cos", sinCosBound}, sinCosError{"SinCos", sinCosBound};
+    error_tracker atan2Error{"Atan2", atan2Bound};
+
+    for(std::size_t i = 0; i < sampleCount; ++i)
+    {
+        const double value = x[i];
+        const double sine = std::sin(value), cosine = std::cos(value);
+        float s, c;
+        sh3::math::SinCos(x[i], s, c);
+
+        sinError.Add(sh3::math::Sin(x[i]), sine, value);
+        cosError.Add(sh3::math::Cos(x[i]), cosine, value);
+        sinCosError.Add(s, sine, value);
+        sinCosError.Add(c, cosine, value);
+    }
+
+    // use x as the y coordinate too, so that the full range of angles is covered
+    std::vector<float> xs(sampleCount);
+    for(std::size_t i = 0; i < sampleCount; ++i)
+    {
+        xs[i] = coordinates(rng);
+    }
+    xs[2] = 0.0f;
+    xs[3] = -0.0f;
+    // atan2(+-0, negative) is +-pi, which differ by 2 pi; compare the direction instead
+    const auto distance = [](double angle, double reference) { return std::fabs(reference) > 3.14159 && std::fabs(angle) > 3.14159 ? std::fabs(angle) : angle; };
+    for(std::size_t i = 0; i < sampleCount; ++i)
+    {
+        const double reference = std::atan2(static_cast<double>(y[i]), static_cast<double>(xs[i]));
+        atan2Error.Add(distance(sh3::math::Atan2(y[i], xs[i]), reference), distance(reference, reference), static_cast<double>(y[i]));
+    }
+
+    bool ok = true;
+    for(const error_tracker* tracker : {&sinError, &cosError, &sinCosError, &atan2Error})
+    {
+        ok &= tracker->Report();
+    }
+
+    using sh3::system::simd_level;
+    const simd_level detected = sh3::system::DetectSimdLevel();
+    for(simd_level level : {simd_level::SCALAR, simd_level::SSE2, simd_level::SSE41, simd_level::AVX2, simd_level::AVX512})
+    {
+        if(level > detected)
+        {
+            break;
+        }
+        sh3::system::SetSimdLevel(level);
+        const std::string suffix = std::string(" (") + sh3::system::GetSimdLevelName(level) + ")";
+        const std::string sinCosName = "SinCos batch" + suffix, atan2Name = "Atan2 batch" + suffix;
+        error_tracker batchError{sinCosName.c_str(), sinCosBound}, atan2BatchError{atan2Name.c_str(), atan2Bound};
+
+        sh3::math::SinCos(x.data(), sines.data(), cosines.data(), sampleCount);
+        for(std::size_t i = 0; i < sampleCount; ++i)
+        {
+            const double value = x[i];
+            batchError.Add(sines[i], std::sin(value), value);
+            batchError.Add(cosines[i], std::cos(value), value);
+        }
+
+        sh3::math::Atan2(y.data(), xs.data(), atans.data(), sampleCount);
+        for(std::size_t i = 0; i < sampleCount; ++i)
+        {
+            const double reference = std::atan2(static_cast<double>(y[i]), static_cast<double>(xs[i]));
+            atan2BatchError.Add(distance(atans[i], reference), distance(reference, reference), static_cast<double>(y[i]));
+        }
+
+        ok &= batchError.Report();
+        ok &= atan2BatchError.Report();
+    }
+    sh3::system::SetSimdLevel(detected);
+
+    float sink = 0.0f;
+    Measure("std::sin + std::cos", [&]
+    {
+        for(std::size_t i = 0; i < sampleCount; ++i)
+        {
+            sines[i] = std::sin(x[i]);
+            cosines[i] = std::cos(x[i]);
+        }
+        sink += sines[sampleCount / 2];
+    });
+    Measure("SinCos", [&]
+    {
+        for(std::size_t i = 0; i < sampleCount; ++i)
+        {
+            sh3::math::SinCos(x[i], sines[i], cosines[i]);
+        }
+        sink += sines[sampleCount / 2];
+    });
+    Measure("SinCos batch", [&]
+    {
+        sh3::math::SinCos(x.data(), sines.data(), cosines.data(), sampleCount);
+        sink += sines[sampleCount / 2];
+    });
+    Measure("std::atan2", [&]
+    {
+        for(std::size_t i = 0; i < sampleCount; ++i)
+        {
+            atans[i] = std::atan2(y[i], xs[i]);
+        }
+        sink += atans[sampleCount / 2];
+    });
+    Measure("Atan2", [&]
+    {
+        for(std::size_t i = 0; i < sampleCount; ++i)
+        {
+            atans[i] = sh3::math::Atan2(y[i], xs[i]);
+        }
+        sink += atans[sampleCount / 2];
+    });
+    Measure("Atan2 batch", [&]
+    {
+        sh3::math::Atan2(y.data(), xs.data(), atans.data(), sampleCount);
+        sink += atans[sampleCount / 2];
+    });
+    std::printf("(checksum %g)\n", static_cast<double>(sink));
+
+    return static_cast<int>(ok ? exit_code::SUCCESS : exit_code::DEATH);
+}
@@ -0,0 +1,169 @@
+/** @file
+ *  Test of the spatial hash of a @ref sh3::camera::trigger_map.
+ *
+ *  Scatters triggers of all sizes (within one grid cell, spanning several and too large for the grid) around the
+ *  origin and checks that point and box queries find exactly what testing every trigger finds, also on the borders
+ *  of the grid cells, and that @ref sh3::camera::trigger_map::Update reports what was entered and left.
+ *
+ *  @copyright 2017  Palm Studios
+ */
+
+#include "check.hpp"
+#include "SH3/camera/trigger.hpp"
+#include "SH3/system/arena.hpp"
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+    using sh3::test::Check;
+    using sh3::camera::trigger;
+    using sh3::camera::trigger_map;
+    using sh3::system::arena;
+    using index_list = std::vector<trigger_map::trigger_index>;
+
+    constexpr float cellSize = 8.0f;
+
+    /**
+     *  Random coordinates on a grid of quarter cells, so that many lie exactly on the borders of the grid cells.
+     */
+    class sampler final
+    {
+    public:
+        float Coordinate() { return static_cast<float>(steps(random)) * cellSize * 0.25f; }
+        glm::vec3 Point() { return glm::vec3(Coordinate(), Coordinate(), Coordinate()); }
+
+        /**
+         *  A box with each edge up to @p cells grid cells long.
+         */
+        aabb Box(const int cells)
+        {
+            std::uniform_int_distribution<int> length(0, cells * 4);
+            const glm::vec3 lo = Point();
+            const glm::vec3 size(static_cast<float>(length(random)), static_cast<float>(length(random)), static_cast<float>(length(random)));
+            return aabb(lo, lo + size * cellSize * 0.25f);
+        }
+
+    private:
+        std::mt19937 random{11};
+        std::uniform_int_distribution<int> steps{-40, 40};
+    };
+
+    index_list BruteForce(const std::vector<trigger>& triggers, const glm::vec3& point)
+    {
+        index_list found;
+        for(std::size_t i = 0; i < triggers.size(); ++i)
+        {
+            if(triggers[i].bounds.Contains(point))
+            {
+                found.push_back(static_cast<trigger_map::trigger_index>(i));
+            }
+        }
+        return found;
+    }
+
+    index_list BruteForce(const std::vector<trigger>& triggers, const aabb& box)
+    {
+        index_list found;
+        for(std::size_t i = 0; i < triggers.size(); ++i)
+        {
+            if(triggers[i].bounds.Intersects(box))
+            {
+                found.push_back(static_cast<trigger_map::trigger_index>(i));
+            }
+        }
+        return found;
+    }
+
+    /**
+     *  Get the number of grid cells a box overlaps.
+     */
+    int CellSpan(const aabb& box)
+    {
+        const glm::vec3 lo = box.min / cellSize, hi = box.max / cellSize;
+        int span = 1;
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            span *= static_cast<int>(std::floor(hi[axis])) - static_cast<int>(std::floor(lo[axis])) + 1;
+        }
+        return span;
+    }
+
+    bool TestQueries()
+    {
+        bool ok = true;
+        sampler sample;
+
+        std::vector<trigger> triggers;
+        int spanning = 0, oversized = 0;
+        for(int i = 0; i < 300; ++i)
+        {
+            // mostly small volumes, some spanning a few cells and a few too large for the grid
+            const int cells = i % 10 == 0 ? 12 : (i % 3 == 0 ? 3 : 1);
+            triggers.push_back(trigger{sample.Box(cells), glm::vec3(0.0f), glm::vec3(0.0f), 0});
+            const int span = CellSpan(triggers.back().bounds);
+            spanning += span > 1 && span <= static_cast<int>(trigger_map::maxCellsPerTrigger);
+            oversized += span > static_cast<int>(trigger_map::maxCellsPerTrigger);
+        }
+        ok &= Check(spanning > 50 && oversized > 5, "volumes span one, several and too many cells");
+
+        arena memory("triggers");
+        const trigger_map map(triggers, memory, cellSize);
+        index_list found;
+
+        bool points = true;
+        for(int i = 0; i < 5000 && points; ++i)
+        {
+            const glm::vec3 point = sample.Point();
+            map.Query(point, found);
+            points = found == BruteForce(triggers, point);
+        }
+        ok &= Check(points, "point queries find what a scan finds");
+
+        bool boxes = true;
+        for(int i = 0; i < 2000 && boxes; ++i)
+        {
+            const aabb box = sample.Box(i % 50 == 0 ? 20 : 2);
+            map.Query(box, found);
+            boxes = found == BruteForce(triggers, box);
+        }
+        ok &= Check(boxes, "box queries find what a scan finds");
+
+        map.Query(aabb(), found);
+        ok &= Check(found.empty(), "an empty box finds nothing");
+
+        return ok;
+    }
+
+    bool TestUpdate()
+    {
+        bool ok = true;
+        arena memory("triggers");
+        trigger_map map({trigger{aabb(glm::vec3(0.0f), glm::vec3(20.0f)), glm::vec3(0.0f), glm::vec3(0.0f), 0},
+                         trigger{aabb(glm::vec3(10.0f), glm::vec3(30.0f)), glm::vec3(0.0f), glm::vec3(0.0f), 0}}, memory, cellSize);
+        index_list entered, exited;
+
+        ok &= Check(map.Update(glm::vec3(5.0f), entered, exited) && entered == index_list{0} && exited.empty(), "walking into a trigger enters it");
+        ok &= Check(map.Update(glm::vec3(15.0f), entered, exited) && entered == index_list{1} && exited.empty(), "...and into an overlapping one");
+        ok &= Check(!map.Update(glm::vec3(16.0f), entered, exited), "moving within both changes nothing");
+        ok &= Check(map.Update(glm::vec3(25.0f), entered, exited) && entered.empty() && exited == index_list{0}, "walking out leaves it");
+        map.Reset();
+        ok &= Check(map.Update(glm::vec3(25.0f), entered, exited) && entered == index_list{1}, "after a reset triggers are entered again");
+
+        return ok;
+    }
+}
+
+/**
+ *  Entry point to the program.
+ *
+ *  @returns @ref exit_code::SUCCESS if all checks pass, @ref exit_code::DEATH otherwise.
+ */
+int main()
+{
+    bool ok = TestQueries();
+    ok &= TestUpdate();
+
+    return sh3::test::ExitCode(ok);
+}